@@ -0,0 +1,138 @@
+/*=============================================================================*/
+// ECSRGraph.h: Frozen (baked) compressed sparse row snapshot of an IGraph.
+// Nodes are stored by value and all connections of all nodes live in three contiguous
+// arrays (offsets, targets and costs), so iterating neighbors doesn't chase pointers.
+// The mutable IGraph stays the one to edit, bake it again after modifying it.
+/*=============================================================================*/
+#pragma once
+
+#include "EIGraph.h"
+#include "EGraphConnectionTypes.h"
+#include "EGraphNodeTypes.h"
+
+namespace Elite
+{
+	template<class T_NodeType>
+	class CSRGraph final
+	{
+	public:
+		// Iterates the outgoing connections of one node as GraphEdge values
+		class NeighborRange final
+		{
+		public:
+			class Iterator final
+			{
+			public:
+				Iterator(int from, const int* pTarget, const float* pCost) : m_From(from), m_pTarget(pTarget), m_pCost(pCost) {}
+
+				GraphEdge operator*() const { return GraphEdge{ m_From, *m_pTarget, *m_pCost }; }
+				Iterator& operator++() { ++m_pTarget; ++m_pCost; return *this; }
+				bool operator!=(const Iterator& other) const { return m_pTarget != other.m_pTarget; }
+
+			private:
+				int m_From;
+				const int* m_pTarget;
+				const float* m_pCost;
+			};
+
+			NeighborRange(int from, const int* pTargets, const float* pCosts, int count)
+				: m_From(from), m_pTargets(pTargets), m_pCosts(pCosts), m_Count(count) {}
+
+			Iterator begin() const { return Iterator(m_From, m_pTargets, m_pCosts); }
+			Iterator end() const { return Iterator(m_From, m_pTargets + m_Count, m_pCosts + m_Count); }
+			int size() const { return m_Count; }
+
+		private:
+			int m_From;
+			const int* m_pTargets;
+			const float* m_pCosts;
+			int m_Count;
+		};
+
+		CSRGraph() = default;
+		template<class T_ConnectionType>
+		explicit CSRGraph(const IGraph<T_NodeType, T_ConnectionType>& graph) { Bake(graph); }
+
+		// (Re)builds the snapshot, the arrays keep their capacity so rebaking a graph of the same size doesn't allocate
+		template<class T_ConnectionType>
+		void Bake(const IGraph<T_NodeType, T_ConnectionType>& graph);
+
+		int GetNrOfNodes() const { return (int)m_Nodes.size(); }
+		int GetNrOfConnections() const { return (int)m_Targets.size(); }
+		bool IsDirectionalGraph() const { return m_IsDirectionalGraph; }
+		bool IsNodeValid(int idx) const { return idx >= 0 && idx < (int)m_Nodes.size() && m_Nodes[idx].GetIndex() != invalid_node_index; }
+
+		// Returned nodes are copies owned by the snapshot, their index matches the node in the source graph
+		T_NodeType* GetNode(int idx) { return &m_Nodes[idx]; }
+		const T_NodeType* GetNode(int idx) const { return &m_Nodes[idx]; }
+
+		NeighborRange GetNeighbors(int idx) const;
+
+		// Same meaning as in the source graph (e.g. column/row for grids) at the time of baking
+		Vector2 GetNodePos(int idx) const { return m_NodePositions[idx]; }
+		Vector2 GetNodeWorldPos(int idx) const { return m_NodeWorldPositions[idx]; }
+
+	private:
+		std::vector<T_NodeType> m_Nodes;
+		std::vector<Vector2> m_NodePositions;
+		std::vector<Vector2> m_NodeWorldPositions;
+
+		// connections of node i are [m_Offsets[i], m_Offsets[i + 1]) in m_Targets and m_Costs
+		std::vector<int> m_Offsets;
+		std::vector<int> m_Targets;
+		std::vector<float> m_Costs;
+
+		bool m_IsDirectionalGraph = false;
+	};
+
+	template<class T_NodeType>
+	template<class T_ConnectionType>
+	inline void CSRGraph<T_NodeType>::Bake(const IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		const int nrOfNodes = graph.GetNrOfNodes();
+
+		m_Nodes.clear();
+		m_NodePositions.clear();
+		m_NodeWorldPositions.clear();
+		m_Offsets.clear();
+		m_Targets.clear();
+		m_Costs.clear();
+
+		m_Nodes.reserve(nrOfNodes);
+		m_NodePositions.reserve(nrOfNodes);
+		m_NodeWorldPositions.reserve(nrOfNodes);
+		m_Offsets.reserve(nrOfNodes + 1);
+		m_Targets.reserve(graph.GetNrOfConnections());
+		m_Costs.reserve(graph.GetNrOfConnections());
+
+		m_IsDirectionalGraph = graph.IsDirectionalGraph();
+
+		for (int idx = 0; idx < nrOfNodes; ++idx)
+		{
+			const T_NodeType* pNode = graph.GetNode(idx);
+			m_Nodes.push_back(*pNode);
+
+			// Removed nodes keep their slot so indices stay the same, but have no position or connections
+			const bool isActive = pNode->GetIndex() != invalid_node_index;
+			m_NodePositions.push_back(isActive ? graph.GetNodePos(idx) : ZeroVector2);
+			m_NodeWorldPositions.push_back(isActive ? graph.GetNodeWorldPos(idx) : ZeroVector2);
+
+			m_Offsets.push_back((int)m_Targets.size());
+			for (auto pConnection : graph.GetNodeConnections(idx))
+			{
+				m_Targets.push_back(pConnection->GetTo());
+				m_Costs.push_back(pConnection->GetCost());
+			}
+		}
+		m_Offsets.push_back((int)m_Targets.size());
+	}
+
+	template<class T_NodeType>
+	inline typename CSRGraph<T_NodeType>::NeighborRange CSRGraph<T_NodeType>::GetNeighbors(int idx) const
+	{
+		assert((idx < (int)m_Nodes.size()) && (idx >= 0) && "<CSRGraph::GetNeighbors>: invalid index");
+
+		const int first = m_Offsets[idx];
+		return NeighborRange(idx, m_Targets.data() + first, m_Costs.data() + first, m_Offsets[idx + 1] - first);
+	}
+}
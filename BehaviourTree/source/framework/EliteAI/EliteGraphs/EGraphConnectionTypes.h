@@ -51,4 +51,13 @@ namespace Elite
 	protected:
 		Color m_Color;
 	};
+
+	// By value view of a connection, this is what the search algorithms iterate over
+	// regardless of how the graph stores its connections (see IGraph/CSRGraph::GetNeighbors)
+	struct GraphEdge final
+	{
+		int from = invalid_node_index;
+		int to = invalid_node_index;
+		float cost = 0.f;
+	};
 }
\ No newline at end of file
@@ -32,7 +32,7 @@ namespace Elite
 	class GraphNode2D : public GraphNode
 	{
 	public:
-		GraphNode2D(int index, const Elite::Vector2& pos = Elite::ZeroVector2)
+		GraphNode2D(int index = invalid_node_index, const Elite::Vector2& pos = Elite::ZeroVector2)
 			: GraphNode(index), m_Position(pos), m_Color(DEFAULT_NODE_COLOR)
 		{
 		}
@@ -53,7 +53,7 @@ namespace Elite
 	class GridTerrainNode : public GraphNode
 	{
 	public:
-		GridTerrainNode(int index)
+		GridTerrainNode(int index = invalid_node_index)
 			: GraphNode(index), m_Terrain(TerrainType::Ground)
 		{
 		}
@@ -87,7 +87,7 @@ namespace Elite
 	class NavGraphNode : public GraphNode2D
 	{
 	public:
-		NavGraphNode(int index, const Vector2& pos = ZeroVector2)
+		NavGraphNode(int index = invalid_node_index, const Vector2& pos = ZeroVector2)
 			: GraphNode2D(index, pos), m_LineIdx(0)	{}
 		NavGraphNode(int index, int lineIdx, const Vector2& pos = ZeroVector2)
 			: GraphNode2D(index, pos), m_LineIdx(lineIdx){}
@@ -100,7 +100,7 @@ namespace Elite
 	class InfluenceNode final : public Elite::GraphNode2D
 	{
 	public:
-		InfluenceNode(int index, Elite::Vector2 pos = { 0,0 }, float influence = 0.f)
+		InfluenceNode(int index = invalid_node_index, Elite::Vector2 pos = { 0,0 }, float influence = 0.f)
 			: GraphNode2D(index, pos), m_Influence(influence) {}
 
 		float GetInfluence() const { return m_Influence; }
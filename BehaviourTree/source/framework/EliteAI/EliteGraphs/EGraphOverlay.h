@@ -0,0 +1,244 @@
+/*=============================================================================*/
+// EGraphOverlay.h: Read-only view of an IGraph with a few extra (virtual) nodes and connections on top.
+// Searches see the base graph plus the virtual nodes, which get the indices after the last base node,
+// without the base graph being copied or changed. Storage is fixed size, so setting up an overlay for a
+// query (e.g. the start and end of a navmesh path) doesn't allocate and queries can run on several threads.
+/*=============================================================================*/
+#pragma once
+
+#include <array>
+
+#include "EIGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ELandmarks.h"
+
+namespace Elite
+{
+	template <class T_NodeType, class T_ConnectionType>
+	class GraphOverlay final
+	{
+	public:
+		static const int MaxNrOfVirtualNodes = 4;
+		static const int MaxNrOfVirtualConnections = 32;
+		static const int MaxNrOfLandmarks = 16; // landmarks after these aren't used for the virtual nodes
+
+		// Iterates the connections of the base graph first and then the virtual connections of the node
+		class NeighborRange final
+		{
+		public:
+			using BaseIterator = typename IGraph<T_NodeType, T_ConnectionType>::NeighborRange::Iterator;
+
+			class Iterator final
+			{
+			public:
+				Iterator(BaseIterator baseIt, BaseIterator baseEnd, const GraphOverlay* pOverlay, int from, int virtualIdx)
+					: m_BaseIt(baseIt), m_BaseEnd(baseEnd), m_pOverlay(pOverlay), m_From(from), m_VirtualIdx(virtualIdx)
+				{
+					SkipVirtualConnections();
+				}
+
+				GraphEdge operator*() const { return m_BaseIt != m_BaseEnd ? *m_BaseIt : m_pOverlay->m_VirtualConnections[m_VirtualIdx]; }
+				Iterator& operator++()
+				{
+					if (m_BaseIt != m_BaseEnd)
+					{
+						++m_BaseIt;
+					}
+					else
+					{
+						++m_VirtualIdx;
+						SkipVirtualConnections();
+					}
+					return *this;
+				}
+				bool operator!=(const Iterator& other) const { return m_BaseIt != other.m_BaseIt || m_VirtualIdx != other.m_VirtualIdx; }
+
+			private:
+				// Moves to the next virtual connection that starts at the node
+				void SkipVirtualConnections()
+				{
+					while (m_VirtualIdx < m_pOverlay->m_NrOfVirtualConnections && m_pOverlay->m_VirtualConnections[m_VirtualIdx].from != m_From)
+						++m_VirtualIdx;
+				}
+
+				BaseIterator m_BaseIt;
+				BaseIterator m_BaseEnd;
+				const GraphOverlay* m_pOverlay;
+				int m_From;
+				int m_VirtualIdx;
+			};
+
+			NeighborRange(BaseIterator baseBegin, BaseIterator baseEnd, const GraphOverlay* pOverlay, int from)
+				: m_BaseBegin(baseBegin), m_BaseEnd(baseEnd), m_pOverlay(pOverlay), m_From(from) {}
+
+			Iterator begin() const { return Iterator(m_BaseBegin, m_BaseEnd, m_pOverlay, m_From, 0); }
+			Iterator end() const { return Iterator(m_BaseEnd, m_BaseEnd, m_pOverlay, m_From, m_pOverlay->m_NrOfVirtualConnections); }
+
+		private:
+			BaseIterator m_BaseBegin;
+			BaseIterator m_BaseEnd;
+			const GraphOverlay* m_pOverlay;
+			int m_From;
+		};
+
+		// The landmarks (optional) have to be built for the base graph, the virtual nodes get their distances through their connections
+		explicit GraphOverlay(const IGraph<T_NodeType, T_ConnectionType>& graph, const Landmarks* pLandmarks = nullptr);
+
+		// Copies the node and gives it the next virtual index, which is returned.
+		// Its position comes from the base graph's GetNodePos(node), which mustn't depend on the node index
+		int AddVirtualNode(const T_NodeType& node);
+		// At least one side has to be a virtual node, on undirected base graphs the connection back is added as well.
+		// Virtual connections mustn't give base nodes a shorter path between each other, the landmark distances rely on that
+		void AddVirtualConnection(int from, int to, float cost);
+		void Clear();
+
+		const IGraph<T_NodeType, T_ConnectionType>& GetBaseGraph() const { return m_Graph; }
+		const Landmarks* GetLandmarks() const { return m_pLandmarks; }
+		bool IsVirtualNode(int idx) const { return idx >= m_Graph.GetNrOfNodes(); }
+
+		// Same interface as the graphs the algorithms search
+		int GetNrOfNodes() const { return m_Graph.GetNrOfNodes() + m_NrOfVirtualNodes; }
+		bool IsDirectionalGraph() const { return m_Graph.IsDirectionalGraph(); }
+		bool IsNodeValid(int idx) const { return IsVirtualNode(idx) ? idx < GetNrOfNodes() : m_Graph.IsNodeValid(idx); }
+		// Like IGraph the nodes are handed out as non-const, virtual nodes live in the overlay
+		T_NodeType* GetNode(int idx) const { return IsVirtualNode(idx) ? &m_VirtualNodes[GetVirtualIdx(idx)] : m_Graph.GetNode(idx); }
+		NeighborRange GetNeighbors(int idx) const;
+		Vector2 GetNodePos(int idx) const { return IsVirtualNode(idx) ? m_VirtualNodePositions[GetVirtualIdx(idx)] : m_Graph.GetNodePos(idx); }
+
+		// Landmark lower bound of the cost from -> to, 0 without landmarks
+		float GetLandmarkLowerBound(int fromIdx, int toIdx) const;
+
+	private:
+		int GetVirtualIdx(int idx) const { return idx - m_Graph.GetNrOfNodes(); }
+		const float* GetLandmarkDistances(int idx) const;
+		void UpdateLandmarkDistances();
+
+		const IGraph<T_NodeType, T_ConnectionType>& m_Graph;
+		const Landmarks* m_pLandmarks;
+		int m_NrOfLandmarks = 0;
+
+		mutable std::array<T_NodeType, MaxNrOfVirtualNodes> m_VirtualNodes;
+		std::array<Vector2, MaxNrOfVirtualNodes> m_VirtualNodePositions;
+		std::array<std::array<float, MaxNrOfLandmarks>, MaxNrOfVirtualNodes> m_VirtualLandmarkDistances;
+		int m_NrOfVirtualNodes = 0;
+
+		std::array<GraphEdge, MaxNrOfVirtualConnections> m_VirtualConnections;
+		int m_NrOfVirtualConnections = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	const int GraphOverlay<T_NodeType, T_ConnectionType>::MaxNrOfVirtualNodes;
+	template <class T_NodeType, class T_ConnectionType>
+	const int GraphOverlay<T_NodeType, T_ConnectionType>::MaxNrOfVirtualConnections;
+	template <class T_NodeType, class T_ConnectionType>
+	const int GraphOverlay<T_NodeType, T_ConnectionType>::MaxNrOfLandmarks;
+
+	template <class T_NodeType, class T_ConnectionType>
+	GraphOverlay<T_NodeType, T_ConnectionType>::GraphOverlay(const IGraph<T_NodeType, T_ConnectionType>& graph, const Landmarks* pLandmarks)
+		: m_Graph(graph)
+		, m_pLandmarks(pLandmarks)
+		, m_VirtualNodes{}
+	{
+		if (m_pLandmarks)
+		{
+			assert(m_pLandmarks->IsBuiltFor(m_Graph) && "<GraphOverlay>: the landmarks are built for another graph");
+			m_NrOfLandmarks = std::min(m_pLandmarks->GetNrOfLandmarks(), MaxNrOfLandmarks);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int GraphOverlay<T_NodeType, T_ConnectionType>::AddVirtualNode(const T_NodeType& node)
+	{
+		assert(m_NrOfVirtualNodes < MaxNrOfVirtualNodes && "<GraphOverlay::AddVirtualNode>: no room for another virtual node");
+
+		const int idx = GetNrOfNodes();
+		T_NodeType& virtualNode = m_VirtualNodes[m_NrOfVirtualNodes];
+		virtualNode = node;
+		virtualNode.SetIndex(idx);
+
+		m_VirtualNodePositions[m_NrOfVirtualNodes] = m_Graph.GetNodePos(&virtualNode);
+		m_VirtualLandmarkDistances[m_NrOfVirtualNodes].fill(FLT_MAX);
+		++m_NrOfVirtualNodes;
+
+		return idx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GraphOverlay<T_NodeType, T_ConnectionType>::AddVirtualConnection(int from, int to, float cost)
+	{
+		assert(IsNodeValid(from) && IsNodeValid(to) && (IsVirtualNode(from) || IsVirtualNode(to)) && "<GraphOverlay::AddVirtualConnection>: invalid connection");
+
+		const int nrOfConnections = IsDirectionalGraph() ? 1 : 2;
+		assert(m_NrOfVirtualConnections + nrOfConnections <= MaxNrOfVirtualConnections && "<GraphOverlay::AddVirtualConnection>: no room for another virtual connection");
+
+		m_VirtualConnections[m_NrOfVirtualConnections++] = GraphEdge{ from, to, cost };
+		if (!IsDirectionalGraph())
+			m_VirtualConnections[m_NrOfVirtualConnections++] = GraphEdge{ to, from, cost };
+
+		if (m_NrOfLandmarks > 0)
+			UpdateLandmarkDistances();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GraphOverlay<T_NodeType, T_ConnectionType>::Clear()
+	{
+		m_NrOfVirtualNodes = 0;
+		m_NrOfVirtualConnections = 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename GraphOverlay<T_NodeType, T_ConnectionType>::NeighborRange GraphOverlay<T_NodeType, T_ConnectionType>::GetNeighbors(int idx) const
+	{
+		// Virtual nodes only have virtual connections, any (empty) range of the base graph will do to skip it
+		static const typename IGraph<T_NodeType, T_ConnectionType>::ConnectionList noConnections{};
+		const auto baseRange = IsVirtualNode(idx)
+			? typename IGraph<T_NodeType, T_ConnectionType>::NeighborRange(noConnections)
+			: m_Graph.GetNeighbors(idx);
+
+		return NeighborRange(baseRange.begin(), baseRange.end(), this, idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float GraphOverlay<T_NodeType, T_ConnectionType>::GetLandmarkLowerBound(int fromIdx, int toIdx) const
+	{
+		if (m_NrOfLandmarks == 0)
+			return 0.f;
+
+		const float* pFromDistances = GetLandmarkDistances(fromIdx);
+		const float* pToDistances = GetLandmarkDistances(toIdx);
+		if (!pFromDistances || !pToDistances)
+			return 0.f;
+
+		return m_pLandmarks->GetLowerBound(pFromDistances, pToDistances, m_NrOfLandmarks);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const float* GraphOverlay<T_NodeType, T_ConnectionType>::GetLandmarkDistances(int idx) const
+	{
+		return IsVirtualNode(idx) ? m_VirtualLandmarkDistances[GetVirtualIdx(idx)].data() : m_pLandmarks->GetDistances(idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void GraphOverlay<T_NodeType, T_ConnectionType>::UpdateLandmarkDistances()
+	{
+		// The base nodes keep their distances, so every path from a landmark to a virtual node enters the overlay through
+		// a virtual connection. Relaxing all of them once per virtual node also covers paths over several virtual nodes
+		for (int round = 0; round < m_NrOfVirtualNodes; ++round)
+		{
+			for (int connectionIdx = 0; connectionIdx < m_NrOfVirtualConnections; ++connectionIdx)
+			{
+				const GraphEdge& connection = m_VirtualConnections[connectionIdx];
+				const float* pFromDistances = GetLandmarkDistances(connection.from);
+				if (!IsVirtualNode(connection.to) || !pFromDistances)
+					continue;
+
+				// Undirected landmark tables, distances from the landmark are distances to it as well
+				std::array<float, MaxNrOfLandmarks>& toDistances = m_VirtualLandmarkDistances[GetVirtualIdx(connection.to)];
+				for (int landmark = 0; landmark < m_NrOfLandmarks; ++landmark)
+				{
+					if (pFromDistances[landmark] != FLT_MAX)
+						toDistances[landmark] = std::min(toDistances[landmark], pFromDistances[landmark] + connection.cost);
+				}
+			}
+		}
+	}
+}
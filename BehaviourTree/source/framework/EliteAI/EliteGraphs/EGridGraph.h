@@ -9,6 +9,7 @@
 #include "EIGraph.h"
 #include "EGraphConnectionTypes.h"
 #include "EGraphNodeTypes.h"
+#include "EliteGraphUtilities/EGridUtilities.h"
 
 namespace Elite
 {
@@ -247,23 +248,7 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int GridGraph<T_NodeType, T_ConnectionType>::GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const
 	{
-		int idx = invalid_node_index;
-
-		//Added extra check since  c = int(pos.x / m_CellSize); => doesnt work correcly when out of the lower bounds
 		//TODO add grid start point
-		if (pos.x < 0 || pos.y < 0)
-		{
-			return idx;
-		}
-
-		int r, c;
-
-		c = int(pos.x / m_CellSize);
-		r = int(pos.y / m_CellSize);
-
-		if (!IsWithinBounds(c, r)) 
-			return idx;
-
-		return GetIndex(c, r);
+		return GetGridCellIdxAtWorldPos(pos, m_NrOfColumns, m_NrOfRows, float(m_CellSize));
 	}
 }
\ No newline at end of file
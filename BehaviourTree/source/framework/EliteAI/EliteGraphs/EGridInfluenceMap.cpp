@@ -0,0 +1,567 @@
+#include "stdafx.h"
+#include "EGridInfluenceMap.h"
+#include "EliteGraphUtilities/EGridUtilities.h"
+
+// Only EGridInfluenceMapAVX.cpp is built with /arch:AVX, its kernel is used when the CPU supports AVX.
+// Other CPUs use SSE2 or plain code
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ELITE_INFLUENCE_SSE
+#endif
+
+using namespace Elite;
+
+const int GridInfluenceMap::sparse_span_width;
+
+namespace
+{
+	// Rows per thread propagated between two checks of the time budget
+	const int BUDGET_ROWS_PER_THREAD = 16;
+
+	// The neighbour with the strongest influence wins, keeping its sign. On a tie the first one stays,
+	// the vector paths consider the neighbours in the same order so all paths give the same result
+	inline void ConsiderNeighbor(float influence, float factor, float& strongest, float& strongestAbs)
+	{
+		const float candidate = influence * factor;
+		const float candidateAbs = fabsf(candidate);
+		if (candidateAbs > strongestAbs)
+		{
+			strongest = candidate;
+			strongestAbs = candidateAbs;
+		}
+	}
+
+#if defined(ELITE_INFLUENCE_SSE)
+	inline void ConsiderNeighbor(const float* pInfluence, __m128 factor, __m128& strongest, __m128& strongestAbs)
+	{
+		const __m128 candidate = _mm_mul_ps(_mm_loadu_ps(pInfluence), factor);
+		const __m128 candidateAbs = _mm_andnot_ps(_mm_set1_ps(-0.f), candidate);
+		const __m128 isStronger = _mm_cmpgt_ps(candidateAbs, strongestAbs);
+		strongest = _mm_or_ps(_mm_and_ps(isStronger, candidate), _mm_andnot_ps(isStronger, strongest));
+		strongestAbs = _mm_max_ps(strongestAbs, candidateAbs);
+	}
+#endif
+
+	// The CPU has to support AVX and the OS has to save the AVX registers on a context switch
+	bool IsAVXSupported()
+	{
+		static const bool isAVXSupported = []()
+		{
+#if defined(_MSC_VER)
+			int cpuInfo[4] = {};
+			__cpuid(cpuInfo, 1);
+			const bool hasAVX = (cpuInfo[2] & (1 << 28)) != 0;
+			const bool hasOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+			return hasAVX && hasOSXSAVE && (_xgetbv(0) & 0x6) == 0x6;
+#else
+			return __builtin_cpu_supports("avx") != 0;
+#endif
+		}();
+		return isAVXSupported;
+	}
+
+	// Blocked cells only get a source once they open up again
+	inline void KeepStrongerSource(float* pInfluence, const float* pSources, const float* pPassable, int nrOfCells)
+	{
+		for (int i = 0; i < nrOfCells; ++i)
+		{
+			float influenceAbs = fabsf(pInfluence[i]);
+			ConsiderNeighbor(pSources[i], pPassable[i], pInfluence[i], influenceAbs);
+		}
+	}
+}
+
+GridInfluenceMap::GridInfluenceMap(int columns, int rows, float cellSize, bool isConnectedDiagonally, float costStraight, float costDiagonal)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_Stride(columns + 2)
+	, m_CellSize(cellSize)
+	, m_IsConnectedDiagonally(isConnectedDiagonally)
+	, m_CostStraight(costStraight)
+	, m_CostDiagonal(costDiagonal)
+	, m_NrOfSpansPerRow((columns + sparse_span_width - 1) / sparse_span_width)
+{
+	const size_t bufferSize = size_t(rows + 2) * m_Stride;
+	m_Influence.resize(bufferSize, 0.f);
+	m_InfluenceDoubleBuffer.resize(bufferSize, 0.f);
+	m_Passable.resize(bufferSize, 0.f);
+
+	for (int row = 0; row < rows; ++row)
+		std::fill_n(m_Passable.begin() + (row + 1) * m_Stride + 1, columns, 1.f);
+
+	SetDecay(m_Decay);
+}
+
+GridInfluenceMap::~GridInfluenceMap()
+{
+	StopWorkers();
+}
+
+void GridInfluenceMap::PropagateInfluence(float deltaTime)
+{
+	//The interval starts counting once the previous propagation is done
+	if (!IsPropagating())
+	{
+		m_TimeSinceLastPropagation += deltaTime;
+
+		if (m_TimeSinceLastPropagation < m_PropagationInterval)
+			return;
+
+		m_TimeSinceLastPropagation = 0.f;
+	}
+
+	if (m_IsSparse || m_TimeBudget <= 0.f)
+	{
+		Propagate();
+		return;
+	}
+
+	//At least one batch per frame, so a propagation always ends
+	const auto start = std::chrono::high_resolution_clock::now();
+	const int rowsPerBatch = BUDGET_ROWS_PER_THREAD * GetNrOfThreads();
+	do
+	{
+		const int endRow = std::min(m_NextRow + rowsPerBatch, m_Rows);
+		PropagateBands(m_NextRow, endRow);
+		m_NextRow = endRow;
+	} while (m_NextRow < m_Rows &&
+		std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() < m_TimeBudget);
+
+	if (m_NextRow == m_Rows)
+		FinishPropagation();
+}
+
+void GridInfluenceMap::Propagate()
+{
+	if (m_IsSparse)
+	{
+		PropagateSparse();
+		return;
+	}
+
+	PropagateBands(m_NextRow, m_Rows);
+	FinishPropagation();
+}
+
+void GridInfluenceMap::FinishPropagation()
+{
+	m_Influence.swap(m_InfluenceDoubleBuffer);
+	m_NextRow = 0;
+}
+
+void GridInfluenceMap::Clear()
+{
+	std::fill(m_Influence.begin(), m_Influence.end(), 0.f);
+	std::fill(m_InfluenceDoubleBuffer.begin(), m_InfluenceDoubleBuffer.end(), 0.f);
+	m_Sources.clear();
+	++m_NrOfClears;
+	m_NextRow = 0;
+	m_ActiveSpans.clear();
+	if (m_IsSparse)
+		m_IsSpanActive.assign(m_IsSpanActive.size(), false);
+}
+
+int GridInfluenceMap::GetCellIdxAtWorldPos(const Vector2& pos) const
+{
+	return GetGridCellIdxAtWorldPos(pos, m_Columns, m_Rows, m_CellSize);
+}
+
+float GridInfluenceMap::GetInfluenceAtPosition(const Vector2& pos) const
+{
+	const int idx = GetCellIdxAtWorldPos(pos);
+	return IsCellValid(idx) ? GetInfluence(idx) : 0.f;
+}
+
+void GridInfluenceMap::SetInfluence(int idx, float influence)
+{
+	if (!IsCellValid(idx) || IsCellBlocked(idx))
+		return;
+
+	//Rows that are already propagated don't read it anymore, so it goes in the result as well
+	const int bufferIdx = GetBufferIdx(idx);
+	m_Influence[bufferIdx] = influence;
+	if (IsPropagating())
+		m_InfluenceDoubleBuffer[bufferIdx] = influence;
+	if (m_IsSparse)
+		ActivateSpan(idx / m_Columns * m_NrOfSpansPerRow + idx % m_Columns / sparse_span_width);
+}
+
+void GridInfluenceMap::SetInfluenceAtPosition(const Vector2& pos, float influence)
+{
+	SetInfluence(GetCellIdxAtWorldPos(pos), influence);
+}
+
+void GridInfluenceMap::AddInfluence(int row, int firstColumn, int nrOfCells, const float* pWeights, float strength)
+{
+	const int rowStart = (row + 1) * m_Stride + 1 + firstColumn;
+	float* pInfluence = m_Influence.data() + rowStart;
+	const float* pPassable = m_Passable.data() + rowStart;
+
+	for (int i = 0; i < nrOfCells; ++i)
+		pInfluence[i] += strength * pWeights[i] * pPassable[i];
+
+	//Same as SetInfluence, rows that are already propagated get it in the result
+	if (IsPropagating())
+	{
+		float* pResult = m_InfluenceDoubleBuffer.data() + rowStart;
+		for (int i = 0; i < nrOfCells; ++i)
+			pResult[i] += strength * pWeights[i] * pPassable[i];
+	}
+
+	if (m_IsSparse)
+	{
+		for (int span = firstColumn / sparse_span_width; span <= (firstColumn + nrOfCells - 1) / sparse_span_width; ++span)
+			ActivateSpan(row * m_NrOfSpansPerRow + span);
+	}
+}
+
+void GridInfluenceMap::AddSourceInfluence(int row, int firstColumn, int nrOfCells, const float* pWeights, float strength)
+{
+	if (m_Sources.empty())
+		m_Sources.resize(m_Influence.size(), 0.f);
+
+	const int rowStart = (row + 1) * m_Stride + 1 + firstColumn;
+	float* pSources = m_Sources.data() + rowStart;
+	const float* pPassable = m_Passable.data() + rowStart;
+
+	for (int i = 0; i < nrOfCells; ++i)
+		pSources[i] += strength * pWeights[i];
+
+	KeepStrongerSource(m_Influence.data() + rowStart, pSources, pPassable, nrOfCells);
+	if (IsPropagating())
+		KeepStrongerSource(m_InfluenceDoubleBuffer.data() + rowStart, pSources, pPassable, nrOfCells);
+
+	if (m_IsSparse)
+	{
+		for (int span = firstColumn / sparse_span_width; span <= (firstColumn + nrOfCells - 1) / sparse_span_width; ++span)
+			ActivateSpan(row * m_NrOfSpansPerRow + span);
+	}
+}
+
+void GridInfluenceMap::SetCellBlocked(int idx, bool isBlocked)
+{
+	if (!IsCellValid(idx) || IsCellBlocked(idx) == isBlocked)
+		return;
+
+	const int bufferIdx = GetBufferIdx(idx);
+	m_Passable[bufferIdx] = isBlocked ? 0.f : 1.f;
+	m_Influence[bufferIdx] = 0.f;
+	m_InfluenceDoubleBuffer[bufferIdx] = 0.f;
+	m_NrOfBlockedCells += isBlocked ? 1 : -1;
+}
+
+void GridInfluenceMap::SetDecay(float decay)
+{
+	m_Decay = decay;
+	m_StraightFactor = expf(-m_CostStraight * decay);
+	m_DiagonalFactor = expf(-m_CostDiagonal * decay);
+}
+
+void GridInfluenceMap::SetSparse(bool isSparse)
+{
+	if (isSparse == m_IsSparse)
+		return;
+
+	m_ActiveSpans.clear();
+	m_IsSparse = isSparse;
+	if (!isSparse)
+		return;
+
+	if (IsPropagating())
+	{
+		PropagateBands(m_NextRow, m_Rows);
+		FinishPropagation();
+	}
+
+	//Only the active spans can hold influence, in both buffers
+	m_IsSpanActive.assign(m_Rows * m_NrOfSpansPerRow, false);
+	for (int row = 0; row < m_Rows; ++row)
+	{
+		float* pRow = m_Influence.data() + (row + 1) * m_Stride + 1;
+		for (int span = 0; span < m_NrOfSpansPerRow; ++span)
+		{
+			bool isActive = false;
+			for (int column = span * sparse_span_width; column < std::min((span + 1) * sparse_span_width, m_Columns); ++column)
+			{
+				if (fabsf(pRow[column]) < m_ActiveEpsilon)
+					pRow[column] = 0.f;
+				isActive |= pRow[column] != 0.f;
+			}
+
+			if (isActive)
+				ActivateSpan(row * m_NrOfSpansPerRow + span);
+		}
+	}
+	std::fill(m_InfluenceDoubleBuffer.begin(), m_InfluenceDoubleBuffer.end(), 0.f);
+
+	m_CandidateStamps.assign(m_Rows * m_NrOfSpansPerRow, m_CandidateStamp);
+}
+
+void GridInfluenceMap::SetNrOfThreads(int nrOfThreads)
+{
+	nrOfThreads = Clamp(nrOfThreads, 1, std::max(int(std::thread::hardware_concurrency()), 1));
+	if (nrOfThreads == GetNrOfThreads())
+		return;
+
+	StopWorkers();
+
+	m_IsStopping = false;
+	for (int bandIdx = 1; bandIdx < nrOfThreads; ++bandIdx)
+		m_Workers.push_back(std::thread(&GridInfluenceMap::RunWorker, this, bandIdx, m_Generation));
+}
+
+void GridInfluenceMap::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_BandsAvailable.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+}
+
+void GridInfluenceMap::PropagateBands(int firstRow, int endRow)
+{
+	if (m_Workers.empty())
+	{
+		PropagateRows(firstRow, endRow);
+		return;
+	}
+
+	const int nrOfThreads = GetNrOfThreads();
+	const int bandHeight = (endRow - firstRow + nrOfThreads - 1) / nrOfThreads;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_FirstRow = firstRow;
+		m_EndRow = endRow;
+		m_BandHeight = bandHeight;
+		m_NrOfBusyWorkers = int(m_Workers.size());
+		++m_Generation;
+	}
+	m_BandsAvailable.notify_all();
+
+	PropagateRows(firstRow, std::min(firstRow + bandHeight, endRow));
+
+	//Nobody touches the buffers until every band is done
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_BandsDone.wait(lock, [this]() { return m_NrOfBusyWorkers == 0; });
+}
+
+void GridInfluenceMap::RunWorker(int bandIdx, int generation)
+{
+	while (true)
+	{
+		int firstRow = 0;
+		int endRow = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_BandsAvailable.wait(lock, [this, generation]() { return m_IsStopping || m_Generation != generation; });
+
+			if (m_IsStopping)
+				return;
+
+			generation = m_Generation;
+			firstRow = std::min(m_FirstRow + bandIdx * m_BandHeight, m_EndRow);
+			endRow = std::min(firstRow + m_BandHeight, m_EndRow);
+		}
+
+		PropagateRows(firstRow, endRow);
+
+		bool isLastWorker = false;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			isLastWorker = --m_NrOfBusyWorkers == 0;
+		}
+		if (isLastWorker)
+			m_BandsDone.notify_one();
+	}
+}
+
+void GridInfluenceMap::PropagateRows(int firstRow, int endRow)
+{
+	for (int row = firstRow; row < endRow; ++row)
+		PropagateSpan(row, 0, m_Columns);
+}
+
+void GridInfluenceMap::PropagateSpan(int row, int firstColumn, int endColumn)
+{
+	//Offsets of the neighbours in the buffer, straight ones first
+	const int left = -1;
+	const int right = 1;
+	const int down = -m_Stride;
+	const int up = m_Stride;
+
+	const bool hasBlockedCells = m_NrOfBlockedCells > 0;
+
+	const int rowStart = (row + 1) * m_Stride + 1;
+	const float* pInfluence = m_Influence.data() + rowStart;
+	const float* pPassable = m_Passable.data() + rowStart;
+	const float* pSources = m_Sources.empty() ? nullptr : m_Sources.data() + rowStart;
+	float* pResult = m_InfluenceDoubleBuffer.data() + rowStart;
+
+	//The SSE loop does what is left after the AVX one
+	int column = IsAVXSupported() ? PropagateSpanAVX(row, firstColumn, endColumn) : firstColumn;
+
+#if defined(ELITE_INFLUENCE_SSE)
+	const __m128 straightFactor = _mm_set1_ps(m_StraightFactor);
+	const __m128 diagonalFactor = _mm_set1_ps(m_DiagonalFactor);
+	const __m128 momentum = _mm_set1_ps(m_Momentum);
+	const __m128 one = _mm_set1_ps(1.f);
+
+	for (; column + 4 <= endColumn; column += 4)
+	{
+		const float* pCell = pInfluence + column;
+		__m128 strongest = _mm_setzero_ps();
+		__m128 strongestAbs = _mm_setzero_ps();
+
+		ConsiderNeighbor(pCell + left, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + right, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + down, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + up, straightFactor, strongest, strongestAbs);
+		if (m_IsConnectedDiagonally)
+		{
+			ConsiderNeighbor(pCell + down + left, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + down + right, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + up + left, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + up + right, diagonalFactor, strongest, strongestAbs);
+		}
+
+		//strongest + momentum * (current - strongest)
+		const __m128 current = _mm_loadu_ps(pCell);
+		__m128 result = _mm_add_ps(strongest, _mm_mul_ps(momentum, _mm_sub_ps(current, strongest)));
+		if (pSources)
+		{
+			__m128 resultAbs = _mm_andnot_ps(_mm_set1_ps(-0.f), result);
+			ConsiderNeighbor(pSources + column, one, result, resultAbs);
+		}
+		if (hasBlockedCells)
+			result = _mm_mul_ps(result, _mm_loadu_ps(pPassable + column));
+
+		_mm_storeu_ps(pResult + column, result);
+	}
+#endif
+
+	//Remaining columns, or all of them without SSE
+	for (; column < endColumn; ++column)
+	{
+		float result = PropagateCell(rowStart + column);
+		if (pSources)
+		{
+			float resultAbs = fabsf(result);
+			ConsiderNeighbor(pSources[column], 1.f, result, resultAbs);
+		}
+		if (hasBlockedCells)
+			result *= pPassable[column];
+
+		pResult[column] = result;
+	}
+}
+
+void GridInfluenceMap::PropagateSparse()
+{
+	//The spans that can change: the active ones and the ones next to them
+	++m_CandidateStamp;
+	m_CandidateSpans.clear();
+	for (int spanIdx : m_ActiveSpans)
+	{
+		const int row = spanIdx / m_NrOfSpansPerRow;
+		const int span = spanIdx % m_NrOfSpansPerRow;
+
+		for (int neighborRow = std::max(row - 1, 0); neighborRow <= std::min(row + 1, m_Rows - 1); ++neighborRow)
+		{
+			for (int neighborSpan = std::max(span - 1, 0); neighborSpan <= std::min(span + 1, m_NrOfSpansPerRow - 1); ++neighborSpan)
+			{
+				if (!m_IsConnectedDiagonally && neighborRow != row && neighborSpan != span)
+					continue;
+
+				const int neighborIdx = neighborRow * m_NrOfSpansPerRow + neighborSpan;
+				if (m_CandidateStamps[neighborIdx] != m_CandidateStamp)
+				{
+					m_CandidateStamps[neighborIdx] = m_CandidateStamp;
+					m_CandidateSpans.push_back(neighborIdx);
+				}
+			}
+		}
+	}
+
+	//Propagate the candidates, the ones that keep influence are moved to the front
+	int nrOfActiveSpans = 0;
+	for (int spanIdx : m_CandidateSpans)
+	{
+		const int row = spanIdx / m_NrOfSpansPerRow;
+		const int firstColumn = (spanIdx % m_NrOfSpansPerRow) * sparse_span_width;
+		const int endColumn = std::min(firstColumn + sparse_span_width, m_Columns);
+
+		PropagateSpan(row, firstColumn, endColumn);
+
+		float* pResult = m_InfluenceDoubleBuffer.data() + (row + 1) * m_Stride + 1;
+		bool isActive = false;
+		for (int column = firstColumn; column < endColumn; ++column)
+		{
+			if (fabsf(pResult[column]) < m_ActiveEpsilon)
+				pResult[column] = 0.f;
+			isActive |= pResult[column] != 0.f;
+		}
+
+		if (isActive)
+			m_CandidateSpans[nrOfActiveSpans++] = spanIdx;
+	}
+
+	//The rest of the result is 0 already, this buffer becomes the next result
+	for (int spanIdx : m_ActiveSpans)
+	{
+		const int firstColumn = (spanIdx % m_NrOfSpansPerRow) * sparse_span_width;
+		const int endColumn = std::min(firstColumn + sparse_span_width, m_Columns);
+		float* pRow = m_Influence.data() + (spanIdx / m_NrOfSpansPerRow + 1) * m_Stride + 1;
+		std::fill(pRow + firstColumn, pRow + endColumn, 0.f);
+		m_IsSpanActive[spanIdx] = false;
+	}
+
+	m_CandidateSpans.resize(nrOfActiveSpans);
+	m_ActiveSpans.swap(m_CandidateSpans);
+	for (int spanIdx : m_ActiveSpans)
+		m_IsSpanActive[spanIdx] = true;
+
+	m_Influence.swap(m_InfluenceDoubleBuffer);
+}
+
+void GridInfluenceMap::ActivateSpan(int spanIdx)
+{
+	if (m_IsSpanActive[spanIdx])
+		return;
+
+	m_IsSpanActive[spanIdx] = true;
+	m_ActiveSpans.push_back(spanIdx);
+}
+
+float GridInfluenceMap::PropagateCell(int bufferIdx) const
+{
+	const float* pCell = m_Influence.data() + bufferIdx;
+	const int left = -1;
+	const int right = 1;
+	const int down = -m_Stride;
+	const int up = m_Stride;
+
+	float strongest = 0.f;
+	float strongestAbs = 0.f;
+
+	ConsiderNeighbor(pCell[left], m_StraightFactor, strongest, strongestAbs);
+	ConsiderNeighbor(pCell[right], m_StraightFactor, strongest, strongestAbs);
+	ConsiderNeighbor(pCell[down], m_StraightFactor, strongest, strongestAbs);
+	ConsiderNeighbor(pCell[up], m_StraightFactor, strongest, strongestAbs);
+	if (m_IsConnectedDiagonally)
+	{
+		ConsiderNeighbor(pCell[down + left], m_DiagonalFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell[down + right], m_DiagonalFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell[up + left], m_DiagonalFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell[up + right], m_DiagonalFactor, strongest, strongestAbs);
+	}
+
+	return strongest + m_Momentum * (*pCell - strongest);
+}
@@ -0,0 +1,158 @@
+/*=============================================================================*/
+// EGridInfluenceMap.h: Influence map for grid layouts, without the nodes and connections of a graph.
+// The influence lives in one flat float buffer per grid (with a border of empty cells so the edges
+// need no special case) and propagation is a stencil over that buffer, run with SSE/AVX when available.
+// The decay per direction only changes with the decay, so it is computed once instead of once per connection.
+// Waypoint graphs keep using InfluenceMap (see EInfluenceMap.h).
+// Large maps can be split in row bands that worker threads propagate in parallel, and one propagation can
+// be spread over several frames with a time budget. Every cell only reads the previous buffer, so the
+// result doesn't depend on the number of threads or on how the rows are split.
+// Maps that are 0 almost everywhere can propagate sparse instead: only the spans of a row that hold influence
+// and their neighbours are visited, cells that decay below an epsilon become 0 and their span drops out.
+// Sources (the emitters of EInfluenceStamper.h) are kept in a buffer of their own that isn't propagated, every
+// propagation a cell keeps the stronger of its influence and its source.
+/*=============================================================================*/
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "framework/EliteAI/EliteGraphs/EGraphEnums.h"
+
+namespace Elite
+{
+	class GridInfluenceMap final
+	{
+	public:
+		GridInfluenceMap(int columns, int rows, float cellSize, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f);
+		~GridInfluenceMap();
+
+		// Propagates once every propagation interval. With a time budget a propagation that doesn't fit
+		// continues next frame, the new influence is only visible once all rows are done
+		void PropagateInfluence(float deltaTime);
+		// Propagates once, now, finishing the propagation that is in progress
+		void Propagate();
+		bool IsPropagating() const { return m_NextRow > 0; }
+		// Also removes the sources
+		void Clear();
+		// Increased by every Clear, for users that keep track of what they put in the map
+		int GetNrOfClears() const { return m_NrOfClears; }
+
+		// Cell indices are row * columns + column, like the nodes of a GridGraph
+		int GetCellIdxAtWorldPos(const Vector2& pos) const;
+		bool IsCellValid(int idx) const { return idx >= 0 && idx < m_Columns * m_Rows; }
+
+		float GetInfluence(int idx) const { return m_Influence[GetBufferIdx(idx)]; }
+		float GetInfluenceAtPosition(const Vector2& pos) const;
+		void SetInfluence(int idx, float influence);
+		void SetInfluenceAtPosition(const Vector2& pos, float influence);
+		// Adds strength * weight to nrOfCells cells of a row starting at firstColumn, blocked cells stay 0 (see EInfluenceStamper.h)
+		void AddInfluence(int row, int firstColumn, int nrOfCells, const float* pWeights, float strength);
+		// Same, but to the sources. A stronger source shows right away, where a source gets weaker the influence fades out with the propagation
+		void AddSourceInfluence(int row, int firstColumn, int nrOfCells, const float* pWeights, float strength);
+		// The columns of one row next to each other, for passes over the whole map
+		const float* GetInfluenceRow(int row) const { return m_Influence.data() + (row + 1) * m_Stride + 1; }
+
+		// Blocked cells hold no influence and don't pass it on
+		bool IsCellBlocked(int idx) const { return m_Passable[GetBufferIdx(idx)] == 0.f; }
+		void SetCellBlocked(int idx, bool isBlocked);
+
+		int GetColumns() const { return m_Columns; }
+		int GetRows() const { return m_Rows; }
+		float GetCellSize() const { return m_CellSize; }
+
+		float GetMomentum() const { return m_Momentum; }
+		void SetMomentum(float momentum) { m_Momentum = momentum; }
+
+		float GetDecay() const { return m_Decay; }
+		void SetDecay(float decay);
+
+		float GetPropagationInterval() const { return m_PropagationInterval; }
+		void SetPropagationInterval(float propagationInterval) { m_PropagationInterval = propagationInterval; }
+
+		// Threads that propagate the rows, including the calling thread
+		int GetNrOfThreads() const { return int(m_Workers.size()) + 1; }
+		void SetNrOfThreads(int nrOfThreads);
+
+		// Time PropagateInfluence may spend per frame, 0 to always propagate all rows at once
+		float GetTimeBudget() const { return m_TimeBudget; } // in milliseconds
+		void SetTimeBudget(float timeBudget) { m_TimeBudget = timeBudget; }
+
+		// Sparse propagation runs on the calling thread and always does all active spans at once
+		static const int sparse_span_width = 32; // cells of a row that are activated together
+		bool IsSparse() const { return m_IsSparse; }
+		void SetSparse(bool isSparse);
+		float GetActiveEpsilon() const { return m_ActiveEpsilon; }
+		void SetActiveEpsilon(float activeEpsilon) { m_ActiveEpsilon = activeEpsilon; }
+		int GetNrOfActiveSpans() const { return int(m_ActiveSpans.size()); } // only kept in sparse mode
+
+	private:
+		int m_Columns;
+		int m_Rows;
+		int m_Stride; // columns + the border on both sides
+		float m_CellSize;
+		bool m_IsConnectedDiagonally;
+		float m_CostStraight;
+		float m_CostDiagonal;
+
+		float m_Momentum = 0.8f; // a higher momentum means a higher tendency to retain the current influence
+		float m_Decay = 0.1f; // determines the decay in influence over distance
+		float m_StraightFactor = 1.f; // expf(-costStraight * decay)
+		float m_DiagonalFactor = 1.f; // expf(-costDiagonal * decay)
+
+		float m_PropagationInterval = .05f; //in Seconds
+		float m_TimeSinceLastPropagation = 0.0f;
+
+		// (rows + 2) * stride, the border cells stay 0
+		std::vector<float> m_Influence;
+		std::vector<float> m_InfluenceDoubleBuffer;
+		std::vector<float> m_Passable; // 1 for open cells, 0 for blocked and border cells
+		std::vector<float> m_Sources; // empty until the first source is added
+		int m_NrOfBlockedCells = 0;
+		int m_NrOfClears = 0;
+
+		float m_TimeBudget = 0.f;
+		int m_NextRow = 0; // first row that still has to be propagated, 0 when no propagation is in progress
+
+		bool m_IsSparse = false;
+		float m_ActiveEpsilon = 0.01f;
+		int m_NrOfSpansPerRow;
+		std::vector<int> m_ActiveSpans; // row * spans per row + span, every cell that isn't 0 is in one
+		std::vector<bool> m_IsSpanActive;
+		std::vector<int> m_CandidateSpans; // the active spans and their neighbours
+		std::vector<int> m_CandidateStamps; // per span, the last propagation it was a candidate in
+		int m_CandidateStamp = 0;
+
+		// The calling thread propagates the first band, every worker one of the others
+		std::vector<std::thread> m_Workers;
+
+		// Everything below is guarded by the mutex
+		std::mutex m_Mutex;
+		std::condition_variable m_BandsAvailable;
+		std::condition_variable m_BandsDone;
+		bool m_IsStopping = false;
+		int m_Generation = 0; // increased for every set of bands
+		int m_FirstRow = 0;
+		int m_EndRow = 0;
+		int m_BandHeight = 0;
+		int m_NrOfBusyWorkers = 0;
+
+		int GetBufferIdx(int idx) const { return (idx / m_Columns + 1) * m_Stride + idx % m_Columns + 1; }
+		void PropagateRows(int firstRow, int endRow);
+		void PropagateSpan(int row, int firstColumn, int endColumn);
+		// In EGridInfluenceMapAVX.cpp, propagates 8 columns at a time and returns the first column it didn't do
+		int PropagateSpanAVX(int row, int firstColumn, int endColumn);
+		float PropagateCell(int bufferIdx) const;
+		void PropagateSparse();
+		void ActivateSpan(int spanIdx);
+		// Splits the rows over all threads and returns once they are all done
+		void PropagateBands(int firstRow, int endRow);
+		void FinishPropagation();
+		void StopWorkers();
+		void RunWorker(int bandIdx, int generation);
+
+		GridInfluenceMap(const GridInfluenceMap&) = delete;
+		GridInfluenceMap& operator=(const GridInfluenceMap&) = delete;
+	};
+}
@@ -0,0 +1,85 @@
+#include "stdafx.h"
+#include "EGridInfluenceMap.h"
+
+// The only file built with /arch:AVX, GridInfluenceMap::PropagateSpan only calls in here when the CPU supports AVX.
+// Without the flag the span is left to the SSE2 and plain code
+#if defined(__AVX__)
+	#include <immintrin.h>
+#endif
+
+using namespace Elite;
+
+#if defined(__AVX__)
+namespace
+{
+	inline void ConsiderNeighbor(const float* pInfluence, __m256 factor, __m256& strongest, __m256& strongestAbs)
+	{
+		const __m256 candidate = _mm256_mul_ps(_mm256_loadu_ps(pInfluence), factor);
+		const __m256 candidateAbs = _mm256_andnot_ps(_mm256_set1_ps(-0.f), candidate);
+		const __m256 isStronger = _mm256_cmp_ps(candidateAbs, strongestAbs, _CMP_GT_OQ);
+		//A mask select instead of _mm256_blendv_ps, compilers can turn that one into an integer select that needs AVX2
+		strongest = _mm256_or_ps(_mm256_and_ps(isStronger, candidate), _mm256_andnot_ps(isStronger, strongest));
+		strongestAbs = _mm256_max_ps(strongestAbs, candidateAbs);
+	}
+}
+#endif
+
+int GridInfluenceMap::PropagateSpanAVX(int row, int firstColumn, int endColumn)
+{
+	int column = firstColumn;
+
+#if defined(__AVX__)
+	//Offsets of the neighbours in the buffer, straight ones first
+	const int left = -1;
+	const int right = 1;
+	const int down = -m_Stride;
+	const int up = m_Stride;
+
+	const bool hasBlockedCells = m_NrOfBlockedCells > 0;
+
+	const int rowStart = (row + 1) * m_Stride + 1;
+	const float* pInfluence = m_Influence.data() + rowStart;
+	const float* pPassable = m_Passable.data() + rowStart;
+	const float* pSources = m_Sources.empty() ? nullptr : m_Sources.data() + rowStart;
+	float* pResult = m_InfluenceDoubleBuffer.data() + rowStart;
+
+	const __m256 straightFactor = _mm256_set1_ps(m_StraightFactor);
+	const __m256 diagonalFactor = _mm256_set1_ps(m_DiagonalFactor);
+	const __m256 momentum = _mm256_set1_ps(m_Momentum);
+	const __m256 one = _mm256_set1_ps(1.f);
+
+	for (; column + 8 <= endColumn; column += 8)
+	{
+		const float* pCell = pInfluence + column;
+		__m256 strongest = _mm256_setzero_ps();
+		__m256 strongestAbs = _mm256_setzero_ps();
+
+		ConsiderNeighbor(pCell + left, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + right, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + down, straightFactor, strongest, strongestAbs);
+		ConsiderNeighbor(pCell + up, straightFactor, strongest, strongestAbs);
+		if (m_IsConnectedDiagonally)
+		{
+			ConsiderNeighbor(pCell + down + left, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + down + right, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + up + left, diagonalFactor, strongest, strongestAbs);
+			ConsiderNeighbor(pCell + up + right, diagonalFactor, strongest, strongestAbs);
+		}
+
+		//strongest + momentum * (current - strongest)
+		const __m256 current = _mm256_loadu_ps(pCell);
+		__m256 result = _mm256_add_ps(strongest, _mm256_mul_ps(momentum, _mm256_sub_ps(current, strongest)));
+		if (pSources)
+		{
+			__m256 resultAbs = _mm256_andnot_ps(_mm256_set1_ps(-0.f), result);
+			ConsiderNeighbor(pSources + column, one, result, resultAbs);
+		}
+		if (hasBlockedCells)
+			result = _mm256_mul_ps(result, _mm256_loadu_ps(pPassable + column));
+
+		_mm256_storeu_ps(pResult + column, result);
+	}
+#endif
+
+	return column;
+}
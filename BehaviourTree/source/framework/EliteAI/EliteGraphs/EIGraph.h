@@ -21,6 +21,62 @@ namespace Elite
 		using NodeVector = std::vector<T_NodeType*>;
 		using ConnectionList = std::list<T_ConnectionType*>; // TODO: function definition doesn't recognize this?
 		using ConnectionListVector = std::vector<ConnectionList>;
+		using ConnectionChangedCallback = std::function<void(int from, int to)>;
+
+		// Iterates the connections of a node as GraphEdge values, so algorithms can treat
+		// this graph and a baked CSRGraph the same way
+		class NeighborRange final
+		{
+		public:
+			class Iterator final
+			{
+			public:
+				explicit Iterator(typename ConnectionList::const_iterator it) : m_It(it) {}
+
+				GraphEdge operator*() const { return GraphEdge{ (*m_It)->GetFrom(), (*m_It)->GetTo(), (*m_It)->GetCost() }; }
+				Iterator& operator++() { ++m_It; return *this; }
+				bool operator!=(const Iterator& other) const { return m_It != other.m_It; }
+
+			private:
+				typename ConnectionList::const_iterator m_It;
+			};
+
+			explicit NeighborRange(const ConnectionList& connections) : m_pConnections(&connections) {}
+
+			Iterator begin() const { return Iterator(m_pConnections->begin()); }
+			Iterator end() const { return Iterator(m_pConnections->end()); }
+
+		private:
+			const ConnectionList* m_pConnections;
+		};
+
+		// Iterates the connections leading to a node, see EnableIncomingConnections
+		class IncomingNeighborRange final
+		{
+		public:
+			using IncomingList = std::vector<std::pair<int, T_ConnectionType*>>;
+
+			class Iterator final
+			{
+			public:
+				explicit Iterator(typename IncomingList::const_iterator it) : m_It(it) {}
+
+				GraphEdge operator*() const { return GraphEdge{ m_It->second->GetFrom(), m_It->second->GetTo(), m_It->second->GetCost() }; }
+				Iterator& operator++() { ++m_It; return *this; }
+				bool operator!=(const Iterator& other) const { return m_It != other.m_It; }
+
+			private:
+				typename IncomingList::const_iterator m_It;
+			};
+
+			explicit IncomingNeighborRange(const IncomingList& connections) : m_pConnections(&connections) {}
+
+			Iterator begin() const { return Iterator(m_pConnections->begin()); }
+			Iterator end() const { return Iterator(m_pConnections->end()); }
+
+		private:
+			const IncomingList* m_pConnections;
+		};
 
 	public:
 		IGraph(bool isDirectionalGraph);
@@ -37,6 +93,7 @@ namespace Elite
 		const ConnectionListVector& GetAllConnections() const { return m_Connections; }
 		const ConnectionList& GetNodeConnections(int idx) const;
 		const ConnectionList& GetNodeConnections(T_NodeType* pNode) const { return GetNodeConnections(pNode->GetIndex()); }
+		NeighborRange GetNeighbors(int idx) const { return NeighborRange(GetNodeConnections(idx)); }
 
 		int GetNextFreeNodeIndex() const { return m_NextNodeIndex; }
 		int AddNode(T_NodeType* pNode);
@@ -81,6 +138,18 @@ namespace Elite
 		// Allow derived classes to implement a cloning function that returns a base class pointer
 		virtual std::shared_ptr<IGraph<T_NodeType, T_ConnectionType>> Clone() const { return nullptr; };
 
+		// Listeners are told about every connection that was added, removed or changed its cost (after the change),
+		// so systems built on top of the graph can update only what changed. Listeners aren't copied with the graph.
+		// Clear and RemoveConnections tell them once with invalid_node_index for both nodes: everything changed
+		int AddConnectionChangedListener(ConnectionChangedCallback callback);
+		void RemoveConnectionChangedListener(int listenerId);
+
+		// Optional index of the connections leading to every node, kept up to date while enabled.
+		// Only needed for directional graphs, in other graphs the incoming connections mirror the outgoing ones
+		void EnableIncomingConnections(bool isEnabled);
+		bool HasIncomingConnections() const { return m_HasIncomingConnections; }
+		IncomingNeighborRange GetIncomingNeighbors(int idx) const;
+
 	protected:
 		// A vector of adjacency pConnection lists, mapped to the indices of the nodes
 		// m_Edges[0] returns the list of connections of the pNode with index 0
@@ -93,9 +162,21 @@ namespace Elite
 		// Called whenever the graph is modified, to be overriden by derived classes
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
 
+		void NotifyConnectionChanged(int from, int to);
+		void NotifyAllConnectionsChanged();
+
 	private:
 		int m_NextNodeIndex;
 
+		std::vector<std::pair<int, ConnectionChangedCallback>> m_ConnectionChangedListeners;
+		int m_NextListenerId = 0;
+
+		// Per node, the index of the from node with the connection itself. The index is stored so entries
+		// of deleted connections can be found without dereferencing them
+		bool m_HasIncomingConnections = false;
+		std::vector<typename IncomingNeighborRange::IncomingList> m_IncomingConnections;
+		void UpdateIncomingConnection(int from, int to);
+
 		// private functions
 		void CullInvalidEdges();
 	};
@@ -132,11 +213,16 @@ namespace Elite
 
 		m_IsDirectionalGraph = other.m_IsDirectionalGraph;
 		m_NextNodeIndex = other.m_NextNodeIndex;
+
+		// The index points to the connections of the other graph, build a new one
+		EnableIncomingConnections(other.m_HasIncomingConnections);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline IGraph<T_NodeType, T_ConnectionType>::~IGraph()
 	{
+		// Nothing can use the graph anymore, so listeners aren't told
+		m_ConnectionChangedListeners.clear();
 		Clear();
 	}
 
@@ -256,6 +342,7 @@ namespace Elite
 
 						auto conPtr = *currentEdgeOnToNode;
 						currentEdgeOnToNode = m_Connections[(*currentConnection)->GetTo()].erase(currentEdgeOnToNode);
+						NotifyConnectionChanged(conPtr->GetFrom(), idx);
 						SAFE_DELETE(conPtr);
 
 						break;
@@ -265,13 +352,18 @@ namespace Elite
 		}
 
 		//finally, clear this pNode's connections
+		std::vector<int> removedConnectionsTo{};
 		for (auto& connection : m_Connections[idx])
 		{
 			hadConnections = true;
+			removedConnectionsTo.push_back(connection->GetTo());
 			SAFE_DELETE(connection);
 		}
 		m_Connections[idx].clear();
 
+		for (int to : removedConnectionsTo)
+			NotifyConnectionChanged(idx, to);
+
 		OnGraphModified(true, hadConnections);
 	}
 
@@ -290,6 +382,7 @@ namespace Elite
 			assert(IsUniqueConnection(pConnection->GetFrom(), pConnection->GetTo()) && "Connection already exists on this graph");
 			
 			m_Connections[pConnection->GetFrom()].push_back(pConnection);
+			NotifyConnectionChanged(pConnection->GetFrom(), pConnection->GetTo());
 
 			//if the graph is undirected we must add another pConnection in the opposite
 			//direction
@@ -305,6 +398,7 @@ namespace Elite
 					oppositeDirEdge->SetFrom(pConnection->GetTo());
 
 					m_Connections[pConnection->GetTo()].push_back(oppositeDirEdge);
+					NotifyConnectionChanged(pConnection->GetTo(), pConnection->GetFrom());
 				}
 			}
 		}
@@ -347,7 +441,14 @@ namespace Elite
 		}
 
 		SAFE_DELETE(conFromTo);
-		SAFE_DELETE(conToFrom);
+		NotifyConnectionChanged(from, to);
+
+		// A directional graph keeps the opposite connection
+		if (!m_IsDirectionalGraph)
+		{
+			SAFE_DELETE(conToFrom);
+			NotifyConnectionChanged(to, from);
+		}
 
 		OnGraphModified(false, true);
 	}
@@ -362,10 +463,17 @@ namespace Elite
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnectionsToAdjacentNodes(int idx)
 	{
 		// remove and delete connections from this pNode
+		std::vector<int> removedConnectionsTo{};
 		for (auto c : m_Connections[idx])
+		{
+			removedConnectionsTo.push_back(c->GetTo());
 			delete c;
+		}
 		m_Connections[idx].clear();
 
+		for (int to : removedConnectionsTo)
+			NotifyConnectionChanged(idx, to);
+
 		// remove and delete connections from other nodes to this pNode
 		auto isConnectionToThisNode = [idx](T_ConnectionType* pCon) { return pCon->GetTo() == idx; };
 		for (auto& c : m_Connections)
@@ -373,8 +481,10 @@ namespace Elite
 			std::list<T_ConnectionType*>::iterator foundIt;
 			while ((foundIt = std::find_if(c.begin(), c.end(), isConnectionToThisNode))	!= c.end())
 			{
+				const int from = (*foundIt)->GetFrom();
 				delete *foundIt;
 				c.erase(foundIt);
+				NotifyConnectionChanged(from, idx);
 			}
 		}
 
@@ -393,9 +503,92 @@ namespace Elite
 			curEdge != m_Connections[from].end();
 			++curEdge)
 		{
-			if (curEdge->GetTo() == to)
+			if ((*curEdge)->GetTo() == to)
 			{
-				curEdge->SetCost(cost);
+				(*curEdge)->SetCost(cost);
+				NotifyConnectionChanged(from, to);
+				break;
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int IGraph<T_NodeType, T_ConnectionType>::AddConnectionChangedListener(ConnectionChangedCallback callback)
+	{
+		m_ConnectionChangedListeners.push_back({ m_NextListenerId, callback });
+		return m_NextListenerId++;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnectionChangedListener(int listenerId)
+	{
+		auto isListener = [listenerId](const std::pair<int, ConnectionChangedCallback>& listener) { return listener.first == listenerId; };
+		m_ConnectionChangedListeners.erase(
+			std::remove_if(m_ConnectionChangedListeners.begin(), m_ConnectionChangedListeners.end(), isListener),
+			m_ConnectionChangedListeners.end());
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::NotifyConnectionChanged(int from, int to)
+	{
+		UpdateIncomingConnection(from, to);
+
+		for (const auto& listener : m_ConnectionChangedListeners)
+			listener.second(from, to);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::NotifyAllConnectionsChanged()
+	{
+		for (const auto& listener : m_ConnectionChangedListeners)
+			listener.second(invalid_node_index, invalid_node_index);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::EnableIncomingConnections(bool isEnabled)
+	{
+		m_HasIncomingConnections = isEnabled;
+		m_IncomingConnections.clear();
+
+		if (!isEnabled)
+			return;
+
+		m_IncomingConnections.resize(m_Nodes.size());
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto pConnection : connectionList)
+				m_IncomingConnections[pConnection->GetTo()].push_back({ pConnection->GetFrom(), pConnection });
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline typename IGraph<T_NodeType, T_ConnectionType>::IncomingNeighborRange IGraph<T_NodeType, T_ConnectionType>::GetIncomingNeighbors(int idx) const
+	{
+		assert(m_HasIncomingConnections && "<Graph::GetIncomingNeighbors>: the incoming connections aren't enabled");
+		assert((idx < (int)m_IncomingConnections.size()) && (idx >= 0) && "<Graph::GetIncomingNeighbors>: invalid index");
+
+		return IncomingNeighborRange(m_IncomingConnections[idx]);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::UpdateIncomingConnection(int from, int to)
+	{
+		if (!m_HasIncomingConnections)
+			return;
+
+		if (m_IncomingConnections.size() < m_Nodes.size())
+			m_IncomingConnections.resize(m_Nodes.size());
+
+		// The connection was added, removed or changed its cost, so drop the old entry and add the current one
+		auto& incomingConnections = m_IncomingConnections[to];
+		auto isFromNode = [from](const std::pair<int, T_ConnectionType*>& incoming) { return incoming.first == from; };
+		incomingConnections.erase(std::remove_if(incomingConnections.begin(), incomingConnections.end(), isFromNode), incomingConnections.end());
+
+		for (auto pConnection : m_Connections[from])
+		{
+			if (pConnection->GetTo() == to)
+			{
+				incomingConnections.push_back({ from, pConnection });
 				break;
 			}
 		}
@@ -441,15 +634,27 @@ namespace Elite
 				SAFE_DELETE(connection);
 		}
 		m_Connections.clear();
+		m_IncomingConnections.clear();
 
 		m_NextNodeIndex = 0;
+
+		NotifyAllConnectionsChanged();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnections()
 	{
 		for (auto& connectionList : m_Connections)
+		{
+			for (auto& connection : connectionList)
+				SAFE_DELETE(connection);
 			connectionList.clear();
+		}
+
+		for (auto& incomingConnections : m_IncomingConnections)
+			incomingConnections.clear();
+
+		NotifyAllConnectionsChanged();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
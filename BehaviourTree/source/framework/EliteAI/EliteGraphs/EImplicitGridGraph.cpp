@@ -0,0 +1,162 @@
+#include "stdafx.h"
+#include "EImplicitGridGraph.h"
+#include "EliteGraphUtilities/EGridUtilities.h"
+
+using namespace Elite;
+
+const TerrainType ImplicitGridGraph::m_TerrainTypes[3] = { TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
+const int ImplicitGridGraph::m_DirectionCols[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+const int ImplicitGridGraph::m_DirectionRows[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+ImplicitGridGraph::ImplicitGridGraph(
+	int columns,
+	int rows,
+	int cellSize,
+	bool isDirectionalGraph,
+	bool isConnectedDiagonally,
+	float costStraight /* = 1.f*/,
+	float costDiagonal /* = 1.5f */)
+	: m_NrOfColumns(columns)
+	, m_NrOfRows(rows)
+	, m_CellSize(cellSize)
+	, m_IsDirectionalGraph(isDirectionalGraph)
+	, m_IsConnectedDiagonally(isConnectedDiagonally)
+	, m_DefaultCostStraight(costStraight)
+	, m_DefaultCostDiagonal(costDiagonal)
+	, m_Cells(columns * rows, 0) // every cell starts out as ground
+{
+}
+
+void ImplicitGridGraph::SetTerrainType(int idx, TerrainType terrain)
+{
+	assert(IsNodeValid(idx) && "<ImplicitGridGraph::SetTerrainType>: invalid index");
+
+	const auto it = std::find(std::begin(m_TerrainTypes), std::end(m_TerrainTypes), terrain);
+	assert(it != std::end(m_TerrainTypes) && "<ImplicitGridGraph::SetTerrainType>: unknown terrain type");
+
+	const unsigned char terrainIdx = (unsigned char)(it - std::begin(m_TerrainTypes));
+	m_Cells[idx] = (m_Cells[idx] & m_StoredConnectionFlag) | terrainIdx;
+}
+
+bool ImplicitGridGraph::TryGetConnectionCost(int fromIdx, int toIdx, float& cost) const
+{
+	const Vector2 fromPos = GetNodePos(fromIdx);
+	const Vector2 toPos = GetNodePos(toIdx);
+
+	const int deltaCol = abs(int(toPos.x) - int(fromPos.x));
+	const int deltaRow = abs(int(toPos.y) - int(fromPos.y));
+	const bool isDiagonal = deltaCol == 1 && deltaRow == 1;
+
+	if (deltaCol > 1 || deltaRow > 1 || fromIdx == toIdx || (isDiagonal && !m_IsConnectedDiagonally))
+		return false;
+
+	return TryGetConnectionCost(fromIdx, toIdx, isDiagonal, cost);
+}
+
+void ImplicitGridGraph::RemoveConnection(int fromIdx, int toIdx)
+{
+	StoreConnection(fromIdx, toIdx, m_RemovedConnectionCost);
+	if (!m_IsDirectionalGraph)
+		StoreConnection(toIdx, fromIdx, m_RemovedConnectionCost);
+}
+
+void ImplicitGridGraph::SetConnectionCost(int fromIdx, int toIdx, float cost)
+{
+	assert(cost >= 0.f && "<ImplicitGridGraph::SetConnectionCost>: use RemoveConnection to remove a connection");
+
+	StoreConnection(fromIdx, toIdx, cost);
+	if (!m_IsDirectionalGraph)
+		StoreConnection(toIdx, fromIdx, cost);
+}
+
+void ImplicitGridGraph::ResetConnection(int fromIdx, int toIdx)
+{
+	EraseConnection(fromIdx, toIdx);
+	if (!m_IsDirectionalGraph)
+		EraseConnection(toIdx, fromIdx);
+}
+
+void ImplicitGridGraph::RemoveConnectionsToAdjacentNodes(int idx)
+{
+	const Vector2 colRow = GetNodePos(idx);
+
+	for (int direction = 0; direction < GetNrOfDirections(); ++direction)
+	{
+		const int neighborCol = int(colRow.x) + m_DirectionCols[direction];
+		const int neighborRow = int(colRow.y) + m_DirectionRows[direction];
+
+		if (!IsWithinBounds(neighborCol, neighborRow))
+			continue;
+
+		// Connections are removed in both directions, also for directional graphs (same as IGraph)
+		const int neighborIdx = GetIndex(neighborCol, neighborRow);
+		StoreConnection(idx, neighborIdx, m_RemovedConnectionCost);
+		StoreConnection(neighborIdx, idx, m_RemovedConnectionCost);
+	}
+}
+
+void ImplicitGridGraph::AddConnectionsToAdjacentCells(int idx)
+{
+	const Vector2 colRow = GetNodePos(idx);
+
+	for (int direction = 0; direction < GetNrOfDirections(); ++direction)
+	{
+		const int neighborCol = int(colRow.x) + m_DirectionCols[direction];
+		const int neighborRow = int(colRow.y) + m_DirectionRows[direction];
+
+		if (!IsWithinBounds(neighborCol, neighborRow))
+			continue;
+
+		const int neighborIdx = GetIndex(neighborCol, neighborRow);
+		EraseConnection(idx, neighborIdx);
+		EraseConnection(neighborIdx, idx);
+	}
+}
+
+Vector2 ImplicitGridGraph::GetNodeWorldPos(int col, int row) const
+{
+	Vector2 cellCenterOffset = { m_CellSize / 2.f, m_CellSize / 2.f };
+	return Vector2{ (float)col * m_CellSize, (float)row * m_CellSize } + cellCenterOffset;
+}
+
+Vector2 ImplicitGridGraph::GetNodeWorldPos(int idx) const
+{
+	auto colRow = GetNodePos(idx);
+	return GetNodeWorldPos((int)colRow.x, (int)colRow.y);
+}
+
+int ImplicitGridGraph::GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const
+{
+	return GetGridCellIdxAtWorldPos(pos, m_NrOfColumns, m_NrOfRows, float(m_CellSize));
+}
+
+void ImplicitGridGraph::StoreConnection(int fromIdx, int toIdx, float cost)
+{
+	assert(IsNodeValid(fromIdx) && IsNodeValid(toIdx) && "<ImplicitGridGraph::StoreConnection>: invalid index");
+
+	m_StoredConnections[GetConnectionKey(fromIdx, toIdx)] = cost;
+	m_Cells[fromIdx] |= m_StoredConnectionFlag;
+}
+
+void ImplicitGridGraph::EraseConnection(int fromIdx, int toIdx)
+{
+	if (m_StoredConnections.erase(GetConnectionKey(fromIdx, toIdx)) > 0)
+		UpdateStoredConnectionFlag(fromIdx);
+}
+
+void ImplicitGridGraph::UpdateStoredConnectionFlag(int idx)
+{
+	const Vector2 colRow = GetNodePos(idx);
+
+	for (int direction = 0; direction < 8; ++direction)
+	{
+		const int neighborCol = int(colRow.x) + m_DirectionCols[direction];
+		const int neighborRow = int(colRow.y) + m_DirectionRows[direction];
+
+		if (IsWithinBounds(neighborCol, neighborRow)
+			&& m_StoredConnections.find(GetConnectionKey(idx, GetIndex(neighborCol, neighborRow))) != m_StoredConnections.end())
+			return;
+	}
+
+	m_Cells[idx] &= m_TerrainMask;
+}
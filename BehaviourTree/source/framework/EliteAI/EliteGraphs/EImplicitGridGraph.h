@@ -0,0 +1,175 @@
+/*=============================================================================*/
+// EImplicitGridGraph.h: Grid shaped terrain graph that doesn't store nodes or connections.
+// Every cell is a single byte (terrain + a flag), neighbors and their costs are derived
+// from the column/row and terrain of the cells, using the same rules as GridGraph.
+// Only connections that were removed or given a custom cost are stored explicitly.
+/*=============================================================================*/
+#pragma once
+
+#include "EGraphEnums.h"
+#include "EGraphConnectionTypes.h"
+
+namespace Elite
+{
+	class ImplicitGridGraph final
+	{
+	public:
+		// Iterates the connections of one cell, skipping directions that are out of bounds, too expensive or removed
+		class NeighborRange final
+		{
+		public:
+			class Iterator final
+			{
+			public:
+				Iterator(const ImplicitGridGraph* pGraph, int idx, int direction);
+
+				const GraphEdge& operator*() const { return m_Edge; }
+				Iterator& operator++() { ++m_Direction; FindNextConnection(); return *this; }
+				bool operator!=(const Iterator& other) const { return m_Direction != other.m_Direction; }
+
+			private:
+				void FindNextConnection();
+
+				const ImplicitGridGraph* m_pGraph;
+				int m_Col;
+				int m_Row;
+				int m_Direction;
+				int m_NrOfDirections;
+				GraphEdge m_Edge;
+			};
+
+			NeighborRange(const ImplicitGridGraph* pGraph, int idx) : m_pGraph(pGraph), m_Idx(idx) {}
+
+			Iterator begin() const { return Iterator(m_pGraph, m_Idx, 0); }
+			Iterator end() const { return Iterator(m_pGraph, m_Idx, m_pGraph->GetNrOfDirections()); }
+
+		private:
+			const ImplicitGridGraph* m_pGraph;
+			int m_Idx;
+		};
+
+		ImplicitGridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f);
+
+		int GetRows() const { return m_NrOfRows; }
+		int GetColumns() const { return m_NrOfColumns; }
+		int GetCellSize() const { return m_CellSize; }
+		int GetNrOfNodes() const { return (int)m_Cells.size(); }
+		bool IsDirectionalGraph() const { return m_IsDirectionalGraph; }
+		bool IsNodeValid(int idx) const { return idx >= 0 && idx < (int)m_Cells.size(); }
+
+		bool IsWithinBounds(int col, int row) const { return col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows; }
+		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
+
+		TerrainType GetTerrainType(int idx) const { return m_TerrainTypes[m_Cells[idx] & m_TerrainMask]; }
+		void SetTerrainType(int idx, TerrainType terrain);
+
+		NeighborRange GetNeighbors(int idx) const { return NeighborRange(this, idx); }
+
+		// Returns false when there is no connection between the cells (not adjacent, removed or too expensive)
+		bool TryGetConnectionCost(int fromIdx, int toIdx, float& cost) const;
+
+		// Explicitly stored connections, in both directions when the graph isn't directional
+		void RemoveConnection(int fromIdx, int toIdx);
+		void SetConnectionCost(int fromIdx, int toIdx, float cost);
+		void ResetConnection(int fromIdx, int toIdx); // back to the cost derived from the terrain
+		void RemoveConnectionsToAdjacentNodes(int idx);
+		void AddConnectionsToAdjacentCells(int idx); // resets all connections of the cell
+		int GetNrOfStoredConnections() const { return (int)m_StoredConnections.size(); }
+
+		// returns the column and row of the node in a Vector2
+		Vector2 GetNodePos(int idx) const { return Vector2{ float(idx % m_NrOfColumns), float(idx / m_NrOfColumns) }; }
+
+		// returns the actual world position of the node
+		Vector2 GetNodeWorldPos(int col, int row) const;
+		Vector2 GetNodeWorldPos(int idx) const;
+
+		int GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const;
+
+	private:
+		// Cell layout: the low bits index m_TerrainTypes, the high bit is set when a connection of the cell is stored
+		static const unsigned char m_TerrainMask = 0x7F;
+		static const unsigned char m_StoredConnectionFlag = 0x80;
+		static const TerrainType m_TerrainTypes[3];
+
+		// Cost stored for removed connections
+		static constexpr float m_RemovedConnectionCost = -1.f;
+		// Same limit as GridGraph, connections to isolated terrain (water) never exist
+		static constexpr float m_MaxConnectionCost = 100000.f;
+
+		// Straight directions first, then the diagonal ones, in the same order as GridGraph
+		static const int m_DirectionCols[8];
+		static const int m_DirectionRows[8];
+
+		int m_NrOfColumns;
+		int m_NrOfRows;
+		int m_CellSize;
+
+		bool m_IsDirectionalGraph;
+		bool m_IsConnectedDiagonally;
+		float m_DefaultCostStraight;
+		float m_DefaultCostDiagonal;
+
+		std::vector<unsigned char> m_Cells;
+		std::unordered_map<long long, float> m_StoredConnections;
+
+		int GetNrOfDirections() const { return m_IsConnectedDiagonally ? 8 : 4; }
+		long long GetConnectionKey(int fromIdx, int toIdx) const { return (long long)fromIdx * (long long)m_Cells.size() + toIdx; }
+
+		bool TryGetConnectionCost(int fromIdx, int toIdx, bool isDiagonal, float& cost) const;
+		float CalculateConnectionCost(int fromIdx, int toIdx, bool isDiagonal) const;
+
+		void StoreConnection(int fromIdx, int toIdx, float cost);
+		void EraseConnection(int fromIdx, int toIdx);
+		void UpdateStoredConnectionFlag(int idx);
+	};
+
+	inline bool ImplicitGridGraph::TryGetConnectionCost(int fromIdx, int toIdx, bool isDiagonal, float& cost) const
+	{
+		// Only cells that are flagged have to look up their connections
+		if (m_Cells[fromIdx] & m_StoredConnectionFlag)
+		{
+			const auto it = m_StoredConnections.find(GetConnectionKey(fromIdx, toIdx));
+			if (it != m_StoredConnections.end())
+			{
+				cost = it->second;
+				return cost != m_RemovedConnectionCost;
+			}
+		}
+
+		cost = CalculateConnectionCost(fromIdx, toIdx, isDiagonal);
+		return cost < m_MaxConnectionCost;
+	}
+
+	inline float ImplicitGridGraph::CalculateConnectionCost(int fromIdx, int toIdx, bool isDiagonal) const
+	{
+		const float cost = isDiagonal ? m_DefaultCostDiagonal : m_DefaultCostStraight;
+		return cost * (int(GetTerrainType(fromIdx)) + int(GetTerrainType(toIdx))) / 2.0f;
+	}
+
+	inline ImplicitGridGraph::NeighborRange::Iterator::Iterator(const ImplicitGridGraph* pGraph, int idx, int direction)
+		: m_pGraph(pGraph)
+		, m_Col(idx % pGraph->m_NrOfColumns)
+		, m_Row(idx / pGraph->m_NrOfColumns)
+		, m_Direction(direction)
+		, m_NrOfDirections(pGraph->GetNrOfDirections())
+		, m_Edge{ idx, invalid_node_index, 0.f }
+	{
+		FindNextConnection();
+	}
+
+	inline void ImplicitGridGraph::NeighborRange::Iterator::FindNextConnection()
+	{
+		for (; m_Direction < m_NrOfDirections; ++m_Direction)
+		{
+			const int neighborCol = m_Col + m_DirectionCols[m_Direction];
+			const int neighborRow = m_Row + m_DirectionRows[m_Direction];
+
+			if (!m_pGraph->IsWithinBounds(neighborCol, neighborRow))
+				continue;
+
+			m_Edge.to = m_pGraph->GetIndex(neighborCol, neighborRow);
+			if (m_pGraph->TryGetConnectionCost(m_Edge.from, m_Edge.to, m_Direction >= 4, m_Edge.cost))
+				return;
+		}
+	}
+}
@@ -0,0 +1,233 @@
+#include "stdafx.h"
+#include "EInfluenceStamper.h"
+
+using namespace Elite;
+
+const int InfluenceStamper::invalid_emitter_id;
+
+namespace
+{
+	// Kernels are cached per eighth of a cell of radius
+	const float KERNEL_RADIUS_STEPS = 8.f;
+
+	float GetFalloff(float relativeDistance, InfluenceFalloff falloff)
+	{
+		switch (falloff)
+		{
+		case InfluenceFalloff::Linear:
+			return 1.f - relativeDistance;
+		case InfluenceFalloff::Quadratic:
+			return (1.f - relativeDistance) * (1.f - relativeDistance);
+		default:
+			return 1.f;
+		}
+	}
+}
+
+InfluenceStamper::InfluenceStamper(GridInfluenceMap* pInfluenceMap)
+	: m_pInfluenceMap(pInfluenceMap)
+	, m_NrOfClears(pInfluenceMap->GetNrOfClears())
+{
+}
+
+int InfluenceStamper::AddEmitter(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff)
+{
+	const int emitterId = m_NextEmitterId++;
+
+	Emitter& emitter = m_Emitters[emitterId];
+	emitter.stamp = CreateStamp(pos, radius, strength, falloff);
+	emitter.appliedStamp = PendingStamp{ emitter.stamp.pKernel, 0, 0, 0.f };
+	emitter.isChanged = false;
+	MarkChanged(emitterId, emitter);
+
+	return emitterId;
+}
+
+void InfluenceStamper::MoveEmitter(int emitterId, const Vector2& pos)
+{
+	auto it = m_Emitters.find(emitterId);
+	if (it == m_Emitters.end())
+		return;
+
+	const float cellSize = m_pInfluenceMap->GetCellSize();
+	it->second.stamp.column = int(floorf(pos.x / cellSize));
+	it->second.stamp.row = int(floorf(pos.y / cellSize));
+	MarkChanged(emitterId, it->second);
+}
+
+void InfluenceStamper::SetEmitterStrength(int emitterId, float strength)
+{
+	auto it = m_Emitters.find(emitterId);
+	if (it == m_Emitters.end())
+		return;
+
+	it->second.stamp.strength = strength;
+	MarkChanged(emitterId, it->second);
+}
+
+void InfluenceStamper::RemoveEmitter(int emitterId)
+{
+	auto it = m_Emitters.find(emitterId);
+	if (it == m_Emitters.end())
+		return;
+
+	//Take its stamp out of the sources with the next stamps
+	const PendingStamp& appliedStamp = it->second.appliedStamp;
+	if (appliedStamp.strength != 0.f)
+		m_PendingSourceStamps.push_back(PendingStamp{ appliedStamp.pKernel, appliedStamp.column, appliedStamp.row, -appliedStamp.strength });
+
+	m_Emitters.erase(it);
+}
+
+void InfluenceStamper::Stamp(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff)
+{
+	m_PendingStamps.push_back(CreateStamp(pos, radius, strength, falloff));
+}
+
+void InfluenceStamper::ApplyStamps()
+{
+	//A Clear took every emitter out of the map, the removals waiting for it have nothing left to subtract
+	if (m_NrOfClears != m_pInfluenceMap->GetNrOfClears())
+	{
+		m_NrOfClears = m_pInfluenceMap->GetNrOfClears();
+		m_PendingSourceStamps.clear();
+		for (auto& idEmitter : m_Emitters)
+		{
+			idEmitter.second.appliedStamp.strength = 0.f;
+			MarkChanged(idEmitter.first, idEmitter.second);
+		}
+	}
+
+	//Emitters that changed: subtract the old stamp from the sources, add the new one
+	for (int emitterId : m_ChangedEmitters)
+	{
+		auto it = m_Emitters.find(emitterId);
+		if (it == m_Emitters.end())
+			continue;
+
+		Emitter& emitter = it->second;
+		emitter.isChanged = false;
+
+		const PendingStamp& stamp = emitter.stamp;
+		PendingStamp& appliedStamp = emitter.appliedStamp;
+		if (stamp.column == appliedStamp.column && stamp.row == appliedStamp.row && stamp.strength == appliedStamp.strength)
+			continue;
+
+		//Moved less than a cell, the stamp is the same
+		if (stamp.column == appliedStamp.column && stamp.row == appliedStamp.row)
+		{
+			m_PendingSourceStamps.push_back(PendingStamp{ stamp.pKernel, stamp.column, stamp.row, stamp.strength - appliedStamp.strength });
+		}
+		else
+		{
+			if (appliedStamp.strength != 0.f)
+				m_PendingSourceStamps.push_back(PendingStamp{ appliedStamp.pKernel, appliedStamp.column, appliedStamp.row, -appliedStamp.strength });
+			m_PendingSourceStamps.push_back(stamp);
+		}
+
+		appliedStamp = stamp;
+	}
+	m_ChangedEmitters.clear();
+
+	m_StampRows.clear();
+	for (const PendingStamp& stamp : m_PendingStamps)
+		AddStampRows(stamp, false);
+	m_PendingStamps.clear();
+	for (const PendingStamp& stamp : m_PendingSourceStamps)
+		AddStampRows(stamp, true);
+	m_PendingSourceStamps.clear();
+
+	m_NrOfAppliedRows = (int)m_StampRows.size();
+	if (m_StampRows.empty())
+		return;
+
+	//Sort the rows of all stamps by map row (counting sort), so the map is walked through once from top to bottom
+	const int nrOfRows = m_pInfluenceMap->GetRows();
+	m_RowStarts.assign(nrOfRows + 1, 0);
+	for (const StampRow& stampRow : m_StampRows)
+		++m_RowStarts[stampRow.row + 1];
+	for (int row = 0; row < nrOfRows; ++row)
+		m_RowStarts[row + 1] += m_RowStarts[row];
+
+	m_SortedStampRows.resize(m_StampRows.size());
+	for (const StampRow& stampRow : m_StampRows)
+		m_SortedStampRows[m_RowStarts[stampRow.row]++] = stampRow;
+
+	for (const StampRow& stampRow : m_SortedStampRows)
+	{
+		if (stampRow.isSource)
+			m_pInfluenceMap->AddSourceInfluence(stampRow.row, stampRow.firstColumn, stampRow.nrOfCells, stampRow.pWeights, stampRow.strength);
+		else
+			m_pInfluenceMap->AddInfluence(stampRow.row, stampRow.firstColumn, stampRow.nrOfCells, stampRow.pWeights, stampRow.strength);
+	}
+}
+
+const InfluenceStamper::Kernel* InfluenceStamper::GetKernel(float radius, InfluenceFalloff falloff)
+{
+	//Radius in cells, rounded to the cached steps
+	const int radiusSteps = std::max(int(roundf(radius / m_pInfluenceMap->GetCellSize() * KERNEL_RADIUS_STEPS)), 0);
+	const std::pair<int, int> key{ int(falloff), radiusSteps };
+
+	auto it = m_Kernels.find(key);
+	if (it != m_Kernels.end())
+		return &it->second;
+
+	const float radiusInCells = radiusSteps / KERNEL_RADIUS_STEPS;
+
+	Kernel& kernel = m_Kernels[key];
+	kernel.halfSize = int(radiusInCells);
+
+	const int size = 2 * kernel.halfSize + 1;
+	kernel.weights.resize(size * size, 0.f);
+	for (int y = -kernel.halfSize; y <= kernel.halfSize; ++y)
+	{
+		for (int x = -kernel.halfSize; x <= kernel.halfSize; ++x)
+		{
+			const float distance = sqrtf(float(x * x + y * y));
+			if (distance > radiusInCells)
+				continue;
+
+			const float relativeDistance = radiusInCells > 0.f ? distance / radiusInCells : 0.f;
+			kernel.weights[(y + kernel.halfSize) * size + x + kernel.halfSize] = GetFalloff(relativeDistance, falloff);
+		}
+	}
+
+	return &kernel;
+}
+
+InfluenceStamper::PendingStamp InfluenceStamper::CreateStamp(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff)
+{
+	const float cellSize = m_pInfluenceMap->GetCellSize();
+	return PendingStamp{ GetKernel(radius, falloff), int(floorf(pos.x / cellSize)), int(floorf(pos.y / cellSize)), strength };
+}
+
+void InfluenceStamper::MarkChanged(int emitterId, Emitter& emitter)
+{
+	if (emitter.isChanged)
+		return;
+
+	emitter.isChanged = true;
+	m_ChangedEmitters.push_back(emitterId);
+}
+
+void InfluenceStamper::AddStampRows(const PendingStamp& stamp, bool isSource)
+{
+	const Kernel& kernel = *stamp.pKernel;
+	const int size = 2 * kernel.halfSize + 1;
+
+	//Clip the kernel to the map
+	const int firstColumn = std::max(stamp.column - kernel.halfSize, 0);
+	const int endColumn = std::min(stamp.column + kernel.halfSize + 1, m_pInfluenceMap->GetColumns());
+	const int firstRow = std::max(stamp.row - kernel.halfSize, 0);
+	const int endRow = std::min(stamp.row + kernel.halfSize + 1, m_pInfluenceMap->GetRows());
+
+	if (firstColumn >= endColumn || stamp.strength == 0.f)
+		return;
+
+	for (int row = firstRow; row < endRow; ++row)
+	{
+		const int kernelRow = row - (stamp.row - kernel.halfSize);
+		const int kernelColumn = firstColumn - (stamp.column - kernel.halfSize);
+		m_StampRows.push_back(StampRow{ row, firstColumn, endColumn - firstColumn, kernel.weights.data() + kernelRow * size + kernelColumn, stamp.strength, isSource });
+	}
+}
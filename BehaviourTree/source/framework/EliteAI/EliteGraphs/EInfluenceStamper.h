@@ -0,0 +1,105 @@
+/*=============================================================================*/
+// EInfluenceStamper.h: Influence over an area (explosions, purge zones, groups of agents) stamped into a
+// grid influence map, instead of one cell at a time. A stamp is a radial falloff kernel that is computed
+// once per radius and falloff and clipped to the grid.
+// Emitters keep their stamp in the sources of the map, which aren't propagated: when they move, their old stamp
+// is subtracted from the sources and the new one added, so only emitters that changed cost anything. Every
+// propagation a cell keeps the stronger of its influence and its source, what propagation spread out of a
+// stamp fades out once the emitter moves away. One off stamps are added to the influence itself.
+// All stamps are applied together, row by row through the map.
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteGraphs/EGridInfluenceMap.h"
+
+namespace Elite
+{
+	enum class InfluenceFalloff
+	{
+		Constant, // full strength up to the radius
+		Linear, // 1 - distance / radius
+		Quadratic // (1 - distance / radius)^2
+	};
+
+	class InfluenceStamper final
+	{
+	public:
+		explicit InfluenceStamper(GridInfluenceMap* pInfluenceMap);
+
+		// The radius is in world units, the stamp is centered on the cell that contains the position.
+		// Positions outside the map are fine, only the part of the stamp on the map is added
+		int AddEmitter(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff = InfluenceFalloff::Linear);
+		void MoveEmitter(int emitterId, const Vector2& pos);
+		void SetEmitterStrength(int emitterId, float strength);
+		void RemoveEmitter(int emitterId);
+
+		// One stamp that stays in the map, for events that don't move
+		void Stamp(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff = InfluenceFalloff::Linear);
+
+		// Applies every stamp and emitter change since the last call. After a Clear of the map the emitters are stamped again
+		void ApplyStamps();
+
+		int GetNrOfEmitters() const { return (int)m_Emitters.size(); }
+		int GetNrOfKernels() const { return (int)m_Kernels.size(); }
+		// Rows of stamps added to the map during the last ApplyStamps
+		int GetNrOfAppliedRows() const { return m_NrOfAppliedRows; }
+
+		static const int invalid_emitter_id = -1;
+
+	private:
+		// (2 * halfSize + 1)^2 weights, row after row
+		struct Kernel
+		{
+			int halfSize;
+			std::vector<float> weights;
+		};
+
+		struct PendingStamp
+		{
+			const Kernel* pKernel;
+			int column;
+			int row;
+			float strength;
+		};
+
+		struct Emitter
+		{
+			PendingStamp stamp;
+			PendingStamp appliedStamp; // what is in the map now, a strength of 0 while nothing is
+			bool isChanged;
+		};
+
+		// One row of a stamp, clipped to the map
+		struct StampRow
+		{
+			int row;
+			int firstColumn;
+			int nrOfCells;
+			const float* pWeights;
+			float strength;
+			bool isSource;
+		};
+
+		GridInfluenceMap* m_pInfluenceMap;
+
+		// The key is the falloff and the radius in eighths of a cell. std::map so emitters can keep a pointer
+		std::map<std::pair<int, int>, Kernel> m_Kernels{};
+
+		std::unordered_map<int, Emitter> m_Emitters{};
+		int m_NextEmitterId = 0;
+		std::vector<int> m_ChangedEmitters{};
+		int m_NrOfClears; // of the map, when the applied stamps were last in it
+
+		std::vector<PendingStamp> m_PendingStamps{};
+		std::vector<PendingStamp> m_PendingSourceStamps{}; // emitter changes
+		std::vector<StampRow> m_StampRows{};
+		std::vector<StampRow> m_SortedStampRows{};
+		std::vector<int> m_RowStarts{};
+		int m_NrOfAppliedRows = 0;
+
+		const Kernel* GetKernel(float radius, InfluenceFalloff falloff);
+		PendingStamp CreateStamp(const Vector2& pos, float radius, float strength, InfluenceFalloff falloff);
+		void MarkChanged(int emitterId, Emitter& emitter);
+		void AddStampRows(const PendingStamp& stamp, bool isSource);
+	};
+}
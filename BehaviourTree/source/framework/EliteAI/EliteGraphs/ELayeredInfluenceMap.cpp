@@ -0,0 +1,341 @@
+#include "stdafx.h"
+#include "ELayeredInfluenceMap.h"
+#include "EliteGraphUtilities/EGridUtilities.h"
+
+using namespace Elite;
+
+namespace
+{
+	// Cells that go through all instructions at once, small enough for every stack entry to stay in the cache
+	const int BLOCK_SIZE = 256;
+}
+
+//--- InfluenceExpression ---
+InfluenceExpression InfluenceExpression::Layer(const std::string& name)
+{
+	InfluenceExpression expression{};
+	expression.m_Instructions.push_back({ Operation::Layer, 0.f, name });
+	return expression;
+}
+
+InfluenceExpression InfluenceExpression::Constant(float value)
+{
+	InfluenceExpression expression{};
+	expression.m_Instructions.push_back({ Operation::Constant, value, "" });
+	return expression;
+}
+
+InfluenceExpression InfluenceExpression::Combine(const InfluenceExpression& lhs, const InfluenceExpression& rhs, Operation operation)
+{
+	InfluenceExpression expression{ lhs };
+	expression.m_Instructions.insert(expression.m_Instructions.end(), rhs.m_Instructions.begin(), rhs.m_Instructions.end());
+	expression.m_Instructions.push_back({ operation, 0.f, "" });
+	return expression;
+}
+
+namespace Elite
+{
+	InfluenceExpression operator+(const InfluenceExpression& lhs, const InfluenceExpression& rhs)
+	{
+		return InfluenceExpression::Combine(lhs, rhs, InfluenceExpression::Operation::Add);
+	}
+
+	InfluenceExpression operator-(const InfluenceExpression& lhs, const InfluenceExpression& rhs)
+	{
+		return InfluenceExpression::Combine(lhs, rhs, InfluenceExpression::Operation::Subtract);
+	}
+
+	InfluenceExpression operator*(const InfluenceExpression& lhs, const InfluenceExpression& rhs)
+	{
+		return InfluenceExpression::Combine(lhs, rhs, InfluenceExpression::Operation::Multiply);
+	}
+
+	InfluenceExpression operator-(const InfluenceExpression& expression)
+	{
+		InfluenceExpression result{ expression };
+		result.m_Instructions.push_back({ InfluenceExpression::Operation::Negate, 0.f, "" });
+		return result;
+	}
+
+	InfluenceExpression Abs(const InfluenceExpression& expression)
+	{
+		InfluenceExpression result{ expression };
+		result.m_Instructions.push_back({ InfluenceExpression::Operation::Abs, 0.f, "" });
+		return result;
+	}
+
+	InfluenceExpression Min(const InfluenceExpression& lhs, const InfluenceExpression& rhs)
+	{
+		return InfluenceExpression::Combine(lhs, rhs, InfluenceExpression::Operation::Min);
+	}
+
+	InfluenceExpression Max(const InfluenceExpression& lhs, const InfluenceExpression& rhs)
+	{
+		return InfluenceExpression::Combine(lhs, rhs, InfluenceExpression::Operation::Max);
+	}
+}
+
+//--- LayeredInfluenceMap ---
+LayeredInfluenceMap::LayeredInfluenceMap(int columns, int rows, float cellSize, bool isConnectedDiagonally, float costStraight, float costDiagonal)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_CellSize(cellSize)
+	, m_IsConnectedDiagonally(isConnectedDiagonally)
+	, m_CostStraight(costStraight)
+	, m_CostDiagonal(costDiagonal)
+	, m_BlockedCells(columns * rows, false)
+{
+}
+
+LayeredInfluenceMap::~LayeredInfluenceMap()
+{
+	for (GridInfluenceMap* pLayer : m_pLayers)
+		SAFE_DELETE(pLayer);
+}
+
+int LayeredInfluenceMap::AddLayer(const std::string& name)
+{
+	if (IsNameTaken(name))
+	{
+		std::cout << "<LayeredInfluenceMap::AddLayer>: " << name << " already exists" << std::endl;
+		return -1;
+	}
+
+	GridInfluenceMap* pLayer = new GridInfluenceMap(m_Columns, m_Rows, m_CellSize, m_IsConnectedDiagonally, m_CostStraight, m_CostDiagonal);
+	for (int idx = 0; idx < int(m_BlockedCells.size()); ++idx)
+	{
+		if (m_BlockedCells[idx])
+			pLayer->SetCellBlocked(idx, true);
+	}
+
+	m_pLayers.push_back(pLayer);
+	m_LayerNames.push_back(name);
+	return int(m_pLayers.size()) - 1;
+}
+
+int LayeredInfluenceMap::AddWorkingMap(const std::string& name, const InfluenceExpression& expression)
+{
+	if (IsNameTaken(name))
+	{
+		std::cout << "<LayeredInfluenceMap::AddWorkingMap>: " << name << " already exists" << std::endl;
+		return -1;
+	}
+
+	using Operation = InfluenceExpression::Operation;
+
+	WorkingMap workingMap{};
+	workingMap.name = name;
+
+	//Resolve the names and check that every operation has its operands
+	int depth = 0;
+	int maxDepth = 0;
+	for (const InfluenceExpression::Instruction& instruction : expression.m_Instructions)
+	{
+		CompiledInstruction compiled{ instruction.operation, instruction.constant, Source::None, -1 };
+
+		switch (instruction.operation)
+		{
+		case Operation::Layer:
+			compiled.sourceIdx = GetLayerIdx(instruction.layerName);
+			compiled.source = Source::Layer;
+			if (compiled.sourceIdx == -1)
+			{
+				compiled.sourceIdx = GetWorkingMapIdx(instruction.layerName);
+				compiled.source = Source::WorkingMap;
+			}
+			if (compiled.sourceIdx == -1)
+			{
+				std::cout << "<LayeredInfluenceMap::AddWorkingMap>: unknown layer " << instruction.layerName << std::endl;
+				return -1;
+			}
+			++depth;
+			break;
+		case Operation::Constant:
+			++depth;
+			break;
+		case Operation::Negate:
+		case Operation::Abs:
+			break;
+		default:
+			--depth;
+			break;
+		}
+
+		if (depth < 1)
+		{
+			std::cout << "<LayeredInfluenceMap::AddWorkingMap>: " << name << " has an operation without operands" << std::endl;
+			return -1;
+		}
+
+		maxDepth = std::max(maxDepth, depth);
+		workingMap.instructions.push_back(compiled);
+	}
+
+	if (depth != 1)
+	{
+		std::cout << "<LayeredInfluenceMap::AddWorkingMap>: " << name << " doesn't result in one map" << std::endl;
+		return -1;
+	}
+
+	workingMap.influence.resize(m_Columns * m_Rows, 0.f);
+	m_WorkingMaps.push_back(std::move(workingMap));
+
+	if (maxDepth > m_MaxStackDepth)
+	{
+		m_MaxStackDepth = maxDepth;
+		m_Stack.resize(m_MaxStackDepth * BLOCK_SIZE);
+	}
+
+	return int(m_WorkingMaps.size()) - 1;
+}
+
+void LayeredInfluenceMap::Update(float deltaTime)
+{
+	for (GridInfluenceMap* pLayer : m_pLayers)
+		pLayer->PropagateInfluence(deltaTime);
+
+	UpdateWorkingMaps();
+}
+
+void LayeredInfluenceMap::UpdateWorkingMaps()
+{
+	using Operation = InfluenceExpression::Operation;
+
+	if (m_WorkingMaps.empty())
+		return;
+
+	std::vector<const float*> operands(m_MaxStackDepth);
+
+	for (int row = 0; row < m_Rows; ++row)
+	{
+		for (int blockStart = 0; blockStart < m_Columns; blockStart += BLOCK_SIZE)
+		{
+			const int nrOfCells = std::min(BLOCK_SIZE, m_Columns - blockStart);
+			const int cellOffset = row * m_Columns + blockStart;
+
+			//Later working maps read the block of earlier ones while it is still in the cache
+			for (WorkingMap& workingMap : m_WorkingMaps)
+			{
+				int depth = 0;
+				for (const CompiledInstruction& instruction : workingMap.instructions)
+				{
+					switch (instruction.operation)
+					{
+					case Operation::Layer:
+						if (instruction.source == Source::Layer)
+							operands[depth] = m_pLayers[instruction.sourceIdx]->GetInfluenceRow(row) + blockStart;
+						else
+							operands[depth] = m_WorkingMaps[instruction.sourceIdx].influence.data() + cellOffset;
+						++depth;
+						break;
+					case Operation::Constant:
+					{
+						float* pResult = m_Stack.data() + depth * BLOCK_SIZE;
+						std::fill_n(pResult, nrOfCells, instruction.constant);
+						operands[depth] = pResult;
+						++depth;
+						break;
+					}
+					case Operation::Negate:
+					case Operation::Abs:
+					{
+						const float* pOperand = operands[depth - 1];
+						float* pResult = m_Stack.data() + (depth - 1) * BLOCK_SIZE;
+						if (instruction.operation == Operation::Negate)
+						{
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = -pOperand[i];
+						}
+						else
+						{
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = fabsf(pOperand[i]);
+						}
+						operands[depth - 1] = pResult;
+						break;
+					}
+					default:
+					{
+						const float* pLhs = operands[depth - 2];
+						const float* pRhs = operands[depth - 1];
+						float* pResult = m_Stack.data() + (depth - 2) * BLOCK_SIZE;
+						switch (instruction.operation)
+						{
+						case Operation::Add:
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = pLhs[i] + pRhs[i];
+							break;
+						case Operation::Subtract:
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = pLhs[i] - pRhs[i];
+							break;
+						case Operation::Multiply:
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = pLhs[i] * pRhs[i];
+							break;
+						case Operation::Min:
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = pLhs[i] < pRhs[i] ? pLhs[i] : pRhs[i];
+							break;
+						case Operation::Max:
+							for (int i = 0; i < nrOfCells; ++i)
+								pResult[i] = pLhs[i] > pRhs[i] ? pLhs[i] : pRhs[i];
+							break;
+						default:
+							break;
+						}
+						operands[depth - 2] = pResult;
+						--depth;
+						break;
+					}
+					}
+				}
+
+				std::copy_n(operands[0], nrOfCells, workingMap.influence.data() + cellOffset);
+			}
+		}
+	}
+}
+
+int LayeredInfluenceMap::GetLayerIdx(const std::string& name) const
+{
+	auto it = std::find(m_LayerNames.begin(), m_LayerNames.end(), name);
+	return it != m_LayerNames.end() ? int(it - m_LayerNames.begin()) : -1;
+}
+
+GridInfluenceMap* LayeredInfluenceMap::GetLayer(const std::string& name) const
+{
+	const int layerIdx = GetLayerIdx(name);
+	return layerIdx != -1 ? m_pLayers[layerIdx] : nullptr;
+}
+
+int LayeredInfluenceMap::GetWorkingMapIdx(const std::string& name) const
+{
+	for (int workingMapIdx = 0; workingMapIdx < int(m_WorkingMaps.size()); ++workingMapIdx)
+	{
+		if (m_WorkingMaps[workingMapIdx].name == name)
+			return workingMapIdx;
+	}
+	return -1;
+}
+
+float LayeredInfluenceMap::GetWorkingInfluenceAtPosition(int workingMapIdx, const Vector2& pos) const
+{
+	const int idx = GetCellIdxAtWorldPos(pos);
+	return idx != invalid_node_index ? m_WorkingMaps[workingMapIdx].influence[idx] : 0.f;
+}
+
+int LayeredInfluenceMap::GetCellIdxAtWorldPos(const Vector2& pos) const
+{
+	return GetGridCellIdxAtWorldPos(pos, m_Columns, m_Rows, m_CellSize);
+}
+
+void LayeredInfluenceMap::SetCellBlocked(int idx, bool isBlocked)
+{
+	if (idx < 0 || idx >= int(m_BlockedCells.size()))
+		return;
+
+	m_BlockedCells[idx] = isBlocked;
+	for (GridInfluenceMap* pLayer : m_pLayers)
+		pLayer->SetCellBlocked(idx, isBlocked);
+}
@@ -0,0 +1,126 @@
+/*=============================================================================*/
+// ELayeredInfluenceMap.h: Named influence layers on one grid, each with its own momentum, decay and
+// propagation interval, and working maps derived from them with expressions, e.g.
+//		tension = Layer("Ally") + Layer("Enemy")
+//		vulnerability = Layer("Tension") - Abs(Layer("Ally") - Layer("Enemy"))
+// The expressions are compiled to a list of instructions once. All working maps are then built in one pass
+// over the grid: a block of cells goes through every instruction while it is still in the cache,
+// instead of one pass over the whole grid per operation.
+// Cell indices match the node indices of a GridGraph with the same size (see GridGraph::GetNodeIdxAtWorldPos).
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteGraphs/EGridInfluenceMap.h"
+
+namespace Elite
+{
+	// Operations on layers (or earlier working maps) by name, and constants
+	class InfluenceExpression final
+	{
+	public:
+		static InfluenceExpression Layer(const std::string& name);
+		static InfluenceExpression Constant(float value);
+
+		friend InfluenceExpression operator+(const InfluenceExpression& lhs, const InfluenceExpression& rhs);
+		friend InfluenceExpression operator-(const InfluenceExpression& lhs, const InfluenceExpression& rhs);
+		friend InfluenceExpression operator*(const InfluenceExpression& lhs, const InfluenceExpression& rhs);
+		friend InfluenceExpression operator-(const InfluenceExpression& expression);
+		friend InfluenceExpression Abs(const InfluenceExpression& expression);
+		friend InfluenceExpression Min(const InfluenceExpression& lhs, const InfluenceExpression& rhs);
+		friend InfluenceExpression Max(const InfluenceExpression& lhs, const InfluenceExpression& rhs);
+
+	private:
+		friend class LayeredInfluenceMap;
+
+		enum class Operation { Layer, Constant, Add, Subtract, Multiply, Negate, Abs, Min, Max };
+
+		// Postfix: operands come before the operation that uses them
+		struct Instruction
+		{
+			Operation operation;
+			float constant;
+			std::string layerName;
+		};
+
+		std::vector<Instruction> m_Instructions;
+
+		static InfluenceExpression Combine(const InfluenceExpression& lhs, const InfluenceExpression& rhs, Operation operation);
+	};
+
+	class LayeredInfluenceMap final
+	{
+	public:
+		LayeredInfluenceMap(int columns, int rows, float cellSize, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f);
+		~LayeredInfluenceMap();
+
+		// Both return the index of the new layer or working map, or -1 when the name is taken.
+		// Working maps can use the layers and the working maps added before them
+		int AddLayer(const std::string& name);
+		int AddWorkingMap(const std::string& name, const InfluenceExpression& expression);
+
+		// Propagates every layer at its own interval, then rebuilds the working maps
+		void Update(float deltaTime);
+		void UpdateWorkingMaps();
+
+		int GetNrOfLayers() const { return int(m_pLayers.size()); }
+		int GetLayerIdx(const std::string& name) const;
+		const std::string& GetLayerName(int layerIdx) const { return m_LayerNames[layerIdx]; }
+		GridInfluenceMap* GetLayer(int layerIdx) const { return m_pLayers[layerIdx]; }
+		GridInfluenceMap* GetLayer(const std::string& name) const;
+
+		int GetNrOfWorkingMaps() const { return int(m_WorkingMaps.size()); }
+		int GetWorkingMapIdx(const std::string& name) const;
+		const std::string& GetWorkingMapName(int workingMapIdx) const { return m_WorkingMaps[workingMapIdx].name; }
+		float GetWorkingInfluence(int workingMapIdx, int cellIdx) const { return m_WorkingMaps[workingMapIdx].influence[cellIdx]; }
+		float GetWorkingInfluenceAtPosition(int workingMapIdx, const Vector2& pos) const;
+
+		float GetInfluenceAtPosition(int layerIdx, const Vector2& pos) const { return m_pLayers[layerIdx]->GetInfluenceAtPosition(pos); }
+		void SetInfluenceAtPosition(int layerIdx, const Vector2& pos, float influence) { m_pLayers[layerIdx]->SetInfluenceAtPosition(pos, influence); }
+
+		// Same topology for every layer
+		int GetCellIdxAtWorldPos(const Vector2& pos) const;
+		void SetCellBlocked(int idx, bool isBlocked);
+		int GetColumns() const { return m_Columns; }
+		int GetRows() const { return m_Rows; }
+
+	private:
+		// Operand of a compiled instruction, a row of a layer or of a working map
+		enum class Source { None, Layer, WorkingMap };
+
+		struct CompiledInstruction
+		{
+			InfluenceExpression::Operation operation;
+			float constant;
+			Source source;
+			int sourceIdx;
+		};
+
+		struct WorkingMap
+		{
+			std::string name;
+			std::vector<CompiledInstruction> instructions;
+			std::vector<float> influence; // rows * columns, no border
+		};
+
+		int m_Columns;
+		int m_Rows;
+		float m_CellSize;
+		bool m_IsConnectedDiagonally;
+		float m_CostStraight;
+		float m_CostDiagonal;
+
+		std::vector<GridInfluenceMap*> m_pLayers;
+		std::vector<std::string> m_LayerNames;
+		std::vector<WorkingMap> m_WorkingMaps;
+		std::vector<bool> m_BlockedCells; // given to layers that are added later
+
+		// One block of cells per stack entry of the deepest expression
+		std::vector<float> m_Stack;
+		int m_MaxStackDepth = 0;
+
+		bool IsNameTaken(const std::string& name) const { return GetLayerIdx(name) != -1 || GetWorkingMapIdx(name) != -1; }
+
+		LayeredInfluenceMap(const LayeredInfluenceMap&) = delete;
+		LayeredInfluenceMap& operator=(const LayeredInfluenceMap&) = delete;
+	};
+}
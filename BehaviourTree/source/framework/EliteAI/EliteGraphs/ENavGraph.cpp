@@ -1,31 +1,52 @@
 #include "stdafx.h"
 #include "ENavGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteHelpers\EBinaryStream.h"
 
 using namespace Elite;
 
-Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f) :
+namespace
+{
+	// First bytes of a baked navmesh file, followed by the version of the layout
+	const char NAVMESH_FILE_TAG[4] = { 'N', 'A', 'V', 'M' };
+	const int NAVMESH_FILE_VERSION = 1;
+}
+
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius, bool createClearances) :
 	Graph2D(false),
 	m_pNavMeshPolygon(nullptr)
 {
 	//Create the navigation mesh (polygon of navigatable area= Contour - Static Shapes)
-	m_pNavMeshPolygon = new Polygon(contourMesh); // Create copy on heap
-
-	//Get all shapes from all static rigidbodies with NavigationCollider flag
-	auto vShapes = PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider);
-
-	//Store all children
-	for (auto shape : vShapes)
-	{
-		shape.ExpandShape(playerRadius);
-		m_pNavMeshPolygon->AddChild(shape);
-	}
+	m_pNavMeshPolygon = CreateNavMeshPolygon(contourMesh, playerRadius);
 
 	//Triangulate
 	m_pNavMeshPolygon->Triangulate();
 
 	//Create the actual graph (nodes & connections) from the navigation mesh
 	CreateNavigationGraph();
+
+	//Store how wide the agents passing every connection can be
+	if (createClearances)
+		CreateClearances();
+}
+
+Elite::NavGraph::NavGraph(const Polygon& tileMesh, const Vector2& tileMin, const Vector2& tileMax) :
+	Graph2D(false),
+	m_pNavMeshPolygon(nullptr),
+	m_IsTile(true),
+	m_TileMin(tileMin),
+	m_TileMax(tileMax)
+{
+	m_pNavMeshPolygon = new Polygon(tileMesh);
+	m_pNavMeshPolygon->Triangulate();
+	CreateNavigationGraph();
+	CreateClearances();
+}
+
+Elite::NavGraph::NavGraph(Polygon* pNavMeshPolygon) :
+	Graph2D(false),
+	m_pNavMeshPolygon(pNavMeshPolygon)
+{
 }
 
 Elite::NavGraph::~NavGraph()
@@ -36,13 +57,10 @@ Elite::NavGraph::~NavGraph()
 
 int Elite::NavGraph::GetNodeIdxFromLineIdx(int lineIdx) const
 {
-	auto nodeIt = std::find_if(m_Nodes.begin(), m_Nodes.end(), [lineIdx](const NavGraphNode* n) { return n->GetLineIndex() == lineIdx; });
-	if (nodeIt != m_Nodes.end())
-	{
-		return (*nodeIt)->GetIndex();
-	}
+	if (lineIdx < 0 || lineIdx >= static_cast<int>(m_LineNodeIndices.size()))
+		return invalid_node_index;
 
-	return invalid_node_index;
+	return m_LineNodeIndices[lineIdx];
 }
 
 Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
@@ -50,15 +68,107 @@ Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
 	return m_pNavMeshPolygon;
 }
 
+bool Elite::NavGraph::Save(const std::string& filePath, bool includeTriangleGrid) const
+{
+	std::ofstream file(filePath, std::ios::out | std::ios::binary);
+	if (!file)
+	{
+		std::cout << "<NavGraph::Save>: can't open " << filePath << std::endl;
+		return false;
+	}
+
+	file.write(NAVMESH_FILE_TAG, sizeof(NAVMESH_FILE_TAG));
+	WriteBinary(file, NAVMESH_FILE_VERSION);
+	WriteBinary(file, m_pNavMeshPolygon->GetShapeHash());
+	m_pNavMeshPolygon->WriteTriangulation(file, includeTriangleGrid);
+
+	//Nodes in index order, so they get the same indices when they are added again
+	std::vector<int> nodeLines{};
+	std::vector<Vector2> nodePositions{};
+	for (int idx = 0; idx < GetNrOfNodes(); ++idx)
+	{
+		nodeLines.push_back(GetNode(idx)->GetLineIndex());
+		nodePositions.push_back(GetNode(idx)->GetPosition());
+	}
+
+	//The graph is undirected, every connection is stored once
+	std::vector<int> connectionNodes{};
+	std::vector<float> connectionCosts{};
+	for (const auto& connections : GetAllConnections())
+	{
+		for (const GraphConnection2D* pConnection : connections)
+		{
+			if (pConnection->GetFrom() > pConnection->GetTo())
+				continue;
+
+			connectionNodes.push_back(pConnection->GetFrom());
+			connectionNodes.push_back(pConnection->GetTo());
+			connectionCosts.push_back(pConnection->GetCost());
+		}
+	}
+
+	WriteBinaryArray(file, nodeLines);
+	WriteBinaryArray(file, nodePositions);
+	WriteBinaryArray(file, connectionNodes);
+	WriteBinaryArray(file, connectionCosts);
+
+	return file.good();
+}
+
+NavGraph* Elite::NavGraph::Load(const std::string& filePath, const Polygon& contourMesh, float playerRadius)
+{
+	std::ifstream file(filePath, std::ios::in | std::ios::binary);
+	if (!file)
+		return nullptr;
+
+	char tag[sizeof(NAVMESH_FILE_TAG)]{};
+	int version = 0;
+	uint64_t shapeHash = 0;
+	file.read(tag, sizeof(tag));
+	if (!file || !std::equal(std::begin(tag), std::end(tag), std::begin(NAVMESH_FILE_TAG))
+		|| !ReadBinary(file, version) || version != NAVMESH_FILE_VERSION || !ReadBinary(file, shapeHash))
+	{
+		std::cout << "<NavGraph::Load>: " << filePath << " is not a baked navmesh of this version" << std::endl;
+		return nullptr;
+	}
+
+	//Only the outline of the navigation mesh is made, to compare it with the one the file was baked from
+	Polygon* pNavMeshPolygon = CreateNavMeshPolygon(contourMesh, playerRadius);
+	if (pNavMeshPolygon->GetShapeHash() != shapeHash)
+	{
+		std::cout << "<NavGraph::Load>: " << filePath << " was baked from other level geometry" << std::endl;
+		SAFE_DELETE(pNavMeshPolygon);
+		return nullptr;
+	}
+
+	if (!pNavMeshPolygon->ReadTriangulation(file))
+	{
+		std::cout << "<NavGraph::Load>: " << filePath << " is incomplete" << std::endl;
+		SAFE_DELETE(pNavMeshPolygon);
+		return nullptr;
+	}
+
+	NavGraph* pNavGraph = new NavGraph(pNavMeshPolygon);
+	if (!pNavGraph->ReadGraph(file))
+	{
+		std::cout << "<NavGraph::Load>: " << filePath << " is incomplete" << std::endl;
+		SAFE_DELETE(pNavGraph);
+	}
+
+	return pNavGraph;
+}
+
 void Elite::NavGraph::CreateNavigationGraph()
 {
 	//1. Go over all the edges of the navigationmesh and create nodes
+	m_LineNodeIndices.assign(m_pNavMeshPolygon->GetLines().size(), invalid_node_index);
 	for (auto& line : m_pNavMeshPolygon->GetLines())
 	{
-		if (m_pNavMeshPolygon->GetTrianglesFromLineIndex(line->index).size() > 1)
+		if (m_pNavMeshPolygon->GetTrianglesFromLineIndex(line->index).size() > 1 || IsOnTileBorder(*line))
 		{
 			NavGraphNode* navGraphNode = new NavGraphNode(GetNextFreeNodeIndex(), line->index, Vector2((line->p1 + line->p2) / 2.f));
 			AddNode(navGraphNode);
+			m_LineNodeIndices[line->index] = navGraphNode->GetIndex();
 		}
 	}
 
@@ -71,9 +181,10 @@ void Elite::NavGraph::CreateNavigationGraph()
 		std::vector<int> indexes{};
 		for (auto& lineIdx : triangle->metaData.IndexLines)
 		{
-			if (GetNodeIdxFromLineIdx(lineIdx) != invalid_node_index)
+			const int nodeIdx = GetNodeIdxFromLineIdx(lineIdx);
+			if (nodeIdx != invalid_node_index)
 			{
-				indexes.push_back(GetNodeIdxFromLineIdx(lineIdx));
+				indexes.push_back(nodeIdx);
 			}
 		}
 
@@ -98,3 +209,139 @@ void Elite::NavGraph::CreateNavigationGraph()
 	SetConnectionCostsToDistance();
 }
 
+void Elite::NavGraph::CreateClearances()
+{
+	//Width of a triangle passed from one line to the other, the way Demyen's TRA* does it: the lines share a corner,
+	//the width is the distance from that corner to the closest obstacle on the other side (or the length of the lines)
+	m_Clearances.clear();
+	const std::vector<Line*>& lines = m_pNavMeshPolygon->GetLines();
+	for (const Triangle* pTriangle : m_pNavMeshPolygon->GetTriangles())
+	{
+		const auto& lineIndices = pTriangle->metaData.IndexLines;
+		for (int i = 0; i < 3; ++i)
+		{
+			const Line& fromLine = *lines[lineIndices[i]];
+			const Line& toLine = *lines[lineIndices[(i + 1) % 3]];
+			const int from = GetNodeIdxFromLineIdx(fromLine.index);
+			const int to = GetNodeIdxFromLineIdx(toLine.index);
+			if (from == invalid_node_index || to == invalid_node_index)
+				continue;
+
+			const Vector2 corner = (fromLine.p1 == toLine.p1 || fromLine.p1 == toLine.p2) ? fromLine.p1 : fromLine.p2;
+			const float width = std::min(Distance(fromLine.p1, fromLine.p2), Distance(toLine.p1, toLine.p2));
+			m_Clearances[GetClearanceKey(from, to)] = SearchWidth(corner, pTriangle, lineIndices[(i + 2) % 3], width) / 2.f;
+		}
+	}
+}
+
+float Elite::NavGraph::SearchWidth(const Vector2& corner, const Triangle* pTriangle, int lineIdx, float width) const
+{
+	//When the corner doesn't project on the line, its closest point is an end of the line, which the width already counts
+	const Line& line = *m_pNavMeshPolygon->GetLines()[lineIdx];
+	if (Dot(corner - line.p1, line.p2 - line.p1) <= 0.f || Dot(corner - line.p2, line.p1 - line.p2) <= 0.f)
+		return width;
+
+	const float distance = sqrtf(DistanceSquarePointToLine(line.p1, line.p2, corner));
+	if (distance >= width)
+		return width;
+
+	//Lines with one triangle are obstacle edges, except for the border of a tile
+	const auto lineTriangles = m_pNavMeshPolygon->GetTrianglesFromLineIndex(lineIdx);
+	if (lineTriangles.size() < 2)
+		return IsOnTileBorder(line) ? width : distance;
+
+	//Look further in the triangle on the other side of the line
+	const Triangle* pNext = lineTriangles[0] == pTriangle ? lineTriangles[1] : lineTriangles[0];
+	for (int nextLineIdx : pNext->metaData.IndexLines)
+	{
+		if (nextLineIdx != lineIdx)
+			width = SearchWidth(corner, pNext, nextLineIdx, width);
+	}
+	return width;
+}
+
+float Elite::NavGraph::GetClearance(int from, int to) const
+{
+	const auto it = m_Clearances.find(GetClearanceKey(from, to));
+	return it != m_Clearances.end() ? it->second : 0.f;
+}
+
+float Elite::NavGraph::GetLineClearance(int lineIdx) const
+{
+	const Line* pLine = m_pNavMeshPolygon->GetLines()[lineIdx];
+	return Distance(pLine->p1, pLine->p2) / 2.f;
+}
+
+uint64_t Elite::NavGraph::GetClearanceKey(int from, int to)
+{
+	return (static_cast<uint64_t>(std::min(from, to)) << 32) | static_cast<uint32_t>(std::max(from, to));
+}
+
+bool Elite::NavGraph::IsOnTileBorder(const Line& line) const
+{
+	//The tile polygons use the exact coordinates of the tile border, no tolerance needed
+	if (!m_IsTile)
+		return false;
+
+	return (line.p1.x == m_TileMin.x && line.p2.x == m_TileMin.x)
+		|| (line.p1.x == m_TileMax.x && line.p2.x == m_TileMax.x)
+		|| (line.p1.y == m_TileMin.y && line.p2.y == m_TileMin.y)
+		|| (line.p1.y == m_TileMax.y && line.p2.y == m_TileMax.y);
+}
+
+bool Elite::NavGraph::ReadGraph(std::istream& stream)
+{
+	std::vector<int> nodeLines{};
+	std::vector<Vector2> nodePositions{};
+	std::vector<int> connectionNodes{};
+	std::vector<float> connectionCosts{};
+	if (!ReadBinaryArray(stream, nodeLines) || !ReadBinaryArray(stream, nodePositions)
+		|| !ReadBinaryArray(stream, connectionNodes) || !ReadBinaryArray(stream, connectionCosts))
+		return false;
+
+	const int nrOfLines = static_cast<int>(m_pNavMeshPolygon->GetLines().size());
+	const int nrOfNodes = static_cast<int>(nodeLines.size());
+	if (nodePositions.size() != nodeLines.size() || connectionNodes.size() != connectionCosts.size() * 2
+		|| std::any_of(nodeLines.begin(), nodeLines.end(), [nrOfLines](int lineIdx) { return lineIdx < 0 || lineIdx >= nrOfLines; })
+		|| std::any_of(connectionNodes.begin(), connectionNodes.end(), [nrOfNodes](int nodeIdx) { return nodeIdx < 0 || nodeIdx >= nrOfNodes; }))
+		return false;
+
+	m_LineNodeIndices.assign(nrOfLines, invalid_node_index);
+	for (int idx = 0; idx < nrOfNodes; ++idx)
+	{
+		AddNode(new NavGraphNode(idx, nodeLines[idx], nodePositions[idx]));
+		m_LineNodeIndices[nodeLines[idx]] = idx;
+	}
+
+	for (size_t i = 0; i < connectionCosts.size(); ++i)
+	{
+		const int from = connectionNodes[i * 2];
+		const int to = connectionNodes[i * 2 + 1];
+		if (from == to || !IsUniqueConnection(from, to))
+			return false;
+
+		AddConnection(new GraphConnection2D(from, to, connectionCosts[i]));
+	}
+
+	CreateClearances();
+	return true;
+}
+
+Polygon* Elite::NavGraph::CreateNavMeshPolygon(const Polygon& contourMesh, float playerRadius)
+{
+	Polygon* pNavMeshPolygon = new Polygon(contourMesh); // Create copy on heap
+
+	//Get all shapes from all static rigidbodies with NavigationCollider flag
+	auto vShapes = PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider);
+
+	//Store all children
+	for (auto shape : vShapes)
+	{
+		shape.ExpandShape(playerRadius);
+		pNavMeshPolygon->AddChild(shape);
+	}
+
+	//Wound like triangulating does, so the shape hash of a baked navigation mesh matches a freshly made one
+	pNavMeshPolygon->OrientateWithChildren(Winding::CCW);
+	return pNavMeshPolygon;
+}
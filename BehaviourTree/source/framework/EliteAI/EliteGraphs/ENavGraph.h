@@ -9,17 +9,45 @@ namespace Elite
 	class NavGraph final: public Graph2D<NavGraphNode, GraphConnection2D>
 	{
 	public:
-		NavGraph(const Polygon& baseMesh, float playerRadius );
+		// Without clearances every connection has a clearance of 0, for meshes that are only used by agents of playerRadius
+		NavGraph(const Polygon& baseMesh, float playerRadius, bool createClearances = true);
+		// Navigation mesh of one tile of a TiledNavGraph, the polygon already contains its holes.
+		// Lines on the border of the tile also get a node, so the tile can be connected to its neighbours
+		NavGraph(const Polygon& tileMesh, const Vector2& tileMin, const Vector2& tileMax);
 		~NavGraph();
 
 		int GetNodeIdxFromLineIdx(int lineIdx) const;
 		Polygon* GetNavMeshPolygon() const;
 
+		// Largest agent radius that fits through a connection (the triangle between its two lines) or through a line,
+		// on top of the radius the mesh was built with. Connections that aren't in the graph have no clearance
+		float GetClearance(int from, int to) const;
+		float GetLineClearance(int lineIdx) const;
+
+		// Baked navigation mesh (triangulation, nodes and connections), written after the first build so later starts skip it.
+		// Load returns nullptr when the file is missing, invalid or baked from other geometry (contour, static shapes or radius)
+		bool Save(const std::string& filePath, bool includeTriangleGrid = true) const;
+		static NavGraph* Load(const std::string& filePath, const Polygon& contourMesh, float playerRadius);
+
 	private:
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
+		std::vector<int> m_LineNodeIndices{}; //Node index per line of the navigation mesh (invalid_node_index if the line has no node)
+		std::unordered_map<uint64_t, float> m_Clearances{}; //Clearance per connection, the key is made of its nodes (smallest first)
+		bool m_IsTile = false;
+		Vector2 m_TileMin{};
+		Vector2 m_TileMax{};
+
+		explicit NavGraph(Polygon* pNavMeshPolygon); // takes ownership of the (triangulated) polygon
 
 		void CreateNavigationGraph();
+		void CreateClearances();
+		float SearchWidth(const Vector2& corner, const Triangle* pTriangle, int lineIdx, float width) const;
+		bool IsOnTileBorder(const Line& line) const;
+		bool ReadGraph(std::istream& stream);
+
+		static Polygon* CreateNavMeshPolygon(const Polygon& contourMesh, float playerRadius);
+		static uint64_t GetClearanceKey(int from, int to);
 
 
 	private:
@@ -0,0 +1,780 @@
+#include "stdafx.h"
+#include "ETiledNavGraph.h"
+
+#include <chrono>
+#include <map>
+
+using namespace Elite;
+
+const int TiledNavGraph::invalid_obstacle_id;
+
+namespace
+{
+	// Distance within which obstacle outlines touch
+	const float ON_OUTLINE_EPSILON = 1e-4f;
+	// Part of an edge near its ends that isn't cut anymore
+	const float CUT_EPSILON = 1e-5f;
+
+	// Side of the tile border the line lies on, -1 when it isn't on the border
+	int GetTileSide(const Vector2& p1, const Vector2& p2, const Vector2& tileMin, const Vector2& tileMax)
+	{
+		if (p1.x == tileMin.x && p2.x == tileMin.x) return TiledNavGraph::Tile::Left;
+		if (p1.x == tileMax.x && p2.x == tileMax.x) return TiledNavGraph::Tile::Right;
+		if (p1.y == tileMin.y && p2.y == tileMin.y) return TiledNavGraph::Tile::Bottom;
+		if (p1.y == tileMax.y && p2.y == tileMax.y) return TiledNavGraph::Tile::Top;
+		return -1;
+	}
+}
+
+//--- Tile ---
+TiledNavGraph::Tile::Tile(int column, int row, const Vector2& tileMin, const Vector2& tileMax, const std::vector<Polygon>& regions)
+	: m_Column(column)
+	, m_Row(row)
+	, m_Min(tileMin)
+	, m_Max(tileMax)
+{
+	for (const Polygon& region : regions)
+	{
+		NavGraph* pRegion = new NavGraph(region, tileMin, tileMax);
+		m_pRegions.push_back(pRegion);
+		m_RegionFirstNodes.push_back(m_NrOfNodes);
+
+		//Store the nodes on the tile border per side, these connect to the neighbouring tiles
+		const std::vector<Line*>& lines = pRegion->GetNavMeshPolygon()->GetLines();
+		for (int nodeIdx = 0; nodeIdx < pRegion->GetNrOfNodes(); ++nodeIdx)
+		{
+			const Line* pLine = lines[pRegion->GetNode(nodeIdx)->GetLineIndex()];
+
+			int side = -1;
+			float from = 0.f, to = 0.f;
+			if (pLine->p1.x == tileMin.x && pLine->p2.x == tileMin.x)
+				side = Left;
+			else if (pLine->p1.x == tileMax.x && pLine->p2.x == tileMax.x)
+				side = Right;
+			else if (pLine->p1.y == tileMin.y && pLine->p2.y == tileMin.y)
+				side = Bottom;
+			else if (pLine->p1.y == tileMax.y && pLine->p2.y == tileMax.y)
+				side = Top;
+
+			if (side == Left || side == Right)
+			{
+				from = std::min(pLine->p1.y, pLine->p2.y);
+				to = std::max(pLine->p1.y, pLine->p2.y);
+			}
+			else
+			{
+				from = std::min(pLine->p1.x, pLine->p2.x);
+				to = std::max(pLine->p1.x, pLine->p2.x);
+			}
+
+			m_NodeSides.push_back(side);
+			if (side != -1)
+				m_BorderNodes[side].push_back(BorderNode{ from, to, m_NrOfNodes + nodeIdx });
+		}
+
+		m_NrOfNodes += pRegion->GetNrOfNodes();
+	}
+
+	for (auto& borderNodes : m_BorderNodes)
+		std::sort(borderNodes.begin(), borderNodes.end(), [](const BorderNode& a, const BorderNode& b) { return a.from < b.from; });
+}
+
+TiledNavGraph::Tile::~Tile()
+{
+	for (NavGraph*& pRegion : m_pRegions)
+		SAFE_DELETE(pRegion);
+}
+
+int TiledNavGraph::Tile::GetRegion(int& tileNodeIdx) const
+{
+	const int regionIdx = static_cast<int>(std::upper_bound(m_RegionFirstNodes.begin(), m_RegionFirstNodes.end(), tileNodeIdx) - m_RegionFirstNodes.begin()) - 1;
+	tileNodeIdx -= m_RegionFirstNodes[regionIdx];
+	return regionIdx;
+}
+
+//--- Snapshot ---
+TiledNavGraph::Snapshot::Snapshot(const std::vector<std::shared_ptr<const Tile>>& pTiles, int nrOfColumns, int nrOfRows, const Vector2& worldMin, float tileSize)
+	: m_pTiles(pTiles)
+	, m_NrOfColumns(nrOfColumns)
+	, m_NrOfRows(nrOfRows)
+	, m_WorldMin(worldMin)
+	, m_TileSize(tileSize)
+{
+	m_TileFirstNodes.reserve(m_pTiles.size());
+	for (const auto& pTile : m_pTiles)
+	{
+		m_TileFirstNodes.push_back(m_NrOfNodes);
+		m_NrOfNodes += pTile->GetNrOfNodes();
+	}
+}
+
+Vector2 TiledNavGraph::Snapshot::GetNodePos(int nodeIdx) const
+{
+	const int tileIdx = GetTileIdx(nodeIdx);
+	int regionNodeIdx = nodeIdx - m_TileFirstNodes[tileIdx];
+	const int regionIdx = m_pTiles[tileIdx]->GetRegion(regionNodeIdx);
+
+	return m_pTiles[tileIdx]->GetRegions()[regionIdx]->GetNodePos(regionNodeIdx);
+}
+
+const Line& TiledNavGraph::Snapshot::GetNodeLine(int nodeIdx) const
+{
+	const int tileIdx = GetTileIdx(nodeIdx);
+	int regionNodeIdx = nodeIdx - m_TileFirstNodes[tileIdx];
+	const NavGraph* pRegion = m_pTiles[tileIdx]->GetRegions()[m_pTiles[tileIdx]->GetRegion(regionNodeIdx)];
+
+	return *pRegion->GetNavMeshPolygon()->GetLines()[pRegion->GetNode(regionNodeIdx)->GetLineIndex()];
+}
+
+int TiledNavGraph::Snapshot::GetNodeIdx(int tileIdx, int regionIdx, int regionNodeIdx) const
+{
+	return m_TileFirstNodes[tileIdx] + m_pTiles[tileIdx]->GetFirstNode(regionIdx) + regionNodeIdx;
+}
+
+void TiledNavGraph::Snapshot::GetConnections(int nodeIdx, std::vector<GraphEdge>& connections) const
+{
+	const int tileIdx = GetTileIdx(nodeIdx);
+	const Tile& tile = *m_pTiles[tileIdx];
+	const int tileNodeIdx = nodeIdx - m_TileFirstNodes[tileIdx];
+	int regionNodeIdx = tileNodeIdx;
+	const int regionIdx = tile.GetRegion(regionNodeIdx);
+	const NavGraph* pRegion = tile.GetRegions()[regionIdx];
+
+	//Connections inside the region
+	const int firstRegionNode = nodeIdx - regionNodeIdx;
+	for (const GraphEdge& connection : pRegion->GetNeighbors(regionNodeIdx))
+		connections.push_back(GraphEdge{ nodeIdx, firstRegionNode + connection.to, connection.cost });
+
+	//Nodes on the border connect to the nodes of the neighbouring tile whose lines overlap theirs
+	const int side = tile.GetSide(tileNodeIdx);
+	if (side == -1)
+		return;
+
+	const int neighbourIdx = GetNeighbourTileIdx(tileIdx, side);
+	if (neighbourIdx == -1)
+		return;
+
+	const Line& line = *pRegion->GetNavMeshPolygon()->GetLines()[pRegion->GetNode(regionNodeIdx)->GetLineIndex()];
+	const bool isVertical = side == Tile::Left || side == Tile::Right;
+	const float from = isVertical ? std::min(line.p1.y, line.p2.y) : std::min(line.p1.x, line.p2.x);
+	const float to = isVertical ? std::max(line.p1.y, line.p2.y) : std::max(line.p1.x, line.p2.x);
+	const Vector2 position = pRegion->GetNodePos(regionNodeIdx);
+
+	const Tile& neighbour = *m_pTiles[neighbourIdx];
+	for (const Tile::BorderNode& borderNode : neighbour.GetBorderNodes((side + 2) % Tile::NrOfSides))
+	{
+		if (borderNode.from >= to)
+			break;
+		if (borderNode.to <= from)
+			continue;
+
+		const int neighbourNodeIdx = m_TileFirstNodes[neighbourIdx] + borderNode.tileNodeIdx;
+		connections.push_back(GraphEdge{ nodeIdx, neighbourNodeIdx, Distance(position, GetNodePos(neighbourNodeIdx)) });
+	}
+}
+
+const Triangle* TiledNavGraph::Snapshot::GetTriangleFromPosition(const Vector2& position, int& tileIdx, int& regionIdx) const
+{
+	const int column = static_cast<int>(floorf((position.x - m_WorldMin.x) / m_TileSize));
+	const int row = static_cast<int>(floorf((position.y - m_WorldMin.y) / m_TileSize));
+	if (column < 0 || column >= m_NrOfColumns || row < 0 || row >= m_NrOfRows)
+		return nullptr;
+
+	tileIdx = row * m_NrOfColumns + column;
+	const std::vector<NavGraph*>& pRegions = m_pTiles[tileIdx]->GetRegions();
+	for (regionIdx = 0; regionIdx < static_cast<int>(pRegions.size()); ++regionIdx)
+	{
+		const Triangle* pTriangle = pRegions[regionIdx]->GetNavMeshPolygon()->GetTriangleFromPosition(position);
+		if (pTriangle)
+			return pTriangle;
+	}
+
+	return nullptr;
+}
+
+int TiledNavGraph::Snapshot::GetTileIdx(int nodeIdx) const
+{
+	//Empty tiles share their first node with the next tile, upper_bound skips them
+	return static_cast<int>(std::upper_bound(m_TileFirstNodes.begin(), m_TileFirstNodes.end(), nodeIdx) - m_TileFirstNodes.begin()) - 1;
+}
+
+int TiledNavGraph::Snapshot::GetNeighbourTileIdx(int tileIdx, int side) const
+{
+	int column = tileIdx % m_NrOfColumns;
+	int row = tileIdx / m_NrOfColumns;
+	switch (side)
+	{
+	case Tile::Left: --column; break;
+	case Tile::Right: ++column; break;
+	case Tile::Bottom: --row; break;
+	case Tile::Top: ++row; break;
+	}
+
+	if (column < 0 || column >= m_NrOfColumns || row < 0 || row >= m_NrOfRows)
+		return -1;
+
+	return row * m_NrOfColumns + column;
+}
+
+//--- TiledNavGraph ---
+TiledNavGraph::TiledNavGraph(const Vector2& worldMin, const Vector2& worldMax, float tileSize, float playerRadius)
+	: m_WorldMin(worldMin)
+	, m_NrOfColumns(std::max(1, static_cast<int>(ceilf((worldMax.x - worldMin.x) / tileSize))))
+	, m_NrOfRows(std::max(1, static_cast<int>(ceilf((worldMax.y - worldMin.y) / tileSize))))
+	, m_TileSize(tileSize)
+	, m_PlayerRadius(playerRadius)
+{
+	const int nrOfTiles = m_NrOfColumns * m_NrOfRows;
+	m_TileObstacles.resize(nrOfTiles);
+	m_pTiles.resize(nrOfTiles);
+
+	//Every tile is built on the first rebuild
+	for (int tileIdx = 0; tileIdx < nrOfTiles; ++tileIdx)
+		m_DirtyTiles.push_back(tileIdx);
+}
+
+int TiledNavGraph::AddObstacle(const Polygon& shape)
+{
+	const std::vector<Vector2> points = ExpandObstacle(shape);
+
+	//Overlapping obstacles are merged when the tiles are built, only shapes outside the world are refused
+	Vector2 boundsMin, boundsMax;
+	GetBounds(points, boundsMin, boundsMax);
+	const Vector2 worldMax = GetTileMin(m_NrOfColumns, m_NrOfRows);
+	if (points.size() < 3 || boundsMax.x <= m_WorldMin.x || boundsMax.y <= m_WorldMin.y || boundsMin.x >= worldMax.x || boundsMin.y >= worldMax.y)
+		return invalid_obstacle_id;
+
+	const int obstacleId = m_NextObstacleId++;
+	m_Obstacles[obstacleId] = points;
+	MarkTilesDirty(points, obstacleId, true);
+
+	return obstacleId;
+}
+
+void TiledNavGraph::RemoveObstacle(int obstacleId)
+{
+	const auto it = m_Obstacles.find(obstacleId);
+	if (it == m_Obstacles.end())
+		return;
+
+	MarkTilesDirty(it->second, obstacleId, false);
+	m_Obstacles.erase(it);
+}
+
+std::vector<std::shared_ptr<const TiledNavGraph::Tile>> TiledNavGraph::RebuildDirtyTiles()
+{
+	//The tiles in use are never changed, the rebuilt tiles replace them in a new snapshot
+	std::vector<std::shared_ptr<const Tile>> pRebuiltTiles{};
+	for (int tileIdx : m_DirtyTiles)
+	{
+		m_pTiles[tileIdx] = BuildTile(tileIdx % m_NrOfColumns, tileIdx / m_NrOfColumns);
+		pRebuiltTiles.push_back(m_pTiles[tileIdx]);
+	}
+	m_DirtyTiles.clear();
+
+	const auto pSnapshot = std::make_shared<const Snapshot>(m_pTiles, m_NrOfColumns, m_NrOfRows, m_WorldMin, m_TileSize);
+	{
+		std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+		m_pSnapshot = pSnapshot;
+	}
+
+	return pRebuiltTiles;
+}
+
+std::shared_ptr<const TiledNavGraph::Snapshot> TiledNavGraph::GetSnapshot() const
+{
+	std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+	return m_pSnapshot;
+}
+
+std::vector<Vector2> TiledNavGraph::ExpandObstacle(const Polygon& shape) const
+{
+	Polygon expandedShape{ shape };
+	expandedShape.ExpandShape(m_PlayerRadius);
+
+	std::vector<Vector2> points{ expandedShape.GetPoints().begin(), expandedShape.GetPoints().end() };
+	if (GetPolygonWinding(points) == CW)
+		std::reverse(points.begin(), points.end());
+
+	return points;
+}
+
+Vector2 TiledNavGraph::GetTileMin(int column, int row) const
+{
+	//Neighbouring tiles compute their shared border the same way, so they agree on it to the bit
+	return Vector2(m_WorldMin.x + column * m_TileSize, m_WorldMin.y + row * m_TileSize);
+}
+
+void TiledNavGraph::GetTileRange(const std::vector<Vector2>& shape, int& minColumn, int& minRow, int& maxColumn, int& maxRow) const
+{
+	Vector2 boundsMin, boundsMax;
+	GetBounds(shape, boundsMin, boundsMax);
+
+	minColumn = Clamp(static_cast<int>(floorf((boundsMin.x - m_WorldMin.x) / m_TileSize)), 0, m_NrOfColumns - 1);
+	maxColumn = Clamp(static_cast<int>(floorf((boundsMax.x - m_WorldMin.x) / m_TileSize)), 0, m_NrOfColumns - 1);
+	minRow = Clamp(static_cast<int>(floorf((boundsMin.y - m_WorldMin.y) / m_TileSize)), 0, m_NrOfRows - 1);
+	maxRow = Clamp(static_cast<int>(floorf((boundsMax.y - m_WorldMin.y) / m_TileSize)), 0, m_NrOfRows - 1);
+}
+
+void TiledNavGraph::MarkTilesDirty(const std::vector<Vector2>& shape, int obstacleId, bool isAdded)
+{
+	int minColumn, minRow, maxColumn, maxRow;
+	GetTileRange(shape, minColumn, minRow, maxColumn, maxRow);
+
+	for (int row = minRow; row <= maxRow; ++row)
+	{
+		for (int column = minColumn; column <= maxColumn; ++column)
+		{
+			const int tileIdx = row * m_NrOfColumns + column;
+			std::vector<int>& obstacles = m_TileObstacles[tileIdx];
+			if (isAdded)
+				obstacles.push_back(obstacleId);
+			else
+				obstacles.erase(std::remove(obstacles.begin(), obstacles.end(), obstacleId), obstacles.end());
+
+			if (std::find(m_DirtyTiles.begin(), m_DirtyTiles.end(), tileIdx) == m_DirtyTiles.end())
+				m_DirtyTiles.push_back(tileIdx);
+		}
+	}
+}
+
+std::shared_ptr<const TiledNavGraph::Tile> TiledNavGraph::BuildTile(int column, int row) const
+{
+	const auto buildStart = std::chrono::high_resolution_clock::now();
+
+	const Vector2 tileMin = GetTileMin(column, row);
+	const Vector2 tileMax = GetTileMin(column + 1, row + 1);
+
+	std::vector<std::vector<Vector2>> obstacles{};
+	for (int obstacleId : m_TileObstacles[row * m_NrOfColumns + column])
+	{
+		std::vector<Vector2> clippedObstacle = ClipToTile(m_Obstacles.at(obstacleId), tileMin, tileMax);
+		if (!clippedObstacle.empty())
+			obstacles.push_back(clippedObstacle);
+	}
+
+	const auto pTile = std::make_shared<Tile>(column, row, tileMin, tileMax, CreateRegions(MergeObstacles(obstacles, tileMin, tileMax), tileMin, tileMax));
+
+	const auto buildEnd = std::chrono::high_resolution_clock::now();
+	pTile->m_BuildTime = std::chrono::duration<float, std::milli>(buildEnd - buildStart).count();
+
+	return pTile;
+}
+
+void TiledNavGraph::GetBounds(const std::vector<Vector2>& shape, Vector2& boundsMin, Vector2& boundsMax)
+{
+	boundsMin = Vector2(FLT_MAX, FLT_MAX);
+	boundsMax = Vector2(-FLT_MAX, -FLT_MAX);
+	for (const Vector2& point : shape)
+	{
+		boundsMin = Vector2(std::min(boundsMin.x, point.x), std::min(boundsMin.y, point.y));
+		boundsMax = Vector2(std::max(boundsMax.x, point.x), std::max(boundsMax.y, point.y));
+	}
+}
+
+std::vector<Vector2> TiledNavGraph::ClipToTile(const std::vector<Vector2>& shape, const Vector2& tileMin, const Vector2& tileMax)
+{
+	//The shape is convex and wound CCW. Its clipped outline consists of the vertices inside the tile, the tile corners
+	//inside the shape and the points where the edges of the shape cross the tile sides
+	std::vector<Vector2> points{};
+	for (const Vector2& point : shape)
+	{
+		if (point.x >= tileMin.x && point.x <= tileMax.x && point.y >= tileMin.y && point.y <= tileMax.y)
+			points.push_back(point);
+	}
+
+	const Vector2 corners[4] = { tileMin, Vector2(tileMax.x, tileMin.y), tileMax, Vector2(tileMin.x, tileMax.y) };
+	for (const Vector2& corner : corners)
+	{
+		bool isInside = true;
+		for (size_t i = 0; i < shape.size() && isInside; ++i)
+			isInside = Cross(shape[(i + 1) % shape.size()] - shape[i], corner - shape[i]) > 0.f;
+		if (isInside)
+			points.push_back(corner);
+	}
+
+	for (size_t i = 0; i < shape.size(); ++i)
+	{
+		//Order the edge endpoints, so the tiles on both sides of a border calculate the same crossing
+		Vector2 p1 = shape[i];
+		Vector2 p2 = shape[(i + 1) % shape.size()];
+
+		if (p2.x < p1.x)
+			std::swap(p1, p2);
+		for (float x : { tileMin.x, tileMax.x })
+		{
+			if (p1.x < x && x < p2.x)
+			{
+				const float y = p1.y + (x - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+				if (y >= tileMin.y && y <= tileMax.y)
+					points.push_back(Vector2(x, y));
+			}
+		}
+
+		if (p2.y < p1.y)
+			std::swap(p1, p2);
+		for (float y : { tileMin.y, tileMax.y })
+		{
+			if (p1.y < y && y < p2.y)
+			{
+				const float x = p1.x + (y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
+				if (x >= tileMin.x && x <= tileMax.x)
+					points.push_back(Vector2(x, y));
+			}
+		}
+	}
+
+	if (points.size() < 3)
+		return {};
+
+	//All points lie on the convex outline, sort them around its centre
+	Vector2 centre{};
+	for (const Vector2& point : points)
+		centre += point;
+	centre /= static_cast<float>(points.size());
+
+	std::sort(points.begin(), points.end(), [&centre](const Vector2& a, const Vector2& b)
+		{
+			return atan2f(a.y - centre.y, a.x - centre.x) < atan2f(b.y - centre.y, b.x - centre.x);
+		});
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	//Shapes that only touch the tile have no area inside it
+	float doubleArea = 0.f;
+	for (size_t i = 0; i < points.size(); ++i)
+		doubleArea += Cross(points[i], points[(i + 1) % points.size()]);
+	if (points.size() < 3 || doubleArea <= FLT_EPSILON)
+		return {};
+
+	return points;
+}
+
+std::vector<std::pair<Vector2, Vector2>> TiledNavGraph::MergeObstacles(const std::vector<std::vector<Vector2>>& obstacles, const Vector2& tileMin, const Vector2& tileMax)
+{
+	//Every edge is cut where the outline of another obstacle crosses or touches it. Pieces inside another obstacle are dropped,
+	//of two pieces on the same line one is kept when they point the same way and none when the obstacles meet there
+	struct Edge
+	{
+		int obstacleIdx;
+		Vector2 p1;
+		Vector2 p2;
+		std::vector<Vector2> cuts;
+	};
+
+	std::vector<std::pair<Vector2, Vector2>> mergedEdges{};
+	std::vector<Edge> edges{};
+	for (size_t obstacleIdx = 0; obstacleIdx < obstacles.size(); ++obstacleIdx)
+	{
+		const std::vector<Vector2>& obstacle = obstacles[obstacleIdx];
+		for (size_t i = 0; i < obstacle.size(); ++i)
+		{
+			const Vector2& p1 = obstacle[i];
+			const Vector2& p2 = obstacle[(i + 1) % obstacle.size()];
+
+			//The covered parts of the border are merged by CreateRegions
+			if (obstacles.size() == 1 || GetTileSide(p1, p2, tileMin, tileMax) != -1)
+				mergedEdges.push_back(std::make_pair(p1, p2));
+			else
+				edges.push_back(Edge{ static_cast<int>(obstacleIdx), p1, p2, {} });
+		}
+	}
+
+	//Crossings are calculated once per pair of edges, so both are cut in the same point
+	for (size_t a = 0; a < edges.size(); ++a)
+	{
+		const Vector2 directionA = edges[a].p2 - edges[a].p1;
+		for (size_t b = a + 1; b < edges.size(); ++b)
+		{
+			if (edges[a].obstacleIdx == edges[b].obstacleIdx)
+				continue;
+
+			const Vector2 directionB = edges[b].p2 - edges[b].p1;
+			const float denominator = Cross(directionA, directionB);
+			if (denominator == 0.f)
+				continue;
+
+			const float t = Cross(edges[b].p1 - edges[a].p1, directionB) / denominator;
+			const float u = Cross(edges[b].p1 - edges[a].p1, directionA) / denominator;
+			if (t > CUT_EPSILON && t < 1.f - CUT_EPSILON && u > CUT_EPSILON && u < 1.f - CUT_EPSILON)
+			{
+				const Vector2 crossing = edges[a].p1 + directionA * t;
+				edges[a].cuts.push_back(crossing);
+				edges[b].cuts.push_back(crossing);
+			}
+		}
+
+		//Corners of other obstacles on the edge, crossings that close to a corner were skipped above
+		const float length = directionA.Magnitude();
+		for (size_t obstacleIdx = 0; obstacleIdx < obstacles.size(); ++obstacleIdx)
+		{
+			if (static_cast<int>(obstacleIdx) == edges[a].obstacleIdx)
+				continue;
+
+			for (const Vector2& corner : obstacles[obstacleIdx])
+			{
+				const float t = Dot(corner - edges[a].p1, directionA) / (length * length);
+				if (t > CUT_EPSILON && t < 1.f - CUT_EPSILON && fabsf(Cross(directionA, corner - edges[a].p1)) <= ON_OUTLINE_EPSILON * length)
+					edges[a].cuts.push_back(corner);
+			}
+		}
+	}
+
+	const auto isOnMergedOutline = [&obstacles](const Vector2& from, const Vector2& to, int obstacleIdx)
+	{
+		const Vector2 middle = (from + to) * 0.5f;
+		for (size_t otherIdx = 0; otherIdx < obstacles.size(); ++otherIdx)
+		{
+			if (static_cast<int>(otherIdx) == obstacleIdx)
+				continue;
+
+			//Distance to the closest edge of the (convex, CCW) other obstacle, positive inside it
+			const std::vector<Vector2>& other = obstacles[otherIdx];
+			float distance = FLT_MAX;
+			Vector2 closestEdge{};
+			for (size_t i = 0; i < other.size(); ++i)
+			{
+				const Vector2 edge = other[(i + 1) % other.size()] - other[i];
+				const float edgeDistance = Cross(edge, middle - other[i]) / edge.Magnitude();
+				if (edgeDistance < distance)
+				{
+					distance = edgeDistance;
+					closestEdge = edge;
+				}
+			}
+
+			if (distance > ON_OUTLINE_EPSILON)
+				return false;
+			if (distance >= -ON_OUTLINE_EPSILON && (Dot(to - from, closestEdge) < 0.f || static_cast<int>(otherIdx) < obstacleIdx))
+				return false;
+		}
+
+		return true;
+	};
+
+	for (Edge& edge : edges)
+	{
+		const Vector2 direction = edge.p2 - edge.p1;
+		std::sort(edge.cuts.begin(), edge.cuts.end(), [&edge, &direction](const Vector2& a, const Vector2& b)
+			{
+				return Dot(a - edge.p1, direction) < Dot(b - edge.p1, direction);
+			});
+		edge.cuts.push_back(edge.p2);
+
+		Vector2 from = edge.p1;
+		for (const Vector2& to : edge.cuts)
+		{
+			if (to == from)
+				continue;
+
+			if (isOnMergedOutline(from, to, edge.obstacleIdx))
+				mergedEdges.push_back(std::make_pair(from, to));
+			from = to;
+		}
+	}
+
+	return mergedEdges;
+}
+
+std::vector<Polygon> TiledNavGraph::CreateRegions(const std::vector<std::pair<Vector2, Vector2>>& obstacleEdges, const Vector2& tileMin, const Vector2& tileMax)
+{
+	//Obstacle edges on the border cover parts of it. The free parts of the border together with the other obstacle edges
+	//(reversed, the free space is on the outside) form the outlines of the regions and of the holes in them
+	std::vector<std::vector<Vector2>> holes{};
+	std::vector<std::pair<Vector2, Vector2>> edges{};
+	std::vector<std::pair<float, float>> coveredParts[Tile::NrOfSides];
+
+	for (const auto& obstacleEdge : obstacleEdges)
+	{
+		const Vector2& p1 = obstacleEdge.first;
+		const Vector2& p2 = obstacleEdge.second;
+
+		const int side = GetTileSide(p1, p2, tileMin, tileMax);
+		if (side == -1)
+			edges.push_back(std::make_pair(p2, p1));
+		else if (side == Tile::Left || side == Tile::Right)
+			coveredParts[side].push_back(std::make_pair(std::min(p1.y, p2.y), std::max(p1.y, p2.y)));
+		else
+			coveredParts[side].push_back(std::make_pair(std::min(p1.x, p2.x), std::max(p1.x, p2.x)));
+	}
+
+	//Free parts of the border, walked CCW: bottom and right towards increasing coordinates, top and left towards decreasing ones
+	for (int side = 0; side < Tile::NrOfSides; ++side)
+	{
+		const bool isVertical = side == Tile::Left || side == Tile::Right;
+		const auto getPoint = [&](float coordinate)
+		{
+			switch (side)
+			{
+			case Tile::Left: return Vector2(tileMin.x, coordinate);
+			case Tile::Right: return Vector2(tileMax.x, coordinate);
+			case Tile::Bottom: return Vector2(coordinate, tileMin.y);
+			default: return Vector2(coordinate, tileMax.y);
+			}
+		};
+		const auto addFreePart = [&](float from, float to)
+		{
+			if (side == Tile::Bottom || side == Tile::Right)
+				edges.push_back(std::make_pair(getPoint(from), getPoint(to)));
+			else
+				edges.push_back(std::make_pair(getPoint(to), getPoint(from)));
+		};
+
+		std::sort(coveredParts[side].begin(), coveredParts[side].end());
+
+		float from = isVertical ? tileMin.y : tileMin.x;
+		for (const auto& coveredPart : coveredParts[side])
+		{
+			if (coveredPart.first > from)
+				addFreePart(from, coveredPart.first);
+			from = std::max(from, coveredPart.second);
+		}
+
+		const float sideEnd = isVertical ? tileMax.y : tileMax.x;
+		if (sideEnd > from)
+			addFreePart(from, sideEnd);
+	}
+
+	//Link the edges into loops, every point starts exactly one edge
+	std::map<std::pair<float, float>, int> edgeStarts{};
+	for (size_t i = 0; i < edges.size(); ++i)
+		edgeStarts[std::make_pair(edges[i].first.x, edges[i].first.y)] = static_cast<int>(i);
+
+	std::vector<std::vector<Vector2>> outlines{};
+	std::vector<bool> isEdgeUsed(edges.size(), false);
+	for (size_t i = 0; i < edges.size(); ++i)
+	{
+		if (isEdgeUsed[i])
+			continue;
+
+		std::vector<Vector2> loop{};
+		int edgeIdx = static_cast<int>(i);
+		while (edgeIdx != -1 && !isEdgeUsed[edgeIdx])
+		{
+			isEdgeUsed[edgeIdx] = true;
+			loop.push_back(edges[edgeIdx].first);
+
+			const auto next = edgeStarts.find(std::make_pair(edges[edgeIdx].second.x, edges[edgeIdx].second.y));
+			edgeIdx = next != edgeStarts.end() ? next->second : -1;
+		}
+
+		if (edgeIdx != static_cast<int>(i))
+		{
+			std::cout << "TiledNavGraph::CreateRegions: outline of the free space isn't closed, it is ignored\n";
+			continue;
+		}
+
+		//Obstacles inside the tile, or that touch the border in a single point, form a CW loop of their own
+		if (GetPolygonWinding(loop) == CCW)
+			outlines.push_back(loop);
+		else
+			holes.push_back(loop);
+	}
+
+	//Obstacles around free space give outlines inside the holes of other ones, so a hole belongs to the smallest outline around it
+	std::vector<float> outlineAreas{};
+	for (const std::vector<Vector2>& outline : outlines)
+	{
+		float doubleArea = 0.f;
+		for (size_t i = 0; i < outline.size(); ++i)
+			doubleArea += Cross(outline[i], outline[(i + 1) % outline.size()]);
+		outlineAreas.push_back(doubleArea);
+	}
+
+	std::vector<std::vector<std::vector<Vector2>>> outlineHoles(outlines.size());
+	for (const std::vector<Vector2>& hole : holes)
+	{
+		//Merged holes aren't convex, but the obstacle is right next to the middle of an edge (on its right, the hole is CW)
+		const Vector2 direction = hole[1] - hole[0];
+		const Vector2 point = (hole[0] + hole[1]) * 0.5f + Vector2(direction.y, -direction.x) * 1e-3f;
+
+		int outlineIdx = -1;
+		for (size_t i = 0; i < outlines.size(); ++i)
+		{
+			if (IsPointInLoop(point, outlines[i]) && (outlineIdx == -1 || outlineAreas[i] < outlineAreas[outlineIdx]))
+				outlineIdx = static_cast<int>(i);
+		}
+
+		if (outlineIdx != -1)
+			outlineHoles[outlineIdx].push_back(hole);
+	}
+
+	std::vector<Polygon> regions{};
+	for (size_t i = 0; i < outlines.size(); ++i)
+		regions.push_back(Polygon(outlines[i], outlineHoles[i]));
+
+	return regions;
+}
+
+bool TiledNavGraph::IsPointInLoop(const Vector2& point, const std::vector<Vector2>& loop)
+{
+	//Even-odd rule: count the edges a ray to +x crosses
+	bool isInside = false;
+	for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++)
+	{
+		const Vector2& p1 = loop[i];
+		const Vector2& p2 = loop[j];
+		if ((p1.y > point.y) != (p2.y > point.y)
+			&& point.x < p1.x + (point.y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y))
+			isInside = !isInside;
+	}
+	return isInside;
+}
+
+//--- TiledNavGraphQuery ---
+TiledNavGraphQuery::TiledNavGraphQuery(const TiledNavGraph::Snapshot& snapshot, const Vector2& startPos, const Vector2& goalPos)
+	: m_Snapshot(snapshot)
+	, m_StartPos(startPos)
+	, m_GoalPos(goalPos)
+{
+	int regionIdx = 0;
+	m_pStartTriangle = m_Snapshot.GetTriangleFromPosition(startPos, m_StartTile, regionIdx);
+	if (m_pStartTriangle)
+		GetTriangleNodes(m_pStartTriangle, m_StartTile, regionIdx, m_StartNodes);
+
+	m_pGoalTriangle = m_Snapshot.GetTriangleFromPosition(goalPos, m_GoalTile, regionIdx);
+	if (m_pGoalTriangle)
+		GetTriangleNodes(m_pGoalTriangle, m_GoalTile, regionIdx, m_GoalNodes);
+}
+
+Vector2 TiledNavGraphQuery::GetNodePos(int nodeIdx) const
+{
+	if (nodeIdx == GetStartIdx())
+		return m_StartPos;
+	if (nodeIdx == GetGoalIdx())
+		return m_GoalPos;
+
+	return m_Snapshot.GetNodePos(nodeIdx);
+}
+
+const std::vector<GraphEdge>& TiledNavGraphQuery::GetNeighbors(int nodeIdx) const
+{
+	m_Connections.clear();
+
+	//The start only has outgoing connections, the goal only incoming ones
+	if (nodeIdx == GetStartIdx())
+	{
+		for (int startNode : m_StartNodes)
+			m_Connections.push_back(GraphEdge{ nodeIdx, startNode, Distance(m_StartPos, m_Snapshot.GetNodePos(startNode)) });
+		return m_Connections;
+	}
+
+	if (nodeIdx == GetGoalIdx())
+		return m_Connections;
+
+	m_Snapshot.GetConnections(nodeIdx, m_Connections);
+	if (std::find(m_GoalNodes.begin(), m_GoalNodes.end(), nodeIdx) != m_GoalNodes.end())
+		m_Connections.push_back(GraphEdge{ nodeIdx, GetGoalIdx(), Distance(m_Snapshot.GetNodePos(nodeIdx), m_GoalPos) });
+
+	return m_Connections;
+}
+
+void TiledNavGraphQuery::GetTriangleNodes(const Triangle* pTriangle, int tileIdx, int regionIdx, std::vector<int>& nodes) const
+{
+	const NavGraph* pRegion = m_Snapshot.GetTiles()[tileIdx]->GetRegions()[regionIdx];
+	for (int lineIdx : pTriangle->metaData.IndexLines)
+	{
+		const int regionNodeIdx = pRegion->GetNodeIdxFromLineIdx(lineIdx);
+		if (regionNodeIdx != invalid_node_index)
+			nodes.push_back(m_Snapshot.GetNodeIdx(tileIdx, regionIdx, regionNodeIdx));
+	}
+}
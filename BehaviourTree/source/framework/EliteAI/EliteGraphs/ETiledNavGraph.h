@@ -0,0 +1,191 @@
+/*=============================================================================*/
+// ETiledNavGraph.h: Navigation mesh split in fixed size tiles that are triangulated independently.
+// Adding or removing an obstacle only rebuilds the tiles it touches, obstacles that overlap are merged per tile.
+// Built tiles never change, the rebuilt tiles are published in a new snapshot while queries keep using the snapshot they hold.
+// Neighbouring tiles are stitched during queries, by matching the nodes on their shared border.
+/*=============================================================================*/
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "framework/EliteAI/EliteGraphs/ENavGraph.h"
+
+namespace Elite
+{
+	class TiledNavGraph final
+	{
+	public:
+		// Free space of one tile, split in regions that are separated by obstacles. Every region has its own NavGraph,
+		// the nodes of the tile are numbered region after region
+		class Tile final
+		{
+		public:
+			enum Side { Left = 0, Bottom = 1, Right = 2, Top = 3, NrOfSides = 4 };
+
+			// Node on a line of the tile border, from and to are the coordinates of the line along the side
+			struct BorderNode
+			{
+				float from;
+				float to;
+				int tileNodeIdx;
+			};
+
+			Tile(int column, int row, const Vector2& tileMin, const Vector2& tileMax, const std::vector<Polygon>& regions);
+			~Tile();
+
+			int GetColumn() const { return m_Column; }
+			int GetRow() const { return m_Row; }
+			const Vector2& GetMin() const { return m_Min; }
+			const Vector2& GetMax() const { return m_Max; }
+			const std::vector<NavGraph*>& GetRegions() const { return m_pRegions; }
+			int GetNrOfNodes() const { return m_NrOfNodes; }
+			float GetBuildTime() const { return m_BuildTime; } // in milliseconds
+
+			// Region of a tile node, tileNodeIdx becomes the node index in that region
+			int GetRegion(int& tileNodeIdx) const;
+			int GetFirstNode(int regionIdx) const { return m_RegionFirstNodes[regionIdx]; }
+			// Side of the tile border the node is on, -1 for nodes inside the tile
+			int GetSide(int tileNodeIdx) const { return m_NodeSides[tileNodeIdx]; }
+			const std::vector<BorderNode>& GetBorderNodes(int side) const { return m_BorderNodes[side]; }
+
+		private:
+			friend class TiledNavGraph;
+
+			int m_Column;
+			int m_Row;
+			Vector2 m_Min;
+			Vector2 m_Max;
+			std::vector<NavGraph*> m_pRegions{};
+			std::vector<int> m_RegionFirstNodes{};
+			int m_NrOfNodes = 0;
+			std::vector<int> m_NodeSides{}; // per tile node, -1 when it isn't on the border
+			std::vector<BorderNode> m_BorderNodes[NrOfSides]; // sorted on from
+			float m_BuildTime = 0.f;
+
+			Tile(const Tile& other) = delete;
+			Tile& operator=(const Tile& other) = delete;
+		};
+
+		// The tiles a query works on. Node indices are global: the index of the node in its tile plus the offset of the tile
+		class Snapshot final
+		{
+		public:
+			Snapshot(const std::vector<std::shared_ptr<const Tile>>& pTiles, int nrOfColumns, int nrOfRows, const Vector2& worldMin, float tileSize);
+
+			const std::vector<std::shared_ptr<const Tile>>& GetTiles() const { return m_pTiles; }
+			int GetNrOfNodes() const { return m_NrOfNodes; }
+			Vector2 GetNodePos(int nodeIdx) const;
+			const Line& GetNodeLine(int nodeIdx) const;
+			int GetNodeIdx(int tileIdx, int regionIdx, int regionNodeIdx) const;
+
+			// Connections of the node inside its region and to the nodes of the neighbouring tile that share its border line
+			void GetConnections(int nodeIdx, std::vector<GraphEdge>& connections) const;
+			// Triangle the position is in, tileIdx and regionIdx tell whose mesh it belongs to
+			const Triangle* GetTriangleFromPosition(const Vector2& position, int& tileIdx, int& regionIdx) const;
+
+		private:
+			std::vector<std::shared_ptr<const Tile>> m_pTiles;
+			std::vector<int> m_TileFirstNodes{};
+			int m_NrOfColumns;
+			int m_NrOfRows;
+			Vector2 m_WorldMin;
+			float m_TileSize;
+			int m_NrOfNodes = 0;
+
+			int GetTileIdx(int nodeIdx) const;
+			int GetNeighbourTileIdx(int tileIdx, int side) const;
+		};
+
+		TiledNavGraph(const Vector2& worldMin, const Vector2& worldMax, float tileSize, float playerRadius);
+		~TiledNavGraph() = default;
+
+		// Obstacles are added, removed and rebuilt from one thread, the tiles only exist after the first rebuild.
+		// The shape (wound CW, like the static shapes of the physics world) is expanded by the player radius.
+		// Returns the id to remove the obstacle with, or invalid_obstacle_id when the shape has no area inside the world
+		[[nodiscard]] int AddObstacle(const Polygon& shape);
+		void RemoveObstacle(int obstacleId);
+
+		// Rebuilds the tiles touched by the obstacles added or removed since the last rebuild and publishes them in
+		// a new snapshot. Returns the rebuilt tiles, they know how long their build took
+		std::vector<std::shared_ptr<const Tile>> RebuildDirtyTiles();
+		bool HasDirtyTiles() const { return !m_DirtyTiles.empty(); }
+
+		// Can be called from any thread, also during a rebuild
+		std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+		// The tiles cover the world from its min corner, the last column and row can reach past its max corner
+		const Vector2& GetWorldMin() const { return m_WorldMin; }
+		int GetNrOfColumns() const { return m_NrOfColumns; }
+		int GetNrOfRows() const { return m_NrOfRows; }
+		float GetTileSize() const { return m_TileSize; }
+
+		static const int invalid_obstacle_id = -1;
+
+	private:
+		//--- Datamembers ---
+		Vector2 m_WorldMin;
+		int m_NrOfColumns;
+		int m_NrOfRows;
+		float m_TileSize;
+		float m_PlayerRadius;
+
+		int m_NextObstacleId = 0;
+		std::unordered_map<int, std::vector<Vector2>> m_Obstacles{}; // expanded and wound CCW
+		std::vector<std::vector<int>> m_TileObstacles{}; // per tile the obstacles whose bounds overlap it
+		std::vector<int> m_DirtyTiles{};
+		std::vector<std::shared_ptr<const Tile>> m_pTiles{};
+
+		mutable std::mutex m_SnapshotMutex;
+		std::shared_ptr<const Snapshot> m_pSnapshot = nullptr;
+
+		std::vector<Vector2> ExpandObstacle(const Polygon& shape) const;
+		Vector2 GetTileMin(int column, int row) const;
+		void GetTileRange(const std::vector<Vector2>& shape, int& minColumn, int& minRow, int& maxColumn, int& maxRow) const;
+		void MarkTilesDirty(const std::vector<Vector2>& shape, int obstacleId, bool isAdded);
+		std::shared_ptr<const Tile> BuildTile(int column, int row) const;
+
+		static void GetBounds(const std::vector<Vector2>& shape, Vector2& boundsMin, Vector2& boundsMax);
+		static std::vector<Vector2> ClipToTile(const std::vector<Vector2>& shape, const Vector2& tileMin, const Vector2& tileMax);
+		// Edges of the outline of the obstacles together, wound CCW around them. Edges on the tile border aren't merged
+		static std::vector<std::pair<Vector2, Vector2>> MergeObstacles(const std::vector<std::vector<Vector2>>& obstacles, const Vector2& tileMin, const Vector2& tileMax);
+		static std::vector<Polygon> CreateRegions(const std::vector<std::pair<Vector2, Vector2>>& obstacleEdges, const Vector2& tileMin, const Vector2& tileMax);
+		static bool IsPointInLoop(const Vector2& point, const std::vector<Vector2>& loop);
+
+		TiledNavGraph(const TiledNavGraph& other) = delete;
+		TiledNavGraph& operator=(const TiledNavGraph& other) = delete;
+	};
+
+	// View of a snapshot with a start and goal node on top, these get the indices after the last tile node.
+	// Connections are gathered in a buffer of the view, so use one view per query (and thread)
+	class TiledNavGraphQuery final
+	{
+	public:
+		TiledNavGraphQuery(const TiledNavGraph::Snapshot& snapshot, const Vector2& startPos, const Vector2& goalPos);
+
+		// False when the start or goal isn't on the navigation mesh
+		bool IsValid() const { return m_pStartTriangle && m_pGoalTriangle; }
+		bool IsInSameTriangle() const { return m_pStartTriangle == m_pGoalTriangle && m_StartTile == m_GoalTile; }
+		int GetStartIdx() const { return m_Snapshot.GetNrOfNodes(); }
+		int GetGoalIdx() const { return m_Snapshot.GetNrOfNodes() + 1; }
+
+		int GetNrOfNodes() const { return m_Snapshot.GetNrOfNodes() + 2; }
+		Vector2 GetNodePos(int nodeIdx) const;
+		const std::vector<GraphEdge>& GetNeighbors(int nodeIdx) const;
+
+	private:
+		const TiledNavGraph::Snapshot& m_Snapshot;
+		Vector2 m_StartPos;
+		Vector2 m_GoalPos;
+		const Triangle* m_pStartTriangle = nullptr;
+		const Triangle* m_pGoalTriangle = nullptr;
+		int m_StartTile = -1;
+		int m_GoalTile = -1;
+		std::vector<int> m_StartNodes{}; // nodes on the lines of the start triangle
+		std::vector<int> m_GoalNodes{};
+		mutable std::vector<GraphEdge> m_Connections{};
+
+		void GetTriangleNodes(const Triangle* pTriangle, int tileIdx, int regionIdx, std::vector<int>& nodes) const;
+	};
+}
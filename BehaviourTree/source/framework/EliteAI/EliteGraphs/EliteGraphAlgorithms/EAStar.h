@@ -1,26 +1,83 @@
 #pragma once
 #include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ELandmarks.h"
 
 namespace Elite
 {
 	template <class T_NodeType, class T_ConnectionType>
+	class AStarContext;
+
+	// The graph type only needs GetNrOfNodes(), GetNeighbors(idx) (a range of GraphEdge) and GetNodePos(idx),
+	// plus GetNode(idx) for the overloads working with nodes: an IGraph, a baked CSRGraph, a GraphOverlay, an ImplicitGridGraph
+	// or a TiledNavGraphQuery. Nodes are looked up by index, so nodes of a mutable graph can be used to search its baked snapshot
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType = IGraph<T_NodeType, T_ConnectionType>>
 	class AStar
 	{
 	public:
-		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		AStar(T_GraphType* pGraph, Heuristic hFunction);
+
+		using NodeRecord = typename AStarContext<T_NodeType, T_ConnectionType>::NodeRecord;
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// Reuses the records and open list of the context and writes into the given path,
+		// so repeated queries on the same graph don't allocate once both have grown to size.
+		// Returns false (and an empty path) when the destination can't be reached
+		bool FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<T_NodeType*>& path);
+		// Same, but with node indices, graphs without node objects (implicit grids, tiled meshes) only support this one
+		bool FindPath(int startIdx, int destinationIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<int>& path);
+
+		// Amount of nodes that were expanded (moved to the closed list) during the last search
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
 
+		// The heuristic becomes the largest of the heuristic function and the landmark lower bound (nullptr to turn it off).
+		// The landmarks have to be built for the graph that is searched, for overlays pass the ones of the overlay
+		void SetLandmarks(const Landmarks* pLandmarks) { m_pLandmarks = pLandmarks; }
+
+		// Connections the filter returns false for are skipped, e.g. the ones too narrow for the agent (nullptr to use all of them).
+		// Skipping connections only makes paths longer, so the heuristic and landmarks stay admissible
+		using ConnectionFilter = std::function<bool(const GraphEdge&)>;
+		void SetConnectionFilter(const ConnectionFilter& filter) { m_ConnectionFilter = filter; }
+
+	private:
+		// Leaves the records of the search in the context, the path can be traced back from the goal
+		bool Search(int startIdx, int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context);
+		void TracePath(int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<T_NodeType*>& path) const;
+		void TracePath(int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<int>& path) const;
+
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+		// Graphs with nodes that aren't in the landmark tables (overlays) give the lower bound themselves
+		template <class T_Graph>
+		auto GetLandmarkLowerBound(const T_Graph& graph, int fromIdx, int toIdx, int) const -> decltype(graph.GetLandmarkLowerBound(fromIdx, toIdx));
+		template <class T_Graph>
+		float GetLandmarkLowerBound(const T_Graph& graph, int fromIdx, int toIdx, long) const;
+
+		T_GraphType* m_pGraph = nullptr;
+		Heuristic m_HeuristicFunction;
+		const Landmarks* m_pLandmarks = nullptr;
+		ConnectionFilter m_ConnectionFilter = nullptr;
+		int m_NrOfExpandedNodes = 0;
+	};
+
+	// Search workspace that can be reused across AStar queries on the same graph.
+	// Records are tagged with the generation of the search that wrote them, so starting
+	// a new search is O(1) instead of clearing a record for every node
+	template <class T_NodeType, class T_ConnectionType>
+	class AStarContext final
+	{
+	public:
 		// stores the optimal connection to a node and its total costs related to the start and end node of the path
 		struct NodeRecord
 		{
-			T_NodeType* pNode = nullptr;
-			T_ConnectionType* pConnection = nullptr;
+			GraphEdge connection{}; // connection that leads to this node, from is invalid for the start node
 			float costSoFar = 0.f; // accumulated g-costs of all the connections leading up to this one
 			float estimatedTotalCost = 0.f; // f-cost (= costSoFar + h-cost)
 
 			bool operator==(const NodeRecord& other) const
 			{
-				return pNode == other.pNode
-					&& pConnection == other.pConnection
+				return connection.from == other.connection.from
+					&& connection.to == other.connection.to
 					&& costSoFar == other.costSoFar
 					&& estimatedTotalCost == other.estimatedTotalCost;
 			};
@@ -31,134 +88,243 @@ namespace Elite
 			};
 		};
 
-		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		AStarContext() = default;
+		explicit AStarContext(int nrOfNodes) { Reserve(nrOfNodes); }
+
+		// Grows the workspace up front, so the first searches don't allocate either
+		void Reserve(int nrOfNodes);
 
 	private:
-		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
+		template <class, class, class>
+		friend class AStar;
 
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
-		Heuristic m_HeuristicFunction;
+		enum class NodeState : char
+		{
+			Unvisited,
+			Open,
+			Closed
+		};
+
+		// Entry of the open list (binary min-heap). The record itself lives in the per-node record array,
+		// entries that no longer match their record are stale and skipped when popped (lazy deletion)
+		struct OpenListEntry
+		{
+			float estimatedTotalCost = 0.f;
+			unsigned int order = 0; // insertion order, first inserted wins on equal f-costs
+			int nodeIdx = invalid_node_index;
+
+			bool operator>(const OpenListEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return order > other.order;
+			};
+		};
+
+		struct SearchRecord
+		{
+			NodeRecord record{};
+			unsigned int generation = 0;
+			NodeState state = NodeState::Unvisited;
+		};
+
+		void BeginSearch(int nrOfNodes);
+
+		NodeState GetState(int idx) const { return m_Records[idx].generation == m_Generation ? m_Records[idx].state : NodeState::Unvisited; }
+		void SetState(int idx, NodeState state) { m_Records[idx].generation = m_Generation; m_Records[idx].state = state; }
+		NodeRecord& GetRecord(int idx) { return m_Records[idx].record; }
+
+		std::vector<SearchRecord> m_Records;
+		std::vector<OpenListEntry> m_OpenList;
+		unsigned int m_Generation = 0;
+		unsigned int m_InsertionOrder = 0;
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
-	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+	void AStarContext<T_NodeType, T_ConnectionType>::Reserve(int nrOfNodes)
+	{
+		if ((int)m_Records.size() < nrOfNodes)
+			m_Records.resize(nrOfNodes);
+
+		m_OpenList.reserve(nrOfNodes);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void AStarContext<T_NodeType, T_ConnectionType>::BeginSearch(int nrOfNodes)
+	{
+		// Nodes added since the last search start out unvisited (generation 0)
+		if ((int)m_Records.size() < nrOfNodes)
+			m_Records.resize(nrOfNodes);
+
+		m_OpenList.clear();
+		m_InsertionOrder = 0;
+
+		// On wrap around, old generations could match again, so wipe them once
+		if (++m_Generation == 0)
+		{
+			for (auto& searchRecord : m_Records)
+				searchRecord.generation = 0;
+			m_Generation = 1;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	AStar<T_NodeType, T_ConnectionType, T_GraphType>::AStar(T_GraphType* pGraph, Heuristic hFunction)
 		: m_pGraph(pGraph)
 		, m_HeuristicFunction(hFunction)
 	{
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
 	{
+		AStarContext<T_NodeType, T_ConnectionType> context{};
 		std::vector<T_NodeType*> finalPath;
-		std::vector<NodeRecord> openList;
-		std::vector<NodeRecord> closedList;
+		FindPath(pStartNode, pGoalNode, context, finalPath);
+		return finalPath;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	bool AStar<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<T_NodeType*>& path)
+	{
+		path.clear();
 
-		NodeRecord currentRecord;
-		currentRecord.pNode = pStartNode;
-		currentRecord.pConnection = nullptr;
-		currentRecord.costSoFar = 0.f;
-		currentRecord.estimatedTotalCost = GetHeuristicCost(pStartNode, pGoalNode);
-		openList.push_back(currentRecord);
+		if (!Search(pStartNode->GetIndex(), pGoalNode->GetIndex(), context))
+			return false;
 
+		TracePath(pGoalNode->GetIndex(), context, path);
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	bool AStar<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(int startIdx, int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<int>& path)
+	{
+		path.clear();
+
+		if (!Search(startIdx, goalIdx, context))
+			return false;
+
+		TracePath(goalIdx, context, path);
+		return true;
+	}
 
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	bool AStar<T_NodeType, T_ConnectionType, T_GraphType>::Search(int startIdx, int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context)
+	{
+		using NodeState = typename AStarContext<T_NodeType, T_ConnectionType>::NodeState;
+		using OpenListEntry = typename AStarContext<T_NodeType, T_ConnectionType>::OpenListEntry;
+
+		const T_GraphType& graph = *m_pGraph;
+		m_NrOfExpandedNodes = 0;
+
+		// One record per node index, so looking up the open/closed state of a neighbor is O(1)
+		context.BeginSearch(graph.GetNrOfNodes());
+		std::vector<OpenListEntry>& openList = context.m_OpenList;
+		const auto heapCompare = std::greater<OpenListEntry>();
+
+		NodeRecord& startRecord = context.GetRecord(startIdx);
+		startRecord.connection = GraphEdge{};
+		startRecord.costSoFar = 0.f;
+		startRecord.estimatedTotalCost = GetHeuristicCost(startIdx, goalIdx);
+		context.SetState(startIdx, NodeState::Open);
+		openList.push_back({ startRecord.estimatedTotalCost, context.m_InsertionOrder++, startIdx });
+
+		bool isGoalReached = false;
 		while (!openList.empty())
 		{
-			currentRecord = *std::min_element(openList.begin(), openList.end());
-			
-			if (currentRecord.pNode == pGoalNode)
-				break;
+			std::pop_heap(openList.begin(), openList.end(), heapCompare);
+			const OpenListEntry currentEntry = openList.back();
+			openList.pop_back();
 
-			for (auto& connection : m_pGraph->GetNodeConnections(currentRecord.pNode))
+			const NodeRecord& currentRecord = context.GetRecord(currentEntry.nodeIdx);
+
+			// Skip entries of nodes that got a cheaper record after this entry was pushed
+			if (context.GetState(currentEntry.nodeIdx) != NodeState::Open
+				|| currentEntry.estimatedTotalCost != currentRecord.estimatedTotalCost)
+				continue;
+
+			if (currentEntry.nodeIdx == goalIdx)
 			{
-				NodeRecord nextNode;
-				nextNode.pNode = m_pGraph->GetNode(connection->GetTo());
-				nextNode.costSoFar = currentRecord.costSoFar + connection->GetCost();
-				nextNode.estimatedTotalCost = nextNode.costSoFar + GetHeuristicCost(nextNode.pNode, pGoalNode);
-				nextNode.pConnection = connection;
-				
-				NodeRecord existingNode{};
-				
-				bool checkFailed = true;
-				bool shouldCompare = false;
-
-				for (auto& node : closedList)
-				{
-					if (nextNode.pNode == node.pNode)
-					{
-						checkFailed = false;
-						existingNode = node;
-						shouldCompare = true;
-						break;
-					}
-				}
-
-				if (checkFailed)
-				{
-					for (auto& node : openList) 
-					{
-						if (nextNode.pNode == node.pNode)
-						{
-							existingNode = node;
-							shouldCompare = true;
-							break;
-						}
-					}
-				}
-
-				if (shouldCompare)
-				{
-					if (existingNode.costSoFar <= nextNode.costSoFar)
-					{
-						continue;
-					}
-					else
-					{
-						if (checkFailed)
-						{
-							openList.erase(std::remove(openList.begin(), openList.end(), existingNode));
-						}
-						else
-						{
-							closedList.erase(std::remove(closedList.begin(), closedList.end(), existingNode));
-						}
-
-					}
-				}
-				openList.push_back(nextNode);		
+				isGoalReached = true;
+				break;
 			}
 
-			closedList.push_back(currentRecord);
-			openList.erase(std::remove(openList.begin(), openList.end(), currentRecord));
-			
+			context.SetState(currentEntry.nodeIdx, NodeState::Closed);
+			++m_NrOfExpandedNodes;
 
-		}
+			for (const GraphEdge& connection : graph.GetNeighbors(currentEntry.nodeIdx))
+			{
+				if (m_ConnectionFilter && !m_ConnectionFilter(connection))
+					continue;
 
-		while (currentRecord.pNode != pStartNode)
-		{
-			finalPath.push_back(currentRecord.pNode);
+				const int nextIdx = connection.to;
+				const float costSoFar = currentRecord.costSoFar + connection.cost;
 
-			for (auto& node : closedList)
-			{
-				if (node.pNode == m_pGraph->GetNode( currentRecord.pConnection->GetFrom()))
-				{
-					currentRecord = node;
-					break;
-				}
-			}			
+				const NodeState nextState = context.GetState(nextIdx);
+				NodeRecord& nextRecord = context.GetRecord(nextIdx);
+
+				// An open or closed node is only updated when this connection is cheaper,
+				// closed nodes are re-opened in that case
+				if (nextState != NodeState::Unvisited && nextRecord.costSoFar <= costSoFar)
+					continue;
+
+				nextRecord.connection = connection;
+				nextRecord.costSoFar = costSoFar;
+				nextRecord.estimatedTotalCost = costSoFar + GetHeuristicCost(nextIdx, goalIdx);
+				context.SetState(nextIdx, NodeState::Open);
+
+				openList.push_back({ nextRecord.estimatedTotalCost, context.m_InsertionOrder++, nextIdx });
+				std::push_heap(openList.begin(), openList.end(), heapCompare);
+			}
 		}
 
-		finalPath.push_back(pStartNode);
-		std::reverse(finalPath.begin(), finalPath.end());
+		return isGoalReached;
+	}
 
-		return finalPath;
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	void AStar<T_NodeType, T_ConnectionType, T_GraphType>::TracePath(int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<T_NodeType*>& path) const
+	{
+		// Track back from the goal using the connection stored in every record, the start node has none
+		for (int idx = goalIdx; idx != invalid_node_index; idx = context.GetRecord(idx).connection.from)
+			path.push_back(m_pGraph->GetNode(idx));
 
+		std::reverse(path.begin(), path.end());
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	float Elite::AStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	void AStar<T_NodeType, T_ConnectionType, T_GraphType>::TracePath(int goalIdx, AStarContext<T_NodeType, T_ConnectionType>& context, std::vector<int>& path) const
+	{
+		for (int idx = goalIdx; idx != invalid_node_index; idx = context.GetRecord(idx).connection.from)
+			path.push_back(idx);
+
+		std::reverse(path.begin(), path.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	float AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		const float heuristicCost = m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+
+		if (!m_pLandmarks)
+			return heuristicCost;
+
+		return std::max(heuristicCost, GetLandmarkLowerBound(*m_pGraph, fromIdx, toIdx, 0));
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	template <class T_Graph>
+	auto AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetLandmarkLowerBound(const T_Graph& graph, int fromIdx, int toIdx, int) const -> decltype(graph.GetLandmarkLowerBound(fromIdx, toIdx))
+	{
+		// The virtual nodes aren't in the tables, the overlay knows their distances
+		assert(m_pLandmarks == graph.GetLandmarks() && "<AStar>: use the landmarks of the overlay");
+		return graph.GetLandmarkLowerBound(fromIdx, toIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	template <class T_Graph>
+	float AStar<T_NodeType, T_ConnectionType, T_GraphType>::GetLandmarkLowerBound(const T_Graph& graph, int fromIdx, int toIdx, long) const
 	{
-		Vector2 toDestination = m_pGraph->GetNodePos(pEndNode) - m_pGraph->GetNodePos(pStartNode);
-		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		return m_pLandmarks->GetLowerBound(fromIdx, toIdx);
 	}
-}
\ No newline at end of file
+}
@@ -1,28 +1,35 @@
 #pragma once
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
 
 namespace Elite 
 {
-	template <class T_NodeType, class T_ConnectionType>
+	// The graph type only needs GetNeighbors(idx) (a range of GraphEdge) and GetNode(idx), e.g. an IGraph or a baked CSRGraph.
+	// Start and destination are looked up by index, so nodes of a mutable graph can be used to search its baked snapshot
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType = IGraph<T_NodeType, T_ConnectionType>>
 	class BFS
 	{
 	public:
-		BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		BFS(T_GraphType* pGraph);
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
 	private:
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		T_GraphType* m_pGraph = nullptr;
 	};
 
-	template <class T_NodeType, class T_ConnectionType>
-	BFS<T_NodeType, T_ConnectionType>::BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	BFS<T_NodeType, T_ConnectionType, T_GraphType>::BFS(T_GraphType* pGraph)
 		: m_pGraph(pGraph)
 	{
 
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
+	template <class T_NodeType, class T_ConnectionType, class T_GraphType>
+	std::vector<T_NodeType*> BFS<T_NodeType, T_ConnectionType, T_GraphType>::FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode)
 	{
+		T_GraphType& graph = *m_pGraph;
+		pStartNode = graph.GetNode(pStartNode->GetIndex());
+		pDestinationNode = graph.GetNode(pDestinationNode->GetIndex());
+
 		//during class
 		std::queue<T_NodeType*> openList;
 		std::map<T_NodeType*, T_NodeType*> closedList;
@@ -38,9 +45,9 @@ namespace Elite
 			if (pCurrentNode == pDestinationNode)
 				break;
 			
-			for (auto& connection : m_pGraph->GetNodeConnections(pCurrentNode))
+			for (const GraphEdge& connection : graph.GetNeighbors(pCurrentNode->GetIndex()))
 			{
-				T_NodeType* pNextNode = m_pGraph->GetNode(connection->GetTo());
+				T_NodeType* pNextNode = graph.GetNode(connection.to);
 
 				//als het er niet in zit
 				if (closedList.find(pNextNode) == closedList.end())
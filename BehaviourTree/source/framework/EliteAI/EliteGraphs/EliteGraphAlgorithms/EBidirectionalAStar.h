@@ -0,0 +1,206 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+
+namespace Elite
+{
+	// A* searching from the start and the goal at the same time, meant for long queries.
+	// Both searches use the average of the forward and backward heuristic (pf(n) = (h(n, goal) - h(start, n)) / 2),
+	// so they agree on the costs and the search can stop as soon as the best path found so far can't be improved.
+	// Like AStar the heuristic has to be consistent for the path to be optimal.
+	// Directional graphs are searched backwards through their incoming connections, which get enabled on the graph
+	template <class T_NodeType, class T_ConnectionType>
+	class BidirectionalAStar
+	{
+	public:
+		BidirectionalAStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// Amount of nodes that were expanded by both searches together during the last search
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		struct NodeRecord
+		{
+			float costSoFar = FLT_MAX; // from the start (forward) or to the goal (backward)
+			int parentIdx = invalid_node_index; // previous node on the path (forward) or the next one (backward)
+			bool isClosed = false;
+		};
+
+		struct Search
+		{
+			std::vector<NodeRecord> records;
+			std::vector<std::pair<float, int>> openList; // heap on the key, entries that don't match their record are skipped
+			bool isForward = true;
+		};
+
+		void ExpandNode(Search& search, const Search& otherSearch);
+		const std::pair<float, int>* PeekOpenList(Search& search);
+
+		// Key of a node on the open list, costSoFar + pf(n) forward and costSoFar - pf(n) backward
+		float GetKey(const Search& search, int nodeIdx) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+
+		Search m_ForwardSearch{};
+		Search m_BackwardSearch{};
+		int m_StartIdx = invalid_node_index;
+		int m_GoalIdx = invalid_node_index;
+
+		float m_BestCost = FLT_MAX; // of the shortest path found so far
+		int m_MeetingIdx = invalid_node_index; // node where that path goes from the forward search to the backward one
+
+		int m_NrOfExpandedNodes = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	BidirectionalAStar<T_NodeType, T_ConnectionType>::BidirectionalAStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+		if (m_pGraph->IsDirectionalGraph() && !m_pGraph->HasIncomingConnections())
+			m_pGraph->EnableIncomingConnections(true);
+
+		m_BackwardSearch.isForward = false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> BidirectionalAStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		std::vector<T_NodeType*> path{};
+		m_NrOfExpandedNodes = 0;
+
+		m_StartIdx = pStartNode->GetIndex();
+		m_GoalIdx = pGoalNode->GetIndex();
+		m_BestCost = FLT_MAX;
+		m_MeetingIdx = invalid_node_index;
+
+		if (m_StartIdx == m_GoalIdx)
+		{
+			path.push_back(pStartNode);
+			return path;
+		}
+
+		for (Search* pSearch : { &m_ForwardSearch, &m_BackwardSearch })
+		{
+			pSearch->records.assign(m_pGraph->GetNrOfNodes(), NodeRecord{});
+			pSearch->openList.clear();
+
+			const int sourceIdx = pSearch->isForward ? m_StartIdx : m_GoalIdx;
+			pSearch->records[sourceIdx].costSoFar = 0.f;
+			pSearch->openList.push_back({ GetKey(*pSearch, sourceIdx), sourceIdx });
+		}
+
+		// The keys of both searches add up to a lower bound of every path that still can be found
+		for (;;)
+		{
+			const std::pair<float, int>* pForwardTop = PeekOpenList(m_ForwardSearch);
+			const std::pair<float, int>* pBackwardTop = PeekOpenList(m_BackwardSearch);
+
+			if (!pForwardTop || !pBackwardTop || pForwardTop->first + pBackwardTop->first >= m_BestCost)
+				break;
+
+			if (pForwardTop->first <= pBackwardTop->first)
+				ExpandNode(m_ForwardSearch, m_BackwardSearch);
+			else
+				ExpandNode(m_BackwardSearch, m_ForwardSearch);
+		}
+
+		if (m_MeetingIdx == invalid_node_index)
+			return path;
+
+		for (int idx = m_MeetingIdx; idx != invalid_node_index; idx = m_ForwardSearch.records[idx].parentIdx)
+			path.push_back(m_pGraph->GetNode(idx));
+		std::reverse(path.begin(), path.end());
+
+		for (int idx = m_BackwardSearch.records[m_MeetingIdx].parentIdx; idx != invalid_node_index; idx = m_BackwardSearch.records[idx].parentIdx)
+			path.push_back(m_pGraph->GetNode(idx));
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void BidirectionalAStar<T_NodeType, T_ConnectionType>::ExpandNode(Search& search, const Search& otherSearch)
+	{
+		const auto heapCompare = std::greater<std::pair<float, int>>();
+
+		std::pop_heap(search.openList.begin(), search.openList.end(), heapCompare);
+		const int currentIdx = search.openList.back().second;
+		search.openList.pop_back();
+
+		NodeRecord& currentRecord = search.records[currentIdx];
+		currentRecord.isClosed = true;
+		++m_NrOfExpandedNodes;
+
+		auto visitNeighbor = [&](int nextIdx, float cost)
+		{
+			NodeRecord& nextRecord = search.records[nextIdx];
+			const float costSoFar = currentRecord.costSoFar + cost;
+			if (nextRecord.isClosed || costSoFar >= nextRecord.costSoFar)
+				return;
+
+			nextRecord.costSoFar = costSoFar;
+			nextRecord.parentIdx = currentIdx;
+			search.openList.push_back({ GetKey(search, nextIdx), nextIdx });
+			std::push_heap(search.openList.begin(), search.openList.end(), heapCompare);
+
+			// The searches meet, remember the path through this node if it is the shortest one yet
+			const float otherCostSoFar = otherSearch.records[nextIdx].costSoFar;
+			if (otherCostSoFar != FLT_MAX && costSoFar + otherCostSoFar < m_BestCost)
+			{
+				m_BestCost = costSoFar + otherCostSoFar;
+				m_MeetingIdx = nextIdx;
+			}
+		};
+
+		// Backwards, the connections leading to the node are followed (the same ones when the graph isn't directional)
+		if (search.isForward || !m_pGraph->IsDirectionalGraph())
+		{
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(currentIdx))
+				visitNeighbor(connection.to, connection.cost);
+		}
+		else
+		{
+			for (const GraphEdge& connection : m_pGraph->GetIncomingNeighbors(currentIdx))
+				visitNeighbor(connection.from, connection.cost);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const std::pair<float, int>* BidirectionalAStar<T_NodeType, T_ConnectionType>::PeekOpenList(Search& search)
+	{
+		const auto heapCompare = std::greater<std::pair<float, int>>();
+
+		while (!search.openList.empty())
+		{
+			const std::pair<float, int>& top = search.openList.front();
+			const NodeRecord& record = search.records[top.second];
+			if (!record.isClosed && top.first == GetKey(search, top.second))
+				return &top;
+
+			std::pop_heap(search.openList.begin(), search.openList.end(), heapCompare);
+			search.openList.pop_back();
+		}
+
+		return nullptr;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float BidirectionalAStar<T_NodeType, T_ConnectionType>::GetKey(const Search& search, int nodeIdx) const
+	{
+		const float potential = (GetHeuristicCost(nodeIdx, m_GoalIdx) - GetHeuristicCost(m_StartIdx, nodeIdx)) / 2.f;
+		const float costSoFar = search.records[nodeIdx].costSoFar;
+
+		return search.isForward ? costSoFar + potential : costSoFar - potential;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float BidirectionalAStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
@@ -0,0 +1,324 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+
+namespace Elite
+{
+	// D* Lite: searches from the goal back to the start and keeps its search state between queries.
+	// Changed connections are picked up through the graph's listener, the next query only repairs the nodes
+	// they affect instead of searching again. Moving the start keeps the state as well, changing the goal resets it.
+	// Works on undirected graphs, the neighbors of a node are also the nodes that have a connection to it
+	template <class T_NodeType, class T_ConnectionType>
+	class DStarLite final
+	{
+	public:
+		DStarLite(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		~DStarLite();
+
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode);
+
+		// Forgets the search state, the next query searches from scratch
+		void Reset();
+
+		// Nodes taken from the open list during the last query (0 when nothing changed)
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		struct Key
+		{
+			float cost = 0.f; // estimated total cost
+			float costSoFar = 0.f; // tie-break
+
+			bool operator<(const Key& other) const { return cost < other.cost || (cost == other.cost && costSoFar < other.costSoFar); }
+			bool operator==(const Key& other) const { return cost == other.cost && costSoFar == other.costSoFar; }
+		};
+
+		struct NodeRecord
+		{
+			float costToGoal = FLT_MAX; // g
+			float lookAheadCost = FLT_MAX; // rhs, based on the costs of the neighbors
+			Key key{};
+			bool isOpen = false;
+		};
+
+		struct OpenEntry
+		{
+			Key key{};
+			int nodeIdx = invalid_node_index;
+
+			// Inverted, so the standard heap keeps the smallest key on top
+			bool operator<(const OpenEntry& other) const { return other.key < key; }
+		};
+
+		void Initialize(int startIdx, int goalIdx);
+		void ComputeShortestPath();
+		void UpdateNode(int nodeIdx);
+		void MoveStart(int startIdx);
+		void ApplyChangedConnections();
+		void OnConnectionChanged(int from, int to);
+
+		Key CalculateKey(int nodeIdx) const;
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+		const OpenEntry* PeekOpenList(); // drops the entries that are outdated
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_ListenerId;
+
+		int m_StartIdx = invalid_node_index;
+		int m_GoalIdx = invalid_node_index;
+		int m_LastStartIdx = invalid_node_index; // start at the last time km was updated
+		float m_KeyModifier = 0.f; // km, raised by the heuristic distance the start moved
+
+		std::vector<NodeRecord> m_Records;
+		std::vector<OpenEntry> m_OpenList; // heap, an entry is outdated when its key doesn't match the record
+		std::vector<int> m_ChangedNodes;
+
+		int m_NrOfExpandedNodes = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	DStarLite<T_NodeType, T_ConnectionType>::DStarLite(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+		assert(!pGraph->IsDirectionalGraph() && "<DStarLite>: the neighbors of a node are used as its predecessors");
+
+		m_ListenerId = m_pGraph->AddConnectionChangedListener([this](int from, int to) { OnConnectionChanged(from, to); });
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	DStarLite<T_NodeType, T_ConnectionType>::~DStarLite()
+	{
+		m_pGraph->RemoveConnectionChangedListener(m_ListenerId);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> DStarLite<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		std::vector<T_NodeType*> path{};
+		m_NrOfExpandedNodes = 0;
+
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		if (goalIdx != m_GoalIdx || (int)m_Records.size() != m_pGraph->GetNrOfNodes())
+		{
+			Initialize(startIdx, goalIdx);
+		}
+		else
+		{
+			MoveStart(startIdx);
+			ApplyChangedConnections();
+		}
+
+		ComputeShortestPath();
+
+		if (m_Records[m_StartIdx].costToGoal == FLT_MAX)
+			return path;
+
+		// Follow the cheapest neighbor, every step gets closer to the goal so the path can't be longer than the graph
+		path.push_back(pStartNode);
+		int currentIdx = m_StartIdx;
+		while (currentIdx != m_GoalIdx && (int)path.size() <= m_pGraph->GetNrOfNodes())
+		{
+			int nextIdx = invalid_node_index;
+			float nextCost = FLT_MAX;
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(currentIdx))
+			{
+				const float costToGoal = m_Records[connection.to].costToGoal;
+				if (costToGoal != FLT_MAX && connection.cost + costToGoal < nextCost)
+				{
+					nextCost = connection.cost + costToGoal;
+					nextIdx = connection.to;
+				}
+			}
+
+			if (nextIdx == invalid_node_index)
+			{
+				path.clear();
+				return path;
+			}
+
+			path.push_back(m_pGraph->GetNode(nextIdx));
+			currentIdx = nextIdx;
+		}
+
+		// Only costs that are out of date let the walk go around in circles until the length guard stops it
+		assert(currentIdx == m_GoalIdx && "<DStarLite::FindPath>: the walk didn't reach the goal");
+		if (currentIdx != m_GoalIdx)
+			path.clear();
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::Reset()
+	{
+		m_GoalIdx = invalid_node_index;
+		m_Records.clear();
+		m_OpenList.clear();
+		m_ChangedNodes.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::Initialize(int startIdx, int goalIdx)
+	{
+		m_StartIdx = startIdx;
+		m_LastStartIdx = startIdx;
+		m_GoalIdx = goalIdx;
+		m_KeyModifier = 0.f;
+
+		m_Records.assign(m_pGraph->GetNrOfNodes(), NodeRecord{});
+		m_OpenList.clear();
+		m_ChangedNodes.clear();
+
+		NodeRecord& goalRecord = m_Records[goalIdx];
+		goalRecord.lookAheadCost = 0.f;
+		goalRecord.key = CalculateKey(goalIdx);
+		goalRecord.isOpen = true;
+		m_OpenList.push_back({ goalRecord.key, goalIdx });
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::ComputeShortestPath()
+	{
+		for (const OpenEntry* pTop = PeekOpenList(); pTop; pTop = PeekOpenList())
+		{
+			const NodeRecord& startRecord = m_Records[m_StartIdx];
+			if (!(pTop->key < CalculateKey(m_StartIdx)) && startRecord.lookAheadCost == startRecord.costToGoal)
+				break;
+
+			const int nodeIdx = pTop->nodeIdx;
+			const Key oldKey = pTop->key;
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+			++m_NrOfExpandedNodes;
+
+			NodeRecord& record = m_Records[nodeIdx];
+			record.isOpen = false;
+
+			const Key newKey = CalculateKey(nodeIdx);
+			if (oldKey < newKey)
+			{
+				// The start moved since the node was queued
+				record.key = newKey;
+				record.isOpen = true;
+				m_OpenList.push_back({ newKey, nodeIdx });
+				std::push_heap(m_OpenList.begin(), m_OpenList.end());
+			}
+			else if (record.costToGoal > record.lookAheadCost)
+			{
+				record.costToGoal = record.lookAheadCost;
+				for (const GraphEdge& connection : m_pGraph->GetNeighbors(nodeIdx))
+					UpdateNode(connection.to);
+			}
+			else
+			{
+				record.costToGoal = FLT_MAX;
+				UpdateNode(nodeIdx);
+				for (const GraphEdge& connection : m_pGraph->GetNeighbors(nodeIdx))
+					UpdateNode(connection.to);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::UpdateNode(int nodeIdx)
+	{
+		NodeRecord& record = m_Records[nodeIdx];
+
+		if (nodeIdx != m_GoalIdx)
+		{
+			record.lookAheadCost = FLT_MAX;
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(nodeIdx))
+			{
+				const float costToGoal = m_Records[connection.to].costToGoal;
+				if (costToGoal != FLT_MAX)
+					record.lookAheadCost = std::min(record.lookAheadCost, connection.cost + costToGoal);
+			}
+		}
+
+		// Entries that are already on the open list become outdated, a new one is added if the node is inconsistent
+		record.isOpen = false;
+		if (record.costToGoal != record.lookAheadCost)
+		{
+			record.key = CalculateKey(nodeIdx);
+			record.isOpen = true;
+			m_OpenList.push_back({ record.key, nodeIdx });
+			std::push_heap(m_OpenList.begin(), m_OpenList.end());
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::MoveStart(int startIdx)
+	{
+		// Keys on the open list were calculated from the old start, km keeps them lower bounds of the new keys.
+		// This has to happen on every move, ComputeShortestPath runs on every query even when no connection changed
+		m_StartIdx = startIdx;
+		if (m_StartIdx == m_LastStartIdx)
+			return;
+
+		m_KeyModifier += GetHeuristicCost(m_LastStartIdx, m_StartIdx);
+		m_LastStartIdx = m_StartIdx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::ApplyChangedConnections()
+	{
+		for (int nodeIdx : m_ChangedNodes)
+			UpdateNode(nodeIdx);
+
+		m_ChangedNodes.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DStarLite<T_NodeType, T_ConnectionType>::OnConnectionChanged(int from, int to)
+	{
+		// The graph was cleared, nothing of the search state can be kept
+		if (from == invalid_node_index)
+		{
+			Reset();
+			return;
+		}
+
+		// Only the cost from the start node of the connection depends on it
+		if (from < (int)m_Records.size())
+			m_ChangedNodes.push_back(from);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename DStarLite<T_NodeType, T_ConnectionType>::Key DStarLite<T_NodeType, T_ConnectionType>::CalculateKey(int nodeIdx) const
+	{
+		const NodeRecord& record = m_Records[nodeIdx];
+		const float costToGoal = std::min(record.costToGoal, record.lookAheadCost);
+		if (costToGoal == FLT_MAX)
+			return Key{ FLT_MAX, FLT_MAX };
+
+		return Key{ costToGoal + GetHeuristicCost(m_StartIdx, nodeIdx) + m_KeyModifier, costToGoal };
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float DStarLite<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const typename DStarLite<T_NodeType, T_ConnectionType>::OpenEntry* DStarLite<T_NodeType, T_ConnectionType>::PeekOpenList()
+	{
+		while (!m_OpenList.empty())
+		{
+			const OpenEntry& top = m_OpenList.front();
+			const NodeRecord& record = m_Records[top.nodeIdx];
+			if (record.isOpen && record.key == top.key)
+				return &top;
+
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+		}
+
+		return nullptr;
+	}
+}
@@ -0,0 +1,341 @@
+/*=============================================================================*/
+// EDijkstraMap.h: Distance to the nearest source and which source that is, for every node of a graph.
+// Sources are tagged with a category (food, houses, items...), every category has its own distances, so
+// "nearest reachable X" is answered with a lookup instead of a search per candidate.
+// The distances are repaired instead of computed again when sources are added, moved or removed or when
+// connections change (the costs and look-ahead costs of D* Lite, without heuristic).
+// Works on undirected graphs, the neighbors of a node are also the nodes that have a connection to it
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+
+namespace Elite
+{
+	template <class T_NodeType, class T_ConnectionType>
+	class DijkstraMap final
+	{
+	public:
+		explicit DijkstraMap(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		~DijkstraMap();
+
+		// Returns the id to move or remove the source with. Changes are picked up by the next Update
+		int AddSource(int nodeIdx, int category = 0);
+		void MoveSource(int sourceId, int nodeIdx);
+		void RemoveSource(int sourceId);
+
+		// Repairs the distances of the categories whose sources or connections changed since the last update
+		void Update();
+
+		// FLT_MAX when no source of the category can be reached from the node
+		float GetDistance(int nodeIdx, int category = 0) const;
+		float GetDistance(const Vector2& pos, int category = 0) const;
+		// invalid_source_id when no source of the category can be reached from the node
+		int GetNearestSource(int nodeIdx, int category = 0) const;
+		int GetNearestSource(const Vector2& pos, int category = 0) const;
+
+		int GetSourceNode(int sourceId) const { return m_Sources.at(sourceId).nodeIdx; }
+		int GetSourceCategory(int sourceId) const { return m_Sources.at(sourceId).category; }
+		int GetNrOfSources() const { return (int)m_Sources.size(); }
+
+		// Nodes taken from the open lists during the last update
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+		static const int invalid_source_id = -1;
+
+	private:
+		struct NodeRecord
+		{
+			float distance = FLT_MAX; // g
+			float lookAheadDistance = FLT_MAX; // rhs, based on the distances of the neighbors
+			int nearestSource = invalid_source_id;
+			int lookAheadSource = invalid_source_id;
+			float key = FLT_MAX;
+			bool isOpen = false;
+		};
+
+		struct OpenEntry
+		{
+			float key = FLT_MAX;
+			int nodeIdx = invalid_node_index;
+
+			// Inverted, so the standard heap keeps the smallest key on top
+			bool operator<(const OpenEntry& other) const { return other.key < key; }
+		};
+
+		struct Source
+		{
+			int nodeIdx;
+			int category;
+		};
+
+		// The distances of one category
+		struct Layer
+		{
+			std::vector<NodeRecord> records{};
+			std::vector<OpenEntry> openList{}; // heap, an entry is outdated when its key doesn't match the record
+			std::unordered_map<int, std::vector<int>> nodeSources{}; // sources per node, the first one is the nearest
+			std::vector<int> changedNodes{};
+		};
+
+		void ComputeDistances(Layer& layer);
+		void UpdateNode(Layer& layer, int nodeIdx);
+		const OpenEntry* PeekOpenList(Layer& layer); // drops the entries that are outdated
+		const NodeRecord* GetRecord(int nodeIdx, int category) const;
+		void OnConnectionChanged(int from, int to);
+
+		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		int m_ListenerId;
+
+		std::map<int, Layer> m_Layers{}; // per category
+		std::unordered_map<int, Source> m_Sources{};
+		int m_NextSourceId = 0;
+
+		int m_NrOfExpandedNodes = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	DijkstraMap<T_NodeType, T_ConnectionType>::DijkstraMap(IGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_pGraph(pGraph)
+	{
+		assert(!pGraph->IsDirectionalGraph() && "<DijkstraMap>: the neighbors of a node are used as its predecessors");
+
+		m_ListenerId = m_pGraph->AddConnectionChangedListener([this](int from, int to) { OnConnectionChanged(from, to); });
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	DijkstraMap<T_NodeType, T_ConnectionType>::~DijkstraMap()
+	{
+		m_pGraph->RemoveConnectionChangedListener(m_ListenerId);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int DijkstraMap<T_NodeType, T_ConnectionType>::AddSource(int nodeIdx, int category)
+	{
+		assert(m_pGraph->IsNodeValid(nodeIdx) && "<DijkstraMap::AddSource>: invalid node");
+
+		const int sourceId = m_NextSourceId++;
+		m_Sources[sourceId] = Source{ nodeIdx, category };
+
+		Layer& layer = m_Layers[category];
+		layer.nodeSources[nodeIdx].push_back(sourceId);
+		layer.changedNodes.push_back(nodeIdx);
+
+		return sourceId;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::MoveSource(int sourceId, int nodeIdx)
+	{
+		assert(m_pGraph->IsNodeValid(nodeIdx) && "<DijkstraMap::MoveSource>: invalid node");
+
+		auto it = m_Sources.find(sourceId);
+		if (it == m_Sources.end() || it->second.nodeIdx == nodeIdx)
+			return;
+
+		const int category = it->second.category;
+		RemoveSource(sourceId);
+
+		m_Sources[sourceId] = Source{ nodeIdx, category };
+		Layer& layer = m_Layers[category];
+		layer.nodeSources[nodeIdx].push_back(sourceId);
+		layer.changedNodes.push_back(nodeIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::RemoveSource(int sourceId)
+	{
+		auto it = m_Sources.find(sourceId);
+		if (it == m_Sources.end())
+			return;
+
+		Layer& layer = m_Layers[it->second.category];
+		const int nodeIdx = it->second.nodeIdx;
+		m_Sources.erase(it);
+
+		std::vector<int>& nodeSources = layer.nodeSources[nodeIdx];
+		nodeSources.erase(std::remove(nodeSources.begin(), nodeSources.end(), sourceId), nodeSources.end());
+		if (nodeSources.empty())
+			layer.nodeSources.erase(nodeIdx);
+
+		layer.changedNodes.push_back(nodeIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::Update()
+	{
+		m_NrOfExpandedNodes = 0;
+
+		for (auto& categoryLayer : m_Layers)
+		{
+			Layer& layer = categoryLayer.second;
+
+			// Nodes were added or removed (or the graph was cleared), the layer is built again from its sources
+			if ((int)layer.records.size() != m_pGraph->GetNrOfNodes())
+			{
+				layer.records.assign(m_pGraph->GetNrOfNodes(), NodeRecord{});
+				layer.openList.clear();
+				layer.changedNodes.clear();
+				for (const auto& nodeSources : layer.nodeSources)
+					layer.changedNodes.push_back(nodeSources.first);
+			}
+
+			if (layer.changedNodes.empty())
+				continue;
+
+			for (int nodeIdx : layer.changedNodes)
+			{
+				if (nodeIdx < (int)layer.records.size())
+					UpdateNode(layer, nodeIdx);
+			}
+			layer.changedNodes.clear();
+
+			ComputeDistances(layer);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float DijkstraMap<T_NodeType, T_ConnectionType>::GetDistance(int nodeIdx, int category) const
+	{
+		const NodeRecord* pRecord = GetRecord(nodeIdx, category);
+		return pRecord ? pRecord->distance : FLT_MAX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float DijkstraMap<T_NodeType, T_ConnectionType>::GetDistance(const Vector2& pos, int category) const
+	{
+		return GetDistance(m_pGraph->GetNodeIdxAtWorldPos(pos), category);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int DijkstraMap<T_NodeType, T_ConnectionType>::GetNearestSource(int nodeIdx, int category) const
+	{
+		const NodeRecord* pRecord = GetRecord(nodeIdx, category);
+		return pRecord ? pRecord->nearestSource : invalid_source_id;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int DijkstraMap<T_NodeType, T_ConnectionType>::GetNearestSource(const Vector2& pos, int category) const
+	{
+		return GetNearestSource(m_pGraph->GetNodeIdxAtWorldPos(pos), category);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::ComputeDistances(Layer& layer)
+	{
+		for (const OpenEntry* pTop = PeekOpenList(layer); pTop; pTop = PeekOpenList(layer))
+		{
+			const int nodeIdx = pTop->nodeIdx;
+			std::pop_heap(layer.openList.begin(), layer.openList.end());
+			layer.openList.pop_back();
+			++m_NrOfExpandedNodes;
+
+			NodeRecord& record = layer.records[nodeIdx];
+			record.isOpen = false;
+
+			if (record.distance < record.lookAheadDistance)
+			{
+				// The node got further away, it and its neighbors pick the best of what is left
+				record.distance = FLT_MAX;
+				record.nearestSource = invalid_source_id;
+				UpdateNode(layer, nodeIdx);
+			}
+			else
+			{
+				// Closer, or as close to another source
+				record.distance = record.lookAheadDistance;
+				record.nearestSource = record.lookAheadSource;
+			}
+
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(nodeIdx))
+				UpdateNode(layer, connection.to);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::UpdateNode(Layer& layer, int nodeIdx)
+	{
+		NodeRecord& record = layer.records[nodeIdx];
+
+		auto sourceIt = layer.nodeSources.find(nodeIdx);
+		if (sourceIt != layer.nodeSources.end())
+		{
+			record.lookAheadDistance = 0.f;
+			record.lookAheadSource = sourceIt->second.front();
+		}
+		else
+		{
+			record.lookAheadDistance = FLT_MAX;
+			record.lookAheadSource = invalid_source_id;
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(nodeIdx))
+			{
+				const NodeRecord& neighborRecord = layer.records[connection.to];
+				if (neighborRecord.distance != FLT_MAX && connection.cost + neighborRecord.distance < record.lookAheadDistance)
+				{
+					record.lookAheadDistance = connection.cost + neighborRecord.distance;
+					record.lookAheadSource = neighborRecord.nearestSource;
+				}
+			}
+		}
+
+		// Entries that are already on the open list become outdated, a new one is added if the node is inconsistent
+		record.isOpen = false;
+		if (record.distance != record.lookAheadDistance || record.nearestSource != record.lookAheadSource)
+		{
+			record.key = std::min(record.distance, record.lookAheadDistance);
+			record.isOpen = true;
+			layer.openList.push_back({ record.key, nodeIdx });
+			std::push_heap(layer.openList.begin(), layer.openList.end());
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const typename DijkstraMap<T_NodeType, T_ConnectionType>::OpenEntry* DijkstraMap<T_NodeType, T_ConnectionType>::PeekOpenList(Layer& layer)
+	{
+		while (!layer.openList.empty())
+		{
+			const OpenEntry& top = layer.openList.front();
+			const NodeRecord& record = layer.records[top.nodeIdx];
+			if (record.isOpen && record.key == top.key)
+				return &top;
+
+			std::pop_heap(layer.openList.begin(), layer.openList.end());
+			layer.openList.pop_back();
+		}
+
+		return nullptr;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	const typename DijkstraMap<T_NodeType, T_ConnectionType>::NodeRecord* DijkstraMap<T_NodeType, T_ConnectionType>::GetRecord(int nodeIdx, int category) const
+	{
+		auto it = m_Layers.find(category);
+		if (it == m_Layers.end() || nodeIdx < 0 || nodeIdx >= (int)it->second.records.size())
+			return nullptr;
+
+		return &it->second.records[nodeIdx];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void DijkstraMap<T_NodeType, T_ConnectionType>::OnConnectionChanged(int from, int to)
+	{
+		// The graph was cleared, the next update builds every layer again from its sources
+		if (from == invalid_node_index)
+		{
+			for (auto& categoryLayer : m_Layers)
+			{
+				categoryLayer.second.records.clear();
+				categoryLayer.second.openList.clear();
+				categoryLayer.second.changedNodes.clear();
+			}
+			return;
+		}
+
+		// The look-ahead distance of both ends depends on the connection
+		for (auto& categoryLayer : m_Layers)
+		{
+			categoryLayer.second.changedNodes.push_back(from);
+			categoryLayer.second.changedNodes.push_back(to);
+		}
+	}
+}
@@ -0,0 +1,491 @@
+/*=============================================================================*/
+// EFlowField.h: Cost to the nearest goal and the direction to walk in for every cell of a grid, so any
+// number of agents heading to the same goals share one search instead of running A* each.
+// The costs are a Dijkstra from the goals that is repaired instead of redone when the goals change
+// (the costs and look-ahead costs of D* Lite, without heuristic), only the cells whose cost changes are visited.
+// The worker builds the fields on its own thread from a baked snapshot of the grid (see EPathRequestQueue.h).
+/*=============================================================================*/
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "framework/EliteAI/EliteGraphs/ECSRGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGridUtilities.h"
+
+namespace Elite
+{
+	// The result: one cost and direction per cell of a grid graph, cell indices are row * columns + column
+	class FlowField final
+	{
+	public:
+		FlowField(int columns, int rows, float cellSize)
+			: m_NrOfColumns(columns)
+			, m_NrOfRows(rows)
+			, m_CellSize(cellSize)
+			, m_Costs(columns * rows, FLT_MAX)
+			, m_Directions(columns * rows, ZeroVector2)
+		{
+		}
+
+		int GetColumns() const { return m_NrOfColumns; }
+		int GetRows() const { return m_NrOfRows; }
+		float GetCellSize() const { return m_CellSize; }
+		int GetNrOfCells() const { return (int)m_Costs.size(); }
+
+		// Same cells as GridGraph::GetNodeIdxAtWorldPos, invalid_node_index outside the grid
+		int GetCellIdxAtWorldPos(const Vector2& pos) const
+		{
+			return GetGridCellIdxAtWorldPos(pos, m_NrOfColumns, m_NrOfRows, m_CellSize);
+		}
+
+		// FLT_MAX when no goal can be reached from the cell, 0 in the goals
+		float GetCost(int cellIdx) const { return m_Costs[cellIdx]; }
+		bool IsReachable(int cellIdx) const { return m_Costs[cellIdx] != FLT_MAX; }
+
+		// Normalized direction to the next cell on the cheapest way to a goal, zero in the goals and in unreachable cells
+		const Vector2& GetDirection(int cellIdx) const { return m_Directions[cellIdx]; }
+		Vector2 GetDirection(const Vector2& pos) const
+		{
+			const int cellIdx = GetCellIdxAtWorldPos(pos);
+			return cellIdx == invalid_node_index ? ZeroVector2 : m_Directions[cellIdx];
+		}
+
+	private:
+		template <class T_NodeType> friend class FlowFieldSolver;
+
+		int m_NrOfColumns;
+		int m_NrOfRows;
+		float m_CellSize;
+		std::vector<float> m_Costs;
+		std::vector<Vector2> m_Directions;
+	};
+
+	// Builds and repairs a flow field on the calling thread. Works on undirected graphs,
+	// the neighbors of a cell are also the cells that have a connection to it
+	template <class T_NodeType>
+	class FlowFieldSolver final
+	{
+	public:
+		FlowFieldSolver(int columns, int rows, float cellSize) : m_FlowField(columns, rows, cellSize) {}
+
+		// The graph has to be baked from a grid with the same size, it isn't copied. Changing it forgets the costs,
+		// the next update builds the whole field again
+		void SetGraph(const CSRGraph<T_NodeType>* pGraph);
+
+		// Repairs the costs and directions of the cells the changed goals affect. When no goal is kept the field is
+		// built from scratch instead, every reachable cell changes then anyway
+		void SetGoals(const std::vector<int>& goalIndices);
+
+		const FlowField& GetFlowField() const { return m_FlowField; }
+		const std::vector<int>& GetGoals() const { return m_Goals; }
+
+		// Cells taken from the open list and directions that were recalculated during the last update
+		int GetNrOfExpandedCells() const { return m_NrOfExpandedCells; }
+		int GetNrOfUpdatedDirections() const { return m_NrOfUpdatedDirections; }
+
+	private:
+		struct CellRecord
+		{
+			float lookAheadCost = FLT_MAX; // rhs, based on the costs of the neighbors
+			float key = FLT_MAX;
+			bool isOpen = false;
+			bool isGoal = false;
+			unsigned int directionStamp = 0; // update in which the direction was last marked as outdated
+		};
+
+		struct OpenEntry
+		{
+			float key = FLT_MAX;
+			int cellIdx = invalid_node_index;
+
+			// Inverted, so the standard heap keeps the smallest key on top
+			bool operator<(const OpenEntry& other) const { return other.key < key; }
+		};
+
+		void Initialize();
+		void ComputeCosts();
+		void UpdateCell(int cellIdx);
+		void MarkDirectionOutdated(int cellIdx);
+		void UpdateDirections();
+		const OpenEntry* PeekOpenList(); // drops the entries that are outdated
+
+		const CSRGraph<T_NodeType>* m_pGraph = nullptr;
+		FlowField m_FlowField;
+		std::vector<CellRecord> m_Records{};
+		std::vector<OpenEntry> m_OpenList{}; // heap, an entry is outdated when its key doesn't match the record
+		std::vector<int> m_Goals{};
+		std::vector<int> m_OutdatedDirections{};
+		unsigned int m_UpdateStamp = 0;
+
+		int m_NrOfExpandedCells = 0;
+		int m_NrOfUpdatedDirections = 0;
+	};
+
+	// Keeps a flow field up to date on a worker thread. Only the latest graph and goals are built, requests that
+	// come in while the worker is busy replace each other. Agents read the last finished field, which never changes
+	template <class T_NodeType>
+	class FlowFieldWorker final
+	{
+	public:
+		using GraphSnapshot = std::shared_ptr<const CSRGraph<T_NodeType>>;
+
+		FlowFieldWorker(int columns, int rows, float cellSize);
+		~FlowFieldWorker();
+
+		// Snapshots aren't changed anymore once they are handed over, bake a new one when the grid changes
+		void SetGraph(const GraphSnapshot& pGraph);
+		void SetGoals(const std::vector<int>& goalIndices);
+
+		// nullptr until the first field is built
+		std::shared_ptr<const FlowField> GetFlowField() const;
+		bool IsBusy() const;
+
+		// Stats of the last finished field
+		float GetLastUpdateTime() const; // in milliseconds
+		int GetNrOfExpandedCells() const;
+
+	private:
+		void RunWorker();
+
+		FlowFieldSolver<T_NodeType> m_Solver; // only used by the worker
+		std::thread m_Worker;
+
+		// Everything below is guarded by the mutex
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_RequestAvailable;
+		bool m_IsStopping = false;
+		bool m_IsWorking = false;
+
+		GraphSnapshot m_pPendingGraph = nullptr;
+		std::vector<int> m_PendingGoals{};
+		bool m_HasPendingGraph = false;
+		bool m_HasPendingGoals = false;
+
+		std::shared_ptr<const FlowField> m_pFlowField = nullptr;
+		float m_LastUpdateTime = 0.f;
+		int m_NrOfExpandedCells = 0;
+	};
+
+	//--- FlowFieldSolver ---
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::SetGraph(const CSRGraph<T_NodeType>* pGraph)
+	{
+		assert(pGraph && pGraph->GetNrOfNodes() == m_FlowField.GetNrOfCells() && "<FlowFieldSolver::SetGraph>: the graph doesn't match the grid");
+		assert(!pGraph->IsDirectionalGraph() && "<FlowFieldSolver::SetGraph>: the neighbors of a cell are used as its predecessors");
+
+		m_pGraph = pGraph;
+		Initialize();
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::SetGoals(const std::vector<int>& goalIndices)
+	{
+		assert(m_pGraph && "<FlowFieldSolver::SetGoals>: there is no graph");
+
+		m_NrOfExpandedCells = 0;
+		m_NrOfUpdatedDirections = 0;
+		++m_UpdateStamp;
+
+		std::vector<int> goals{};
+		for (int goalIdx : goalIndices)
+		{
+			if (m_pGraph->IsNodeValid(goalIdx) && std::find(goals.begin(), goals.end(), goalIdx) == goals.end())
+				goals.push_back(goalIdx);
+		}
+
+		const bool isGoalKept = std::any_of(goals.begin(), goals.end(), [this](int goalIdx) { return m_Records[goalIdx].isGoal; });
+		if (!isGoalKept)
+		{
+			Initialize();
+			++m_UpdateStamp;
+		}
+
+		// Removed goals get the cost of their neighbors again, new goals become free
+		for (int goalIdx : m_Goals)
+		{
+			if (std::find(goals.begin(), goals.end(), goalIdx) == goals.end())
+			{
+				m_Records[goalIdx].isGoal = false;
+				UpdateCell(goalIdx);
+			}
+		}
+		for (int goalIdx : goals)
+		{
+			if (!m_Records[goalIdx].isGoal)
+			{
+				m_Records[goalIdx].isGoal = true;
+				UpdateCell(goalIdx);
+			}
+		}
+		m_Goals = goals;
+
+		ComputeCosts();
+		UpdateDirections();
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::Initialize()
+	{
+		std::fill(m_FlowField.m_Costs.begin(), m_FlowField.m_Costs.end(), FLT_MAX);
+		std::fill(m_FlowField.m_Directions.begin(), m_FlowField.m_Directions.end(), ZeroVector2);
+		m_Records.assign(m_FlowField.GetNrOfCells(), CellRecord{});
+		m_OpenList.clear();
+		m_OutdatedDirections.clear();
+		m_Goals.clear();
+		m_UpdateStamp = 0;
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::ComputeCosts()
+	{
+		std::vector<float>& costs = m_FlowField.m_Costs;
+
+		for (const OpenEntry* pTop = PeekOpenList(); pTop; pTop = PeekOpenList())
+		{
+			const int cellIdx = pTop->cellIdx;
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+			++m_NrOfExpandedCells;
+
+			CellRecord& record = m_Records[cellIdx];
+			record.isOpen = false;
+			MarkDirectionOutdated(cellIdx);
+
+			if (costs[cellIdx] > record.lookAheadCost)
+			{
+				costs[cellIdx] = record.lookAheadCost;
+				for (const GraphEdge& connection : m_pGraph->GetNeighbors(cellIdx))
+					UpdateCell(connection.to);
+			}
+			else
+			{
+				// The cell got more expensive, it and its neighbors pick the best of what is left
+				costs[cellIdx] = FLT_MAX;
+				UpdateCell(cellIdx);
+				for (const GraphEdge& connection : m_pGraph->GetNeighbors(cellIdx))
+					UpdateCell(connection.to);
+			}
+		}
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::UpdateCell(int cellIdx)
+	{
+		const std::vector<float>& costs = m_FlowField.m_Costs;
+		CellRecord& record = m_Records[cellIdx];
+
+		if (record.isGoal)
+		{
+			record.lookAheadCost = 0.f;
+		}
+		else
+		{
+			record.lookAheadCost = FLT_MAX;
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(cellIdx))
+			{
+				const float cost = costs[connection.to];
+				if (cost != FLT_MAX)
+					record.lookAheadCost = std::min(record.lookAheadCost, connection.cost + cost);
+			}
+		}
+
+		// Entries that are already on the open list become outdated, a new one is added if the cell is inconsistent
+		record.isOpen = false;
+		if (costs[cellIdx] != record.lookAheadCost)
+		{
+			record.key = std::min(costs[cellIdx], record.lookAheadCost);
+			record.isOpen = true;
+			m_OpenList.push_back({ record.key, cellIdx });
+			std::push_heap(m_OpenList.begin(), m_OpenList.end());
+		}
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::MarkDirectionOutdated(int cellIdx)
+	{
+		// The direction of a cell depends on the costs of its neighbors
+		auto mark = [this](int idx)
+		{
+			if (m_Records[idx].directionStamp == m_UpdateStamp)
+				return;
+
+			m_Records[idx].directionStamp = m_UpdateStamp;
+			m_OutdatedDirections.push_back(idx);
+		};
+
+		mark(cellIdx);
+		for (const GraphEdge& connection : m_pGraph->GetNeighbors(cellIdx))
+			mark(connection.to);
+	}
+
+	template <class T_NodeType>
+	void FlowFieldSolver<T_NodeType>::UpdateDirections()
+	{
+		const std::vector<float>& costs = m_FlowField.m_Costs;
+		std::vector<Vector2>& directions = m_FlowField.m_Directions;
+
+		for (int cellIdx : m_OutdatedDirections)
+		{
+			directions[cellIdx] = ZeroVector2;
+			if (m_Records[cellIdx].isGoal || costs[cellIdx] == FLT_MAX)
+				continue;
+
+			int nextIdx = invalid_node_index;
+			float nextCost = FLT_MAX;
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(cellIdx))
+			{
+				const float cost = costs[connection.to];
+				if (cost != FLT_MAX && connection.cost + cost < nextCost)
+				{
+					nextCost = connection.cost + cost;
+					nextIdx = connection.to;
+				}
+			}
+
+			if (nextIdx != invalid_node_index)
+				directions[cellIdx] = (m_pGraph->GetNodeWorldPos(nextIdx) - m_pGraph->GetNodeWorldPos(cellIdx)).GetNormalized();
+		}
+
+		m_NrOfUpdatedDirections = (int)m_OutdatedDirections.size();
+		m_OutdatedDirections.clear();
+	}
+
+	template <class T_NodeType>
+	const typename FlowFieldSolver<T_NodeType>::OpenEntry* FlowFieldSolver<T_NodeType>::PeekOpenList()
+	{
+		while (!m_OpenList.empty())
+		{
+			const OpenEntry& top = m_OpenList.front();
+			const CellRecord& record = m_Records[top.cellIdx];
+			if (record.isOpen && record.key == top.key)
+				return &top;
+
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end());
+			m_OpenList.pop_back();
+		}
+
+		return nullptr;
+	}
+
+	//--- FlowFieldWorker ---
+	template <class T_NodeType>
+	FlowFieldWorker<T_NodeType>::FlowFieldWorker(int columns, int rows, float cellSize)
+		: m_Solver(columns, rows, cellSize)
+	{
+		m_Worker = std::thread(&FlowFieldWorker::RunWorker, this);
+	}
+
+	template <class T_NodeType>
+	FlowFieldWorker<T_NodeType>::~FlowFieldWorker()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_RequestAvailable.notify_all();
+
+		m_Worker.join();
+	}
+
+	template <class T_NodeType>
+	void FlowFieldWorker<T_NodeType>::SetGraph(const GraphSnapshot& pGraph)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_pPendingGraph = pGraph;
+			m_HasPendingGraph = true;
+		}
+		m_RequestAvailable.notify_one();
+	}
+
+	template <class T_NodeType>
+	void FlowFieldWorker<T_NodeType>::SetGoals(const std::vector<int>& goalIndices)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_PendingGoals = goalIndices;
+			m_HasPendingGoals = true;
+		}
+		m_RequestAvailable.notify_one();
+	}
+
+	template <class T_NodeType>
+	std::shared_ptr<const FlowField> FlowFieldWorker<T_NodeType>::GetFlowField() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_pFlowField;
+	}
+
+	template <class T_NodeType>
+	bool FlowFieldWorker<T_NodeType>::IsBusy() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_IsWorking || m_HasPendingGraph || m_HasPendingGoals;
+	}
+
+	template <class T_NodeType>
+	float FlowFieldWorker<T_NodeType>::GetLastUpdateTime() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_LastUpdateTime;
+	}
+
+	template <class T_NodeType>
+	int FlowFieldWorker<T_NodeType>::GetNrOfExpandedCells() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_NrOfExpandedCells;
+	}
+
+	template <class T_NodeType>
+	void FlowFieldWorker<T_NodeType>::RunWorker()
+	{
+		GraphSnapshot pGraph = nullptr; // kept alive as long as the solver points to it
+		std::vector<int> goals{};
+
+		for (;;)
+		{
+			bool isGraphChanged = false;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_IsWorking = false;
+				m_RequestAvailable.wait(lock, [this]() { return m_IsStopping || m_HasPendingGraph || m_HasPendingGoals; });
+
+				if (m_IsStopping)
+					return;
+
+				if (m_HasPendingGraph)
+				{
+					pGraph = m_pPendingGraph;
+					m_pPendingGraph = nullptr;
+					isGraphChanged = true;
+				}
+				if (m_HasPendingGoals)
+					goals = m_PendingGoals;
+
+				m_HasPendingGraph = false;
+				m_HasPendingGoals = false;
+				m_IsWorking = true;
+			}
+
+			if (!pGraph)
+				continue;
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			if (isGraphChanged)
+				m_Solver.SetGraph(pGraph.get());
+			m_Solver.SetGoals(goals);
+			auto pFlowField = std::make_shared<const FlowField>(m_Solver.GetFlowField());
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_pFlowField = pFlowField;
+				m_LastUpdateTime = std::chrono::duration<float, std::milli>(end - start).count();
+				m_NrOfExpandedCells = m_Solver.GetNrOfExpandedCells();
+			}
+		}
+	}
+}
@@ -0,0 +1,661 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+
+namespace Elite
+{
+	// Hierarchical pathfinding (HPA*) on an undirected GridGraph.
+	// The grid is split in square clusters, the cells where neighboring clusters connect (entrances) form an abstract graph
+	// together with the cached costs between the entrances of the same cluster. Queries search the abstract graph and
+	// only refine the segments that are asked for. Changed connections are picked up through the graph's listener,
+	// the clusters they belong to are rebuilt before the next query
+	template <class T_NodeType, class T_ConnectionType>
+	class HPAStar final
+	{
+	public:
+		HPAStar(GridGraph<T_NodeType, T_ConnectionType>* pGraph, int clusterSize, Heuristic hFunction);
+		~HPAStar();
+
+		// Searches the abstract graph, the path holds the start, the entrances to pass and the goal (cell indices)
+		bool FindAbstractPath(int startIdx, int goalIdx, std::vector<int>& abstractPath);
+
+		// Appends the cells from (exclusive) to to (inclusive), from and to have to be consecutive nodes of an abstract path
+		void RefineSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path);
+
+		// Abstract search and full refinement in one go
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+
+		// Rebuilds the clusters of connections that changed since the last query (also done by the queries themselves)
+		void UpdateDirtyClusters();
+
+		// Stats
+		int GetNrOfClusters() const { return m_NrOfClustersX * m_NrOfClustersY; }
+		int GetNrOfAbstractNodes() const { return (int)m_AbstractEdges.size(); }
+		int GetNrOfAbstractEdges() const;
+		int GetNrOfRebuiltClusters() const { return m_NrOfRebuiltClusters; } // during the last update
+		float GetLastRebuildTime() const { return m_LastRebuildTime; }
+		float GetLastAbstractSearchTime() const { return m_LastAbstractSearchTime; }
+		float GetLastRefineTime() const { return m_LastRefineTime; }
+
+	private:
+		struct Entrance
+		{
+			int cellIdx = invalid_node_index; // side of the cluster that owns the border
+			int otherCellIdx = invalid_node_index; // side of the neighboring cluster
+			float cost = 0.f;
+
+			bool operator==(const Entrance& other) const { return cellIdx == other.cellIdx && otherCellIdx == other.otherCellIdx && cost == other.cost; }
+		};
+
+		struct AbstractEdge
+		{
+			int to = invalid_node_index;
+			float cost = 0.f;
+		};
+
+		struct AbstractRecord
+		{
+			int parentIdx = invalid_node_index;
+			float costSoFar = 0.f;
+			bool isClosed = false;
+		};
+
+		// A cluster owns the borders with its neighbors to the right and below, and the two corners below it.
+		// Diagonal connections count as well, on 8-connected grids two clusters can touch only diagonally
+		enum class Border { Right, Bottom, BottomRight, BottomLeft };
+		static const int m_NrOfBorders = 4;
+
+		// Runs of connections over a border longer than this get an entrance at each end of the run instead of the middle
+		static const int m_MaxSingleEntranceLength = 6;
+
+		int GetClusterIdx(int cellIdx) const;
+		int GetBorderIdx(int clusterIdx, Border border) const { return clusterIdx * m_NrOfBorders + int(border); }
+		int GetNeighborClusterIdx(int clusterIdx, Border border, bool isForward) const;
+		bool IsInCluster(int clusterIdx, int col, int row) const;
+
+		// Calls visitor(ownerClusterIdx, border, isOwner) for the borders on all sides of the cluster
+		template <typename T_Visitor>
+		void VisitBorders(int clusterIdx, T_Visitor visitor) const;
+
+		void BuildAllClusters();
+		void RebuildBorder(int clusterIdx, Border border, std::vector<int>& changedClusters);
+		void RebuildCluster(int clusterIdx);
+		void OnConnectionChanged(int from, int to);
+
+		// Dijkstra over the cells of one cluster, stops early when the target is found (if any)
+		void SearchCluster(int clusterIdx, int sourceIdx, int targetIdx);
+		float GetClusterCost(int clusterIdx, int cellIdx) const;
+
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_ListenerId;
+
+		int m_ClusterSize;
+		int m_NrOfClustersX;
+		int m_NrOfClustersY;
+
+		// m_NrOfBorders per cluster, see GetBorderIdx
+		std::vector<std::vector<Entrance>> m_BorderEntrances;
+		std::vector<std::vector<int>> m_ClusterNodes;
+		std::unordered_map<int, std::vector<AbstractEdge>> m_AbstractEdges;
+
+		std::vector<bool> m_IsClusterDirty;
+		std::vector<int> m_DirtyClusters;
+		bool m_IsGraphCleared = false; // every cluster is built again, the grid might have another size
+
+		// Cluster search scratch space, indexed by the local cell index in the cluster
+		std::vector<float> m_ClusterCosts;
+		std::vector<int> m_ClusterParents;
+		std::vector<std::pair<float, int>> m_ClusterOpenList;
+
+		int m_NrOfRebuiltClusters = 0;
+		float m_LastRebuildTime = 0.f;
+		float m_LastAbstractSearchTime = 0.f;
+		float m_LastRefineTime = 0.f;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	HPAStar<T_NodeType, T_ConnectionType>::HPAStar(GridGraph<T_NodeType, T_ConnectionType>* pGraph, int clusterSize, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+		, m_ClusterSize(clusterSize)
+	{
+		assert(!pGraph->IsDirectionalGraph() && "<HPAStar>: the cached costs between entrances are used in both directions");
+
+		m_ListenerId = m_pGraph->AddConnectionChangedListener([this](int from, int to) { OnConnectionChanged(from, to); });
+
+		BuildAllClusters();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	HPAStar<T_NodeType, T_ConnectionType>::~HPAStar()
+	{
+		m_pGraph->RemoveConnectionChangedListener(m_ListenerId);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool HPAStar<T_NodeType, T_ConnectionType>::FindAbstractPath(int startIdx, int goalIdx, std::vector<int>& abstractPath)
+	{
+		UpdateDirtyClusters();
+
+		const auto searchStart = std::chrono::high_resolution_clock::now();
+		abstractPath.clear();
+
+		// The start and goal are connected to the entrances of their cluster for this query only
+		const int startCluster = GetClusterIdx(startIdx);
+		const int goalCluster = GetClusterIdx(goalIdx);
+
+		std::vector<AbstractEdge> startEdges{};
+		SearchCluster(startCluster, startIdx, invalid_node_index);
+		for (int nodeIdx : m_ClusterNodes[startCluster])
+		{
+			if (GetClusterCost(startCluster, nodeIdx) < FLT_MAX)
+				startEdges.push_back({ nodeIdx, GetClusterCost(startCluster, nodeIdx) });
+		}
+		if (startCluster == goalCluster && GetClusterCost(startCluster, goalIdx) < FLT_MAX)
+			startEdges.push_back({ goalIdx, GetClusterCost(startCluster, goalIdx) });
+
+		// Costs are symmetric, so the costs from the goal are the costs to the goal
+		std::unordered_map<int, float> goalCosts{};
+		SearchCluster(goalCluster, goalIdx, invalid_node_index);
+		for (int nodeIdx : m_ClusterNodes[goalCluster])
+		{
+			if (GetClusterCost(goalCluster, nodeIdx) < FLT_MAX)
+				goalCosts[nodeIdx] = GetClusterCost(goalCluster, nodeIdx);
+		}
+
+		std::unordered_map<int, AbstractRecord> records{};
+		std::vector<std::pair<float, int>> openList{};
+		const auto heapCompare = std::greater<std::pair<float, int>>();
+
+		records[startIdx] = AbstractRecord{};
+		openList.push_back({ GetHeuristicCost(startIdx, goalIdx), startIdx });
+
+		auto visitEdge = [&](int fromIdx, const AbstractEdge& edge)
+		{
+			const float costSoFar = records[fromIdx].costSoFar + edge.cost;
+			auto it = records.find(edge.to);
+			if (it != records.end() && it->second.costSoFar <= costSoFar)
+				return;
+
+			records[edge.to] = AbstractRecord{ fromIdx, costSoFar, false };
+			openList.push_back({ costSoFar + GetHeuristicCost(edge.to, goalIdx), edge.to });
+			std::push_heap(openList.begin(), openList.end(), heapCompare);
+		};
+
+		bool isGoalReached = false;
+		while (!openList.empty())
+		{
+			std::pop_heap(openList.begin(), openList.end(), heapCompare);
+			const int currentIdx = openList.back().second;
+			openList.pop_back();
+
+			AbstractRecord& currentRecord = records[currentIdx];
+			if (currentRecord.isClosed)
+				continue;
+			currentRecord.isClosed = true;
+
+			if (currentIdx == goalIdx)
+			{
+				isGoalReached = true;
+				break;
+			}
+
+			if (currentIdx == startIdx)
+			{
+				for (const AbstractEdge& edge : startEdges)
+					visitEdge(currentIdx, edge);
+			}
+
+			auto edgesIt = m_AbstractEdges.find(currentIdx);
+			if (edgesIt != m_AbstractEdges.end())
+			{
+				for (const AbstractEdge& edge : edgesIt->second)
+					visitEdge(currentIdx, edge);
+			}
+
+			auto goalCostIt = goalCosts.find(currentIdx);
+			if (goalCostIt != goalCosts.end())
+				visitEdge(currentIdx, AbstractEdge{ goalIdx, goalCostIt->second });
+		}
+
+		if (isGoalReached)
+		{
+			for (int idx = goalIdx; idx != startIdx; idx = records[idx].parentIdx)
+				abstractPath.push_back(idx);
+			abstractPath.push_back(startIdx);
+			std::reverse(abstractPath.begin(), abstractPath.end());
+		}
+
+		const auto searchEnd = std::chrono::high_resolution_clock::now();
+		m_LastAbstractSearchTime = std::chrono::duration<float, std::milli>(searchEnd - searchStart).count();
+
+		return isGoalReached;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RefineSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path)
+	{
+		const auto refineStart = std::chrono::high_resolution_clock::now();
+
+		// Segments between clusters are a single connection over the border
+		const int clusterIdx = GetClusterIdx(fromIdx);
+		if (clusterIdx != GetClusterIdx(toIdx))
+		{
+			path.push_back(m_pGraph->GetNode(toIdx));
+		}
+		else
+		{
+			SearchCluster(clusterIdx, fromIdx, toIdx);
+
+			const int firstIdx = (int)path.size();
+			const int originCol = clusterIdx % m_NrOfClustersX * m_ClusterSize;
+			const int originRow = clusterIdx / m_NrOfClustersX * m_ClusterSize;
+
+			for (int idx = toIdx; idx != fromIdx && idx != invalid_node_index;)
+			{
+				path.push_back(m_pGraph->GetNode(idx));
+
+				const Vector2 colRow = m_pGraph->GetNodePos(idx);
+				idx = m_ClusterParents[((int)colRow.y - originRow) * m_ClusterSize + (int)colRow.x - originCol];
+			}
+			std::reverse(path.begin() + firstIdx, path.end());
+		}
+
+		const auto refineEnd = std::chrono::high_resolution_clock::now();
+		m_LastRefineTime = std::chrono::duration<float, std::milli>(refineEnd - refineStart).count();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> HPAStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
+	{
+		std::vector<T_NodeType*> path{};
+		std::vector<int> abstractPath{};
+
+		if (!FindAbstractPath(pStartNode->GetIndex(), pGoalNode->GetIndex(), abstractPath))
+			return path;
+
+		float refineTime = 0.f;
+		path.push_back(pStartNode);
+		for (size_t i = 1; i < abstractPath.size(); ++i)
+		{
+			RefineSegment(abstractPath[i - 1], abstractPath[i], path);
+			refineTime += m_LastRefineTime;
+		}
+		m_LastRefineTime = refineTime;
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::UpdateDirtyClusters()
+	{
+		m_NrOfRebuiltClusters = 0;
+		if (m_DirtyClusters.empty() && !m_IsGraphCleared)
+			return;
+
+		const auto rebuildStart = std::chrono::high_resolution_clock::now();
+
+		if (m_IsGraphCleared)
+		{
+			BuildAllClusters();
+			m_NrOfRebuiltClusters = GetNrOfClusters();
+
+			const auto rebuildEnd = std::chrono::high_resolution_clock::now();
+			m_LastRebuildTime = std::chrono::duration<float, std::milli>(rebuildEnd - rebuildStart).count();
+			return;
+		}
+
+		// Entrances on the borders of a dirty cluster might have changed, the cluster on the other side
+		// only has to be rebuilt when they did
+		std::vector<int> clustersToRebuild = m_DirtyClusters;
+		for (int clusterIdx : m_DirtyClusters)
+			VisitBorders(clusterIdx, [&](int ownerIdx, Border border, bool) { RebuildBorder(ownerIdx, border, clustersToRebuild); });
+
+		std::sort(clustersToRebuild.begin(), clustersToRebuild.end());
+		clustersToRebuild.erase(std::unique(clustersToRebuild.begin(), clustersToRebuild.end()), clustersToRebuild.end());
+
+		for (int clusterIdx : clustersToRebuild)
+		{
+			RebuildCluster(clusterIdx);
+			m_IsClusterDirty[clusterIdx] = false;
+		}
+
+		m_DirtyClusters.clear();
+		m_NrOfRebuiltClusters = (int)clustersToRebuild.size();
+
+		const auto rebuildEnd = std::chrono::high_resolution_clock::now();
+		m_LastRebuildTime = std::chrono::duration<float, std::milli>(rebuildEnd - rebuildStart).count();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HPAStar<T_NodeType, T_ConnectionType>::GetNrOfAbstractEdges() const
+	{
+		int nrOfEdges = 0;
+		for (const auto& edges : m_AbstractEdges)
+			nrOfEdges += (int)edges.second.size();
+
+		return nrOfEdges;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HPAStar<T_NodeType, T_ConnectionType>::GetClusterIdx(int cellIdx) const
+	{
+		const Vector2 colRow = m_pGraph->GetNodePos(cellIdx);
+		return ((int)colRow.y / m_ClusterSize) * m_NrOfClustersX + (int)colRow.x / m_ClusterSize;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int HPAStar<T_NodeType, T_ConnectionType>::GetNeighborClusterIdx(int clusterIdx, Border border, bool isForward) const
+	{
+		// Offsets to the neighbor on the other side of the border, backward is from that neighbor to the owner
+		static const int offsetsX[m_NrOfBorders] = { 1, 0, 1, -1 };
+		static const int offsetsY[m_NrOfBorders] = { 0, 1, 1, 1 };
+
+		const int direction = isForward ? 1 : -1;
+		const int clusterX = clusterIdx % m_NrOfClustersX + offsetsX[int(border)] * direction;
+		const int clusterY = clusterIdx / m_NrOfClustersX + offsetsY[int(border)] * direction;
+		if (clusterX < 0 || clusterY < 0 || clusterX >= m_NrOfClustersX || clusterY >= m_NrOfClustersY)
+			return -1;
+
+		return clusterY * m_NrOfClustersX + clusterX;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <typename T_Visitor>
+	void HPAStar<T_NodeType, T_ConnectionType>::VisitBorders(int clusterIdx, T_Visitor visitor) const
+	{
+		for (Border border : { Border::Right, Border::Bottom, Border::BottomRight, Border::BottomLeft })
+		{
+			if (GetNeighborClusterIdx(clusterIdx, border, true) != -1)
+				visitor(clusterIdx, border, true);
+
+			const int ownerIdx = GetNeighborClusterIdx(clusterIdx, border, false);
+			if (ownerIdx != -1)
+				visitor(ownerIdx, border, false);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool HPAStar<T_NodeType, T_ConnectionType>::IsInCluster(int clusterIdx, int col, int row) const
+	{
+		const int originCol = clusterIdx % m_NrOfClustersX * m_ClusterSize;
+		const int originRow = clusterIdx / m_NrOfClustersX * m_ClusterSize;
+
+		return col >= originCol && col < originCol + m_ClusterSize
+			&& row >= originRow && row < originRow + m_ClusterSize
+			&& m_pGraph->IsWithinBounds(col, row);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::BuildAllClusters()
+	{
+		m_NrOfClustersX = (m_pGraph->GetColumns() + m_ClusterSize - 1) / m_ClusterSize;
+		m_NrOfClustersY = (m_pGraph->GetRows() + m_ClusterSize - 1) / m_ClusterSize;
+		m_ClusterCosts.resize(m_ClusterSize * m_ClusterSize);
+		m_ClusterParents.resize(m_ClusterSize * m_ClusterSize);
+		m_IsGraphCleared = false;
+
+		const int nrOfClusters = GetNrOfClusters();
+
+		m_BorderEntrances.assign(nrOfClusters * m_NrOfBorders, {});
+		m_ClusterNodes.assign(nrOfClusters, {});
+		m_AbstractEdges.clear();
+		m_IsClusterDirty.assign(nrOfClusters, false);
+		m_DirtyClusters.clear();
+
+		std::vector<int> changedClusters{};
+		for (int clusterIdx = 0; clusterIdx < nrOfClusters; ++clusterIdx)
+		{
+			for (Border border : { Border::Right, Border::Bottom, Border::BottomRight, Border::BottomLeft })
+				RebuildBorder(clusterIdx, border, changedClusters);
+		}
+
+		for (int clusterIdx = 0; clusterIdx < nrOfClusters; ++clusterIdx)
+			RebuildCluster(clusterIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RebuildBorder(int clusterIdx, Border border, std::vector<int>& changedClusters)
+	{
+		const int otherClusterIdx = GetNeighborClusterIdx(clusterIdx, border, true);
+		if (otherClusterIdx == -1)
+			return;
+
+		const int originCol = clusterIdx % m_NrOfClustersX * m_ClusterSize;
+		const int originRow = clusterIdx / m_NrOfClustersX * m_ClusterSize;
+
+		std::vector<Entrance> entrances{};
+
+		auto getEntrance = [&](int col, int row, int otherCol, int otherRow)
+		{
+			const int cellIdx = m_pGraph->GetIndex(col, row);
+			const int otherCellIdx = m_pGraph->GetIndex(otherCol, otherRow);
+
+			T_ConnectionType* pConnection = m_pGraph->GetConnection(cellIdx, otherCellIdx);
+			return Entrance{ cellIdx, otherCellIdx, pConnection ? pConnection->GetCost() : -1.f };
+		};
+
+		if (border == Border::BottomRight || border == Border::BottomLeft)
+		{
+			// A single diagonal connection between the corner cells
+			const bool isRight = border == Border::BottomRight;
+			const int col = isRight ? originCol + m_ClusterSize - 1 : originCol;
+			const int row = originRow + m_ClusterSize - 1;
+			const int otherCol = isRight ? col + 1 : col - 1;
+
+			if (m_pGraph->IsWithinBounds(otherCol, row + 1))
+			{
+				const Entrance entrance = getEntrance(col, row, otherCol, row + 1);
+				if (entrance.cost >= 0.f)
+					entrances.push_back(entrance);
+			}
+		}
+		else
+		{
+			// Walk along the last row/column of this cluster. Every cell can connect to three cells on the other side,
+			// connections whose cells on both sides are next to each other belong to the same run
+			const bool isVertical = border == Border::Bottom;
+			const int startCol = isVertical ? originCol : originCol + m_ClusterSize - 1;
+			const int startRow = isVertical ? originRow + m_ClusterSize - 1 : originRow;
+			const int stepCol = isVertical ? 1 : 0;
+			const int stepRow = isVertical ? 0 : 1;
+
+			std::vector<Entrance> run{};
+			int lastStep = -2;
+			int lastOtherStep = -2;
+
+			// Straight connections are preferred as entrances, diagonal ones are only used for runs without any
+			auto closeRun = [&]()
+			{
+				if (run.empty())
+					return;
+
+				std::vector<Entrance> candidates{};
+				for (const Entrance& entrance : run)
+				{
+					const Vector2 colRow = m_pGraph->GetNodePos(entrance.cellIdx);
+					const Vector2 otherColRow = m_pGraph->GetNodePos(entrance.otherCellIdx);
+					if (colRow.x == otherColRow.x || colRow.y == otherColRow.y)
+						candidates.push_back(entrance);
+				}
+				if (candidates.empty())
+					candidates = run;
+
+				if ((int)candidates.size() < m_MaxSingleEntranceLength)
+				{
+					entrances.push_back(candidates[candidates.size() / 2]);
+				}
+				else
+				{
+					entrances.push_back(candidates.front());
+					entrances.push_back(candidates.back());
+				}
+				run.clear();
+			};
+
+			for (int step = 0; step < m_ClusterSize; ++step)
+			{
+				const int col = startCol + step * stepCol;
+				const int row = startRow + step * stepRow;
+				if (!m_pGraph->IsWithinBounds(col, row))
+					break;
+
+				for (int offset = -1; offset <= 1; ++offset)
+				{
+					// Stay on the side of the neighbor, the cells past its ends belong to the corner borders
+					const int otherStep = step + offset;
+					const int otherCol = col + stepRow + offset * stepCol;
+					const int otherRow = row + stepCol + offset * stepRow;
+					if (otherStep < 0 || otherStep >= m_ClusterSize || !m_pGraph->IsWithinBounds(otherCol, otherRow))
+						continue;
+
+					const Entrance entrance = getEntrance(col, row, otherCol, otherRow);
+					if (entrance.cost < 0.f)
+						continue;
+
+					if (step - lastStep > 1 || abs(otherStep - lastOtherStep) > 1)
+						closeRun();
+
+					run.push_back(entrance);
+					lastStep = step;
+					lastOtherStep = otherStep;
+				}
+			}
+			closeRun();
+		}
+
+		std::vector<Entrance>& currentEntrances = m_BorderEntrances[GetBorderIdx(clusterIdx, border)];
+		if (currentEntrances == entrances)
+			return;
+
+		currentEntrances = entrances;
+		changedClusters.push_back(clusterIdx);
+		changedClusters.push_back(otherClusterIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::RebuildCluster(int clusterIdx)
+	{
+		for (int nodeIdx : m_ClusterNodes[clusterIdx])
+			m_AbstractEdges.erase(nodeIdx);
+
+		std::vector<int>& nodes = m_ClusterNodes[clusterIdx];
+		nodes.clear();
+
+		// Connections over the borders
+		VisitBorders(clusterIdx, [&](int ownerIdx, Border border, bool isOwner)
+		{
+			for (const Entrance& entrance : m_BorderEntrances[GetBorderIdx(ownerIdx, border)])
+			{
+				const int fromIdx = isOwner ? entrance.cellIdx : entrance.otherCellIdx;
+				const int toIdx = isOwner ? entrance.otherCellIdx : entrance.cellIdx;
+
+				if (std::find(nodes.begin(), nodes.end(), fromIdx) == nodes.end())
+					nodes.push_back(fromIdx);
+				m_AbstractEdges[fromIdx].push_back({ toIdx, entrance.cost });
+			}
+		});
+
+		// Cached costs between all entrances of the cluster
+		for (int nodeIdx : nodes)
+		{
+			SearchCluster(clusterIdx, nodeIdx, invalid_node_index);
+
+			for (int otherNodeIdx : nodes)
+			{
+				const float cost = GetClusterCost(clusterIdx, otherNodeIdx);
+				if (otherNodeIdx != nodeIdx && cost < FLT_MAX)
+					m_AbstractEdges[nodeIdx].push_back({ otherNodeIdx, cost });
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::OnConnectionChanged(int from, int to)
+	{
+		// Connections added while the grid is filled again are part of the full rebuild
+		if (from == invalid_node_index || m_IsGraphCleared)
+		{
+			m_IsGraphCleared = true;
+			return;
+		}
+
+		for (int clusterIdx : { GetClusterIdx(from), GetClusterIdx(to) })
+		{
+			if (m_IsClusterDirty[clusterIdx])
+				continue;
+
+			m_IsClusterDirty[clusterIdx] = true;
+			m_DirtyClusters.push_back(clusterIdx);
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void HPAStar<T_NodeType, T_ConnectionType>::SearchCluster(int clusterIdx, int sourceIdx, int targetIdx)
+	{
+		const int originCol = clusterIdx % m_NrOfClustersX * m_ClusterSize;
+		const int originRow = clusterIdx / m_NrOfClustersX * m_ClusterSize;
+		auto getLocalIdx = [&](int cellIdx)
+		{
+			const Vector2 colRow = m_pGraph->GetNodePos(cellIdx);
+			return ((int)colRow.y - originRow) * m_ClusterSize + (int)colRow.x - originCol;
+		};
+
+		std::fill(m_ClusterCosts.begin(), m_ClusterCosts.end(), FLT_MAX);
+		std::fill(m_ClusterParents.begin(), m_ClusterParents.end(), invalid_node_index);
+		m_ClusterOpenList.clear();
+
+		const auto heapCompare = std::greater<std::pair<float, int>>();
+		m_ClusterCosts[getLocalIdx(sourceIdx)] = 0.f;
+		m_ClusterOpenList.push_back({ 0.f, sourceIdx });
+
+		while (!m_ClusterOpenList.empty())
+		{
+			std::pop_heap(m_ClusterOpenList.begin(), m_ClusterOpenList.end(), heapCompare);
+			const std::pair<float, int> current = m_ClusterOpenList.back();
+			m_ClusterOpenList.pop_back();
+
+			if (current.first > m_ClusterCosts[getLocalIdx(current.second)])
+				continue;
+			if (current.second == targetIdx)
+				return;
+
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(current.second))
+			{
+				const Vector2 colRow = m_pGraph->GetNodePos(connection.to);
+				if (!IsInCluster(clusterIdx, (int)colRow.x, (int)colRow.y))
+					continue;
+
+				const int localIdx = getLocalIdx(connection.to);
+				const float cost = current.first + connection.cost;
+				if (cost >= m_ClusterCosts[localIdx])
+					continue;
+
+				m_ClusterCosts[localIdx] = cost;
+				m_ClusterParents[localIdx] = current.second;
+				m_ClusterOpenList.push_back({ cost, connection.to });
+				std::push_heap(m_ClusterOpenList.begin(), m_ClusterOpenList.end(), heapCompare);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float HPAStar<T_NodeType, T_ConnectionType>::GetClusterCost(int clusterIdx, int cellIdx) const
+	{
+		const int originCol = clusterIdx % m_NrOfClustersX * m_ClusterSize;
+		const int originRow = clusterIdx / m_NrOfClustersX * m_ClusterSize;
+		const Vector2 colRow = m_pGraph->GetNodePos(cellIdx);
+
+		return m_ClusterCosts[((int)colRow.y - originRow) * m_ClusterSize + (int)colRow.x - originCol];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float HPAStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+}
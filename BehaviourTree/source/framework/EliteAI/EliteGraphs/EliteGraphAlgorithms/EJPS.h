@@ -0,0 +1,518 @@
+#pragma once
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+
+namespace Elite
+{
+	// Jump Point Search on 8-connected grids where every straight and every diagonal connection has the same cost.
+	// A cell is blocked when it has no connections, diagonal moves past blocked corners are allowed (same as GridGraph).
+	// Grids that don't fit (weighted terrain, removed single connections, no diagonals) are searched with A* instead.
+	template <class T_NodeType, class T_ConnectionType>
+	class JPS
+	{
+	public:
+		JPS(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+
+		// Re-reads which cells are blocked and checks if the grid is uniform, call this after the graph changed.
+		// Clears the jump distances
+		void Refresh();
+
+		// JPS+: precomputes the jump distance of every cell in every direction, so searching doesn't have to scan the grid
+		void BakeJumpDistances();
+		bool HasJumpDistances() const { return !m_JumpDistances.empty(); }
+
+		// False when the grid isn't uniform, FindPath falls back to A* then
+		bool IsUniformGrid() const { return m_IsUniformGrid; }
+
+		// Without expanding, the path only holds the start, the jump points and the goal
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, bool expandPath = false);
+
+		// Amount of nodes that were expanded (moved to the closed list) during the last search
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		enum class NodeState : char
+		{
+			Unvisited,
+			Open,
+			Closed
+		};
+
+		struct JumpPointRecord
+		{
+			int parentIdx = invalid_node_index;
+			int direction = m_NoDirection; // direction the node was reached in
+			float costSoFar = 0.f;
+			float estimatedTotalCost = 0.f;
+			unsigned int generation = 0;
+			NodeState state = NodeState::Unvisited;
+		};
+
+		struct OpenListEntry
+		{
+			float estimatedTotalCost = 0.f;
+			unsigned int order = 0;
+			int nodeIdx = invalid_node_index;
+
+			bool operator>(const OpenListEntry& other) const
+			{
+				if (estimatedTotalCost != other.estimatedTotalCost)
+					return estimatedTotalCost > other.estimatedTotalCost;
+				return order > other.order;
+			};
+		};
+
+		// Straight directions first, then the diagonal ones, in the same order as GridGraph
+		static const int m_NrOfDirections = 8;
+		static const int m_NoDirection = -1;
+		static constexpr int m_DirectionCols[m_NrOfDirections] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+		static constexpr int m_DirectionRows[m_NrOfDirections] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+		// Direction of a (deltaCol, deltaRow) step, indexed by (deltaRow + 1) * 3 + deltaCol + 1
+		static constexpr int m_DirectionFromDelta[9] = { 6, 3, 7, 2, m_NoDirection, 0, 5, 1, 4 };
+
+		bool IsWalkable(int col, int row) const { return m_pGraph->IsWithinBounds(col, row) && m_IsWalkable[m_pGraph->GetIndex(col, row)]; }
+		bool IsDiagonal(int direction) const { return direction >= 4; }
+		int GetDirection(int deltaCol, int deltaRow) const;
+
+		bool HasForcedNeighbor(int col, int row, int direction) const;
+		int GetSuccessorDirections(int col, int row, int direction) const; // bitmask of directions to jump in
+
+		// Returns the amount of steps to the next jump point in the direction, or 0 if there is none
+		int Jump(int col, int row, int direction, int goalIdx) const;
+		int JumpStraight(int col, int row, int direction, int goalIdx) const;
+		int JumpWithDistances(int col, int row, int direction, int goalIdx) const;
+
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+		JumpPointRecord& GetRecord(int idx);
+		void ExpandSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path) const;
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		int m_NrOfExpandedNodes = 0;
+
+		bool m_IsUniformGrid = false;
+		float m_CostStraight = 0.f;
+		float m_CostDiagonal = 0.f;
+		std::vector<char> m_IsWalkable; // not a vector<bool>, this is read a lot while jumping
+
+		// JPS+ distances, nrOfNodes * 8: positive is the amount of steps to a jump point,
+		// zero or negative is minus the amount of free steps before running into a blocked cell
+		std::vector<int> m_JumpDistances;
+
+		std::vector<JumpPointRecord> m_Records;
+		std::vector<OpenListEntry> m_OpenList;
+		unsigned int m_Generation = 0;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	constexpr int JPS<T_NodeType, T_ConnectionType>::m_DirectionCols[];
+	template <class T_NodeType, class T_ConnectionType>
+	constexpr int JPS<T_NodeType, T_ConnectionType>::m_DirectionRows[];
+	template <class T_NodeType, class T_ConnectionType>
+	constexpr int JPS<T_NodeType, T_ConnectionType>::m_DirectionFromDelta[];
+
+	template <class T_NodeType, class T_ConnectionType>
+	JPS<T_NodeType, T_ConnectionType>::JPS(GridGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_pGraph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+		Refresh();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JPS<T_NodeType, T_ConnectionType>::Refresh()
+	{
+		const int nrOfNodes = m_pGraph->GetNrOfNodes();
+		const int columns = m_pGraph->GetColumns();
+
+		m_JumpDistances.clear();
+		m_IsWalkable.assign(nrOfNodes, false);
+		m_CostStraight = 0.f;
+		m_CostDiagonal = 0.f;
+		m_IsUniformGrid = true;
+
+		// Every connection has to go to an adjacent cell and cost the same as all others in that kind of direction
+		std::vector<unsigned char> connectedDirections(nrOfNodes, 0);
+		for (int idx = 0; idx < nrOfNodes && m_IsUniformGrid; ++idx)
+		{
+			for (const GraphEdge& connection : m_pGraph->GetNeighbors(idx))
+			{
+				const int direction = GetDirection(connection.to % columns - idx % columns, connection.to / columns - idx / columns);
+				if (direction == m_NoDirection)
+				{
+					m_IsUniformGrid = false;
+					break;
+				}
+
+				float& directionCost = IsDiagonal(direction) ? m_CostDiagonal : m_CostStraight;
+				if (directionCost == 0.f)
+					directionCost = connection.cost;
+				else if (directionCost != connection.cost)
+					m_IsUniformGrid = false;
+
+				connectedDirections[idx] |= 1 << direction;
+				m_IsWalkable[idx] = true;
+			}
+		}
+
+		// Pruning only holds when a diagonal step is cheaper than two straight ones and not cheaper than one
+		m_IsUniformGrid = m_IsUniformGrid
+			&& m_CostStraight > 0.f
+			&& m_CostDiagonal >= m_CostStraight
+			&& m_CostDiagonal < 2 * m_CostStraight;
+
+		// Two walkable adjacent cells always have to be connected, otherwise jumping over the gap would be wrong
+		for (int idx = 0; idx < nrOfNodes && m_IsUniformGrid; ++idx)
+		{
+			if (!m_IsWalkable[idx])
+				continue;
+
+			for (int direction = 0; direction < m_NrOfDirections; ++direction)
+			{
+				const bool isConnected = (connectedDirections[idx] & (1 << direction)) != 0;
+				if (isConnected != IsWalkable(idx % columns + m_DirectionCols[direction], idx / columns + m_DirectionRows[direction]))
+				{
+					m_IsUniformGrid = false;
+					break;
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JPS<T_NodeType, T_ConnectionType>::BakeJumpDistances()
+	{
+		if (!m_IsUniformGrid)
+			return;
+
+		const int columns = m_pGraph->GetColumns();
+		const int rows = m_pGraph->GetRows();
+		m_JumpDistances.assign(m_pGraph->GetNrOfNodes() * m_NrOfDirections, 0);
+
+		// Straight directions first, the diagonal distances depend on them. Cells are visited so that
+		// the next cell in the direction is always done before the current one
+		for (int direction = 0; direction < m_NrOfDirections; ++direction)
+		{
+			const int deltaCol = m_DirectionCols[direction];
+			const int deltaRow = m_DirectionRows[direction];
+
+			for (int r = 0; r < rows; ++r)
+			{
+				const int row = deltaRow > 0 ? rows - 1 - r : r;
+				for (int c = 0; c < columns; ++c)
+				{
+					const int col = deltaCol > 0 ? columns - 1 - c : c;
+					const int nextCol = col + deltaCol;
+					const int nextRow = row + deltaRow;
+
+					if (!IsWalkable(col, row) || !IsWalkable(nextCol, nextRow))
+						continue;
+
+					bool isJumpPoint = HasForcedNeighbor(nextCol, nextRow, direction);
+					if (IsDiagonal(direction))
+					{
+						const int nextIdx = m_pGraph->GetIndex(nextCol, nextRow) * m_NrOfDirections;
+						isJumpPoint = isJumpPoint
+							|| m_JumpDistances[nextIdx + GetDirection(deltaCol, 0)] > 0
+							|| m_JumpDistances[nextIdx + GetDirection(0, deltaRow)] > 0;
+					}
+
+					const int nextDistance = m_JumpDistances[m_pGraph->GetIndex(nextCol, nextRow) * m_NrOfDirections + direction];
+					int& distance = m_JumpDistances[m_pGraph->GetIndex(col, row) * m_NrOfDirections + direction];
+
+					if (isJumpPoint)
+						distance = 1;
+					else if (nextDistance > 0)
+						distance = nextDistance + 1;
+					else
+						distance = nextDistance - 1;
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JPS<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, bool expandPath)
+	{
+		if (!m_IsUniformGrid)
+		{
+			auto aStar = AStar<T_NodeType, T_ConnectionType>(m_pGraph, m_HeuristicFunction);
+			auto path = aStar.FindPath(pStartNode, pGoalNode);
+			m_NrOfExpandedNodes = aStar.GetNrOfExpandedNodes();
+			return path;
+		}
+
+		const int columns = m_pGraph->GetColumns();
+		const int startIdx = pStartNode->GetIndex();
+		const int goalIdx = pGoalNode->GetIndex();
+
+		m_NrOfExpandedNodes = 0;
+		m_OpenList.clear();
+		if ((int)m_Records.size() < m_pGraph->GetNrOfNodes())
+			m_Records.resize(m_pGraph->GetNrOfNodes());
+
+		// Records of older searches count as unvisited
+		if (++m_Generation == 0)
+		{
+			for (auto& record : m_Records)
+				record.generation = 0;
+			m_Generation = 1;
+		}
+
+		const auto heapCompare = std::greater<OpenListEntry>();
+		unsigned int insertionOrder = 0;
+
+		JumpPointRecord& startRecord = GetRecord(startIdx);
+		startRecord.estimatedTotalCost = GetHeuristicCost(startIdx, goalIdx);
+		startRecord.state = NodeState::Open;
+		m_OpenList.push_back({ startRecord.estimatedTotalCost, insertionOrder++, startIdx });
+
+		bool isGoalReached = false;
+		while (!m_OpenList.empty())
+		{
+			std::pop_heap(m_OpenList.begin(), m_OpenList.end(), heapCompare);
+			const OpenListEntry currentEntry = m_OpenList.back();
+			m_OpenList.pop_back();
+
+			JumpPointRecord& currentRecord = GetRecord(currentEntry.nodeIdx);
+			if (currentRecord.state != NodeState::Open || currentEntry.estimatedTotalCost != currentRecord.estimatedTotalCost)
+				continue;
+
+			if (currentEntry.nodeIdx == goalIdx)
+			{
+				isGoalReached = true;
+				break;
+			}
+
+			currentRecord.state = NodeState::Closed;
+			++m_NrOfExpandedNodes;
+
+			const int col = currentEntry.nodeIdx % columns;
+			const int row = currentEntry.nodeIdx / columns;
+			const int successorDirections = GetSuccessorDirections(col, row, currentRecord.direction);
+
+			for (int direction = 0; direction < m_NrOfDirections; ++direction)
+			{
+				if (!(successorDirections & (1 << direction)))
+					continue;
+
+				const int nrOfSteps = HasJumpDistances()
+					? JumpWithDistances(col, row, direction, goalIdx)
+					: Jump(col, row, direction, goalIdx);
+
+				if (nrOfSteps == 0)
+					continue;
+
+				const int nextIdx = m_pGraph->GetIndex(col + nrOfSteps * m_DirectionCols[direction], row + nrOfSteps * m_DirectionRows[direction]);
+				const float costSoFar = currentRecord.costSoFar + nrOfSteps * (IsDiagonal(direction) ? m_CostDiagonal : m_CostStraight);
+
+				JumpPointRecord& nextRecord = GetRecord(nextIdx);
+				if (nextRecord.state != NodeState::Unvisited && nextRecord.costSoFar <= costSoFar)
+					continue;
+
+				nextRecord.parentIdx = currentEntry.nodeIdx;
+				nextRecord.direction = direction;
+				nextRecord.costSoFar = costSoFar;
+				nextRecord.estimatedTotalCost = costSoFar + GetHeuristicCost(nextIdx, goalIdx);
+				nextRecord.state = NodeState::Open;
+
+				m_OpenList.push_back({ nextRecord.estimatedTotalCost, insertionOrder++, nextIdx });
+				std::push_heap(m_OpenList.begin(), m_OpenList.end(), heapCompare);
+			}
+		}
+
+		std::vector<T_NodeType*> path;
+		if (!isGoalReached)
+			return path;
+
+		// Jump points are traced back from the goal, the start record has no parent
+		for (int idx = goalIdx; idx != startIdx; idx = GetRecord(idx).parentIdx)
+		{
+			if (expandPath)
+				ExpandSegment(idx, GetRecord(idx).parentIdx, path);
+			else
+				path.push_back(m_pGraph->GetNode(idx));
+		}
+
+		path.push_back(pStartNode);
+		std::reverse(path.begin(), path.end());
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::GetDirection(int deltaCol, int deltaRow) const
+	{
+		if (abs(deltaCol) > 1 || abs(deltaRow) > 1)
+			return m_NoDirection;
+
+		return m_DirectionFromDelta[(deltaRow + 1) * 3 + deltaCol + 1];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool JPS<T_NodeType, T_ConnectionType>::HasForcedNeighbor(int col, int row, int direction) const
+	{
+		const int deltaCol = m_DirectionCols[direction];
+		const int deltaRow = m_DirectionRows[direction];
+
+		if (IsDiagonal(direction))
+		{
+			return (!IsWalkable(col - deltaCol, row) && IsWalkable(col - deltaCol, row + deltaRow))
+				|| (!IsWalkable(col, row - deltaRow) && IsWalkable(col + deltaCol, row - deltaRow));
+		}
+
+		// Perpendicular to the direction
+		const int sideCol = deltaRow;
+		const int sideRow = deltaCol;
+
+		return (!IsWalkable(col + sideCol, row + sideRow) && IsWalkable(col + sideCol + deltaCol, row + sideRow + deltaRow))
+			|| (!IsWalkable(col - sideCol, row - sideRow) && IsWalkable(col - sideCol + deltaCol, row - sideRow + deltaRow));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::GetSuccessorDirections(int col, int row, int direction) const
+	{
+		// The start node looks in every direction
+		if (direction == m_NoDirection)
+			return (1 << m_NrOfDirections) - 1;
+
+		const int deltaCol = m_DirectionCols[direction];
+		const int deltaRow = m_DirectionRows[direction];
+		int directions = 1 << direction;
+
+		if (IsDiagonal(direction))
+		{
+			directions |= 1 << GetDirection(deltaCol, 0);
+			directions |= 1 << GetDirection(0, deltaRow);
+
+			if (!IsWalkable(col - deltaCol, row))
+				directions |= 1 << GetDirection(-deltaCol, deltaRow);
+			if (!IsWalkable(col, row - deltaRow))
+				directions |= 1 << GetDirection(deltaCol, -deltaRow);
+
+			return directions;
+		}
+
+		// Blocked cells next to a straight move force the diagonals around them
+		const int sideCol = deltaRow;
+		const int sideRow = deltaCol;
+
+		if (!IsWalkable(col + sideCol, row + sideRow))
+			directions |= 1 << GetDirection(deltaCol + sideCol, deltaRow + sideRow);
+		if (!IsWalkable(col - sideCol, row - sideRow))
+			directions |= 1 << GetDirection(deltaCol - sideCol, deltaRow - sideRow);
+
+		return directions;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::Jump(int col, int row, int direction, int goalIdx) const
+	{
+		if (!IsDiagonal(direction))
+			return JumpStraight(col, row, direction, goalIdx);
+
+		const int deltaCol = m_DirectionCols[direction];
+		const int deltaRow = m_DirectionRows[direction];
+		const int horizontal = GetDirection(deltaCol, 0);
+		const int vertical = GetDirection(0, deltaRow);
+
+		for (int nrOfSteps = 1; ; ++nrOfSteps)
+		{
+			col += deltaCol;
+			row += deltaRow;
+
+			if (!IsWalkable(col, row))
+				return 0;
+
+			// A diagonal step also stops where a straight jump from it would find something
+			if (m_pGraph->GetIndex(col, row) == goalIdx
+				|| HasForcedNeighbor(col, row, direction)
+				|| JumpStraight(col, row, horizontal, goalIdx) > 0
+				|| JumpStraight(col, row, vertical, goalIdx) > 0)
+				return nrOfSteps;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::JumpStraight(int col, int row, int direction, int goalIdx) const
+	{
+		const int deltaCol = m_DirectionCols[direction];
+		const int deltaRow = m_DirectionRows[direction];
+
+		for (int nrOfSteps = 1; ; ++nrOfSteps)
+		{
+			col += deltaCol;
+			row += deltaRow;
+
+			if (!IsWalkable(col, row))
+				return 0;
+
+			if (m_pGraph->GetIndex(col, row) == goalIdx || HasForcedNeighbor(col, row, direction))
+				return nrOfSteps;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JPS<T_NodeType, T_ConnectionType>::JumpWithDistances(int col, int row, int direction, int goalIdx) const
+	{
+		const int distance = m_JumpDistances[m_pGraph->GetIndex(col, row) * m_NrOfDirections + direction];
+		const int maxNrOfSteps = abs(distance);
+
+		const int deltaCol = m_DirectionCols[direction];
+		const int deltaRow = m_DirectionRows[direction];
+		const int goalDeltaCol = goalIdx % m_pGraph->GetColumns() - col;
+		const int goalDeltaRow = goalIdx / m_pGraph->GetColumns() - row;
+
+		// Goal check: the distances don't know the goal, so stop where the segment passes or lines up with it
+		if (IsDiagonal(direction))
+		{
+			if (goalDeltaCol * deltaCol > 0 && goalDeltaRow * deltaRow > 0)
+			{
+				const int nrOfSteps = std::min(abs(goalDeltaCol), abs(goalDeltaRow));
+				if (nrOfSteps <= maxNrOfSteps)
+					return nrOfSteps;
+			}
+		}
+		else if (goalDeltaCol * deltaRow == 0 && goalDeltaRow * deltaCol == 0
+			&& goalDeltaCol * deltaCol + goalDeltaRow * deltaRow > 0)
+		{
+			const int nrOfSteps = abs(goalDeltaCol + goalDeltaRow);
+			if (nrOfSteps <= maxNrOfSteps)
+				return nrOfSteps;
+		}
+
+		return distance > 0 ? distance : 0;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	float JPS<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		Vector2 toDestination = m_pGraph->GetNodePos(toIdx) - m_pGraph->GetNodePos(fromIdx);
+		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	typename JPS<T_NodeType, T_ConnectionType>::JumpPointRecord& JPS<T_NodeType, T_ConnectionType>::GetRecord(int idx)
+	{
+		JumpPointRecord& record = m_Records[idx];
+		if (record.generation != m_Generation)
+		{
+			record = JumpPointRecord{};
+			record.generation = m_Generation;
+		}
+		return record;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JPS<T_NodeType, T_ConnectionType>::ExpandSegment(int fromIdx, int toIdx, std::vector<T_NodeType*>& path) const
+	{
+		// Segments between jump points are always straight or diagonal lines, every cell on them is added except toIdx
+		const int columns = m_pGraph->GetColumns();
+		const int deltaCol = (toIdx % columns > fromIdx % columns) - (toIdx % columns < fromIdx % columns);
+		const int deltaRow = (toIdx / columns > fromIdx / columns) - (toIdx / columns < fromIdx / columns);
+
+		for (int idx = fromIdx; idx != toIdx; idx += deltaRow * columns + deltaCol)
+			path.push_back(m_pGraph->GetNode(idx));
+	}
+}
@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "ELandmarks.h"
+#include "framework\EliteHelpers\EBinaryStream.h"
+
+using namespace Elite;
+
+namespace
+{
+	// First bytes of a landmarks file, bumped when the layout changes
+	const char LANDMARKS_FILE_TAG[4] = { 'A', 'L', 'T', '2' };
+}
+
+bool Landmarks::Save(const std::string& filePath) const
+{
+	std::ofstream file(filePath, std::ios::out | std::ios::binary);
+	if (!file)
+	{
+		std::cout << "<Landmarks::Save>: can't open " << filePath << std::endl;
+		return false;
+	}
+
+	file.write(LANDMARKS_FILE_TAG, sizeof(LANDMARKS_FILE_TAG));
+	WriteBinary(file, m_NrOfLandmarks);
+	WriteBinary(file, m_NrOfNodes);
+	WriteBinary(file, m_GraphHash);
+	WriteBinaryArray(file, m_LandmarkNodes);
+	WriteBinaryArray(file, m_Distances);
+
+	return file.good();
+}
+
+bool Landmarks::Load(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::in | std::ios::binary);
+	if (!file)
+		return false;
+
+	char tag[sizeof(LANDMARKS_FILE_TAG)]{};
+	int nrOfLandmarks = 0;
+	int nrOfNodes = 0;
+	uint64_t graphHash = 0;
+
+	file.read(tag, sizeof(tag));
+	if (!file || !std::equal(std::begin(tag), std::end(tag), std::begin(LANDMARKS_FILE_TAG))
+		|| !ReadBinary(file, nrOfLandmarks) || !ReadBinary(file, nrOfNodes) || !ReadBinary(file, graphHash)
+		|| nrOfLandmarks < 0 || nrOfNodes < 0)
+	{
+		std::cout << "<Landmarks::Load>: " << filePath << " is not a landmarks file of this version" << std::endl;
+		return false;
+	}
+
+	//The arrays are only allocated when the file has that many bytes left, their sizes have to match the header
+	std::vector<int> landmarkNodes{};
+	std::vector<float> distances{};
+	if (!ReadBinaryArray(file, landmarkNodes) || !ReadBinaryArray(file, distances)
+		|| (int)landmarkNodes.size() != nrOfLandmarks
+		|| (int64_t)distances.size() != (int64_t)nrOfNodes * nrOfLandmarks
+		|| std::any_of(landmarkNodes.begin(), landmarkNodes.end(), [nrOfNodes](int idx) { return idx < 0 || idx >= nrOfNodes; }))
+	{
+		std::cout << "<Landmarks::Load>: " << filePath << " is incomplete or corrupt" << std::endl;
+		return false;
+	}
+
+	m_NrOfLandmarks = nrOfLandmarks;
+	m_NrOfNodes = nrOfNodes;
+	m_GraphHash = graphHash;
+	m_LandmarkNodes = std::move(landmarkNodes);
+	m_Distances = std::move(distances);
+
+	return true;
+}
+
+float Landmarks::GetLowerBound(int fromIdx, int toIdx) const
+{
+	const float* pFromDistances = GetDistances(fromIdx);
+	const float* pToDistances = GetDistances(toIdx);
+	if (!pFromDistances || !pToDistances)
+		return 0.f;
+
+	return GetLowerBound(pFromDistances, pToDistances, m_NrOfLandmarks);
+}
+
+float Landmarks::GetLowerBound(const float* pFromDistances, const float* pToDistances, int nrOfLandmarks) const
+{
+	float lowerBound = 0.f;
+	for (int landmark = 0; landmark < nrOfLandmarks; ++landmark)
+	{
+		if (pFromDistances[landmark] == FLT_MAX || pToDistances[landmark] == FLT_MAX)
+			continue;
+
+		lowerBound = std::max(lowerBound, abs(pToDistances[landmark] - pFromDistances[landmark]));
+	}
+
+	return lowerBound;
+}
+
+const float* Landmarks::GetDistances(int idx) const
+{
+	if (idx < 0 || idx >= m_NrOfNodes || m_NrOfLandmarks == 0)
+		return nullptr;
+
+	return &m_Distances[idx * m_NrOfLandmarks];
+}
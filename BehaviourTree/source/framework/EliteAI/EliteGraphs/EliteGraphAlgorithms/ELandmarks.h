@@ -0,0 +1,199 @@
+/*=============================================================================*/
+// ELandmarks.h: Landmark (ALT) lower bounds for A* on undirected graphs.
+// The shortest distance from a few landmark nodes to every node is stored, by the
+// triangle inequality |d(L, to) - d(L, from)| never overestimates the cost from -> to.
+// Unlike the geometric heuristics this knows about detours around obstacles.
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+
+namespace Elite
+{
+	class Landmarks final
+	{
+	public:
+		Landmarks() = default;
+
+		// Picks the landmarks (farthest point selection) and runs Dijkstra from each of them
+		template <class T_NodeType, class T_ConnectionType>
+		void Build(const IGraph<T_NodeType, T_ConnectionType>& graph, int nrOfLandmarks);
+
+		// Tables of another graph (or an older version of it) can't be used, their distances could overestimate.
+		// Compares a hash of the nodes and connections with the one of the graph the tables were built for
+		template <class T_NodeType, class T_ConnectionType>
+		bool IsBuiltFor(const IGraph<T_NodeType, T_ConnectionType>& graph) const;
+
+		// Binary file, Load returns false (and keeps the current tables) when the file is missing or invalid
+		bool Save(const std::string& filePath) const;
+		bool Load(const std::string& filePath);
+
+		// Admissible estimate of the cost from -> to, 0 when either node is unknown
+		float GetLowerBound(int fromIdx, int toIdx) const;
+		// Same, for distances that aren't in the tables (e.g. of nodes added on top of the graph, see GraphOverlay).
+		// Only the first nrOfLandmarks landmarks are compared
+		float GetLowerBound(const float* pFromDistances, const float* pToDistances, int nrOfLandmarks) const;
+
+		// Distances from every landmark to the node, nullptr when it isn't known
+		const float* GetDistances(int idx) const;
+
+		int GetNrOfLandmarks() const { return m_NrOfLandmarks; }
+		const std::vector<int>& GetLandmarkNodes() const { return m_LandmarkNodes; }
+
+	private:
+		template <class T_NodeType, class T_ConnectionType>
+		static void CalculateDistances(const IGraph<T_NodeType, T_ConnectionType>& graph, int sourceIdx, std::vector<float>& distances);
+
+		// The order of the connections of a node doesn't matter, the same graph loaded again gets the same hash
+		template <class T_NodeType, class T_ConnectionType>
+		static uint64_t CalculateGraphHash(const IGraph<T_NodeType, T_ConnectionType>& graph);
+
+		int m_NrOfLandmarks = 0;
+		int m_NrOfNodes = 0;
+		uint64_t m_GraphHash = 0;
+
+		std::vector<int> m_LandmarkNodes;
+		std::vector<float> m_Distances; // per node, the distances of all landmarks next to each other (FLT_MAX when unreachable)
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	void Landmarks::Build(const IGraph<T_NodeType, T_ConnectionType>& graph, int nrOfLandmarks)
+	{
+		assert(!graph.IsDirectionalGraph() && "<Landmarks::Build>: distances from a landmark are used as distances to it");
+
+		m_NrOfNodes = graph.GetNrOfNodes();
+		m_GraphHash = CalculateGraphHash(graph);
+		m_NrOfLandmarks = 0;
+		m_LandmarkNodes.clear();
+
+		int firstIdx = 0;
+		while (firstIdx < m_NrOfNodes && !graph.IsNodeValid(firstIdx))
+			++firstIdx;
+
+		if (firstIdx == m_NrOfNodes || nrOfLandmarks <= 0)
+		{
+			m_Distances.clear();
+			return;
+		}
+
+		// Smallest distance to any landmark so far, the next landmark is the node farthest away from all of them.
+		// The first one is the node farthest away from an arbitrary node
+		std::vector<float> distances{};
+		CalculateDistances(graph, firstIdx, distances);
+		std::vector<float> closestLandmarkDistance = distances;
+
+		std::vector<std::vector<float>> landmarkDistances{};
+		for (int landmark = 0; landmark < nrOfLandmarks; ++landmark)
+		{
+			int farthestIdx = invalid_node_index;
+			float farthestDistance = 0.f;
+			for (int idx = 0; idx < m_NrOfNodes; ++idx)
+			{
+				const float distance = closestLandmarkDistance[idx];
+				if (distance != FLT_MAX && distance > farthestDistance)
+				{
+					farthestDistance = distance;
+					farthestIdx = idx;
+				}
+			}
+
+			// Every reachable node already is a landmark
+			if (farthestIdx == invalid_node_index)
+				break;
+
+			CalculateDistances(graph, farthestIdx, distances);
+			for (int idx = 0; idx < m_NrOfNodes; ++idx)
+				closestLandmarkDistance[idx] = std::min(closestLandmarkDistance[idx], distances[idx]);
+
+			m_LandmarkNodes.push_back(farthestIdx);
+			landmarkDistances.push_back(distances);
+		}
+
+		m_NrOfLandmarks = (int)m_LandmarkNodes.size();
+		m_Distances.resize(m_NrOfNodes * m_NrOfLandmarks);
+		for (int idx = 0; idx < m_NrOfNodes; ++idx)
+		{
+			for (int landmark = 0; landmark < m_NrOfLandmarks; ++landmark)
+				m_Distances[idx * m_NrOfLandmarks + landmark] = landmarkDistances[landmark][idx];
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool Landmarks::IsBuiltFor(const IGraph<T_NodeType, T_ConnectionType>& graph) const
+	{
+		return m_NrOfLandmarks > 0
+			&& m_NrOfNodes == graph.GetNrOfNodes()
+			&& m_GraphHash == CalculateGraphHash(graph);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void Landmarks::CalculateDistances(const IGraph<T_NodeType, T_ConnectionType>& graph, int sourceIdx, std::vector<float>& distances)
+	{
+		distances.assign(graph.GetNrOfNodes(), FLT_MAX);
+		distances[sourceIdx] = 0.f;
+
+		std::vector<std::pair<float, int>> openList{ { 0.f, sourceIdx } };
+		const auto heapCompare = std::greater<std::pair<float, int>>();
+
+		while (!openList.empty())
+		{
+			std::pop_heap(openList.begin(), openList.end(), heapCompare);
+			const std::pair<float, int> current = openList.back();
+			openList.pop_back();
+
+			if (current.first > distances[current.second])
+				continue;
+
+			for (const GraphEdge& connection : graph.GetNeighbors(current.second))
+			{
+				const float distance = current.first + connection.cost;
+				if (distance >= distances[connection.to])
+					continue;
+
+				distances[connection.to] = distance;
+				openList.push_back({ distance, connection.to });
+				std::push_heap(openList.begin(), openList.end(), heapCompare);
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	uint64_t Landmarks::CalculateGraphHash(const IGraph<T_NodeType, T_ConnectionType>& graph)
+	{
+		//FNV-1a over the valid nodes, each with the sum of the hashes of its connections
+		uint64_t hash = 14695981039346656037ull;
+		const auto addToHash = [&hash](uint64_t value)
+		{
+			for (int byte = 0; byte < 8; ++byte)
+			{
+				hash ^= (value >> (byte * 8)) & 0xff;
+				hash *= 1099511628211ull;
+			}
+		};
+
+		addToHash(static_cast<uint64_t>(graph.GetNrOfNodes()));
+		for (int idx = 0; idx < graph.GetNrOfNodes(); ++idx)
+		{
+			if (!graph.IsNodeValid(idx))
+				continue;
+
+			uint64_t connectionsHash = 0;
+			for (const GraphEdge& connection : graph.GetNeighbors(idx))
+			{
+				uint32_t costBits;
+				memcpy(&costBits, &connection.cost, sizeof(costBits));
+
+				//Mixed (splitmix64) so that the sum doesn't cancel out
+				uint64_t connectionHash = (static_cast<uint64_t>(connection.to) << 32 | costBits) + 0x9e3779b97f4a7c15ull;
+				connectionHash = (connectionHash ^ (connectionHash >> 30)) * 0xbf58476d1ce4e5b9ull;
+				connectionHash = (connectionHash ^ (connectionHash >> 27)) * 0x94d049bb133111ebull;
+				connectionsHash += connectionHash ^ (connectionHash >> 31);
+			}
+
+			addToHash(static_cast<uint64_t>(idx));
+			addToHash(connectionsHash);
+		}
+
+		return hash;
+	}
+}
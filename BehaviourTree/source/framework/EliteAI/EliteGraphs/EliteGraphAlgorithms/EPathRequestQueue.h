@@ -0,0 +1,346 @@
+/*=============================================================================*/
+// EPathRequestQueue.h: Solves path requests of many agents on worker threads.
+// Requests search a baked snapshot (CSRGraph) that is shared with the queue and must not be
+// changed anymore, bake a new snapshot when the graph changes instead. Every worker has its own
+// search context. Results become available through the request handle after the next Update.
+// Every handle has to be polled until its result is taken or be cancelled, otherwise its result is kept.
+/*=============================================================================*/
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "framework/EliteAI/EliteGraphs/ECSRGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+
+namespace Elite
+{
+	enum class PathRequestStatus
+	{
+		Pending,
+		Found,
+		NotFound,
+		InvalidHandle // never requested or the result was already taken
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	class PathRequestQueue final
+	{
+	public:
+		using GraphSnapshot = std::shared_ptr<CSRGraph<T_NodeType>>;
+
+		PathRequestQueue(int nrOfThreads, Heuristic hFunction);
+		~PathRequestQueue();
+
+		// Returns the handle to poll the result with. Requests with the same snapshot, start and goal as one
+		// that isn't delivered yet share its search. Higher priorities are solved first
+		int RequestPath(const GraphSnapshot& pGraph, int startIdx, int goalIdx, int priority = 0);
+
+		// Found and NotFound hand over the result (node indices) and free the handle
+		PathRequestStatus GetResult(int handle, std::vector<int>& path);
+
+		// Frees the handle without taking the result. A request no other handle shares is dropped when it wasn't
+		// started yet, a running search finishes but its result is thrown away. False for invalid handles
+		bool CancelRequest(int handle);
+
+		// Call once per frame: delivers the paths solved since the last call and starts a new budget
+		void Update();
+
+		// Workers don't start new searches once the searches of this frame took this long or expanded
+		// this many nodes (0 = no limit). A search that already started always finishes
+		void SetFrameBudget(float maxMilliseconds, int maxExpandedNodes);
+
+		// Stats
+		int GetNrOfPendingRequests() const;
+		int GetNrOfDeliveredRequests() const { return m_NrOfDeliveredRequests; } // during the last Update
+		int GetNrOfDeduplicatedRequests() const { return m_NrOfDeduplicatedRequests; } // in total
+		float GetAverageLatency() const { return m_AverageLatency; } // ms between request and delivery, last Update
+		float GetMaxLatency() const { return m_MaxLatency; } // in total
+
+	private:
+		struct Request
+		{
+			GraphSnapshot pGraph;
+			int startIdx = invalid_node_index;
+			int goalIdx = invalid_node_index;
+			int priority = 0;
+			unsigned int order = 0; // first requested wins on equal priorities
+
+			std::chrono::high_resolution_clock::time_point requestTime;
+			std::vector<int> path;
+			bool isFound = false;
+			bool isDelivered = false;
+			int nrOfHandles = 0;
+		};
+
+		using RequestPtr = std::shared_ptr<Request>;
+
+		struct RequestKey
+		{
+			const CSRGraph<T_NodeType>* pGraph;
+			int startIdx;
+			int goalIdx;
+
+			bool operator<(const RequestKey& other) const
+			{
+				return std::tie(pGraph, startIdx, goalIdx) < std::tie(other.pGraph, other.startIdx, other.goalIdx);
+			}
+		};
+
+		static bool HasLowerPriority(const RequestPtr& pFirst, const RequestPtr& pSecond)
+		{
+			if (pFirst->priority != pSecond->priority)
+				return pFirst->priority < pSecond->priority;
+			return pFirst->order > pSecond->order;
+		}
+
+		void RunWorker();
+		bool IsBudgetSpent() const;
+
+		Heuristic m_HeuristicFunction;
+		std::vector<std::thread> m_Workers;
+		bool m_IsStopping = false;
+
+		// Everything below is guarded by the mutex
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_RequestAvailable;
+
+		std::vector<RequestPtr> m_PendingRequests; // heap on priority
+		std::vector<RequestPtr> m_SolvedRequests; // waiting for the next Update
+		std::map<RequestKey, RequestPtr> m_UndeliveredRequests;
+		std::unordered_map<int, RequestPtr> m_Handles;
+		int m_NextHandle = 0;
+		unsigned int m_NextOrder = 0;
+
+		float m_MaxFrameMilliseconds = 0.f;
+		int m_MaxFrameExpandedNodes = 0;
+		float m_FrameMilliseconds = 0.f;
+		int m_FrameExpandedNodes = 0;
+
+		int m_NrOfDeliveredRequests = 0;
+		int m_NrOfDeduplicatedRequests = 0;
+		float m_AverageLatency = 0.f;
+		float m_MaxLatency = 0.f;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRequestQueue<T_NodeType, T_ConnectionType>::PathRequestQueue(int nrOfThreads, Heuristic hFunction)
+		: m_HeuristicFunction(hFunction)
+	{
+		assert(nrOfThreads > 0 && "<PathRequestQueue>: at least one worker is needed");
+
+		for (int i = 0; i < nrOfThreads; ++i)
+			m_Workers.emplace_back(&PathRequestQueue::RunWorker, this);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRequestQueue<T_NodeType, T_ConnectionType>::~PathRequestQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_RequestAvailable.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int PathRequestQueue<T_NodeType, T_ConnectionType>::RequestPath(const GraphSnapshot& pGraph, int startIdx, int goalIdx, int priority)
+	{
+		assert(pGraph && pGraph->IsNodeValid(startIdx) && pGraph->IsNodeValid(goalIdx) && "<PathRequestQueue::RequestPath>: invalid request");
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		const int handle = m_NextHandle++;
+
+		auto it = m_UndeliveredRequests.find(RequestKey{ pGraph.get(), startIdx, goalIdx });
+		if (it != m_UndeliveredRequests.end())
+		{
+			RequestPtr pRequest = it->second;
+			++pRequest->nrOfHandles;
+			m_Handles[handle] = pRequest;
+			++m_NrOfDeduplicatedRequests;
+
+			// A shared request that is still waiting is solved as soon as the most urgent of its requesters needs it
+			if (priority > pRequest->priority && std::find(m_PendingRequests.begin(), m_PendingRequests.end(), pRequest) != m_PendingRequests.end())
+			{
+				pRequest->priority = priority;
+				std::make_heap(m_PendingRequests.begin(), m_PendingRequests.end(), HasLowerPriority);
+			}
+
+			return handle;
+		}
+
+		RequestPtr pRequest = std::make_shared<Request>();
+		pRequest->pGraph = pGraph;
+		pRequest->startIdx = startIdx;
+		pRequest->goalIdx = goalIdx;
+		pRequest->priority = priority;
+		pRequest->order = m_NextOrder++;
+		pRequest->requestTime = std::chrono::high_resolution_clock::now();
+		pRequest->nrOfHandles = 1;
+
+		m_Handles[handle] = pRequest;
+		m_UndeliveredRequests[RequestKey{ pGraph.get(), startIdx, goalIdx }] = pRequest;
+		m_PendingRequests.push_back(pRequest);
+		std::push_heap(m_PendingRequests.begin(), m_PendingRequests.end(), HasLowerPriority);
+
+		lock.unlock();
+		m_RequestAvailable.notify_one();
+
+		return handle;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	PathRequestStatus PathRequestQueue<T_NodeType, T_ConnectionType>::GetResult(int handle, std::vector<int>& path)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto it = m_Handles.find(handle);
+		if (it == m_Handles.end())
+			return PathRequestStatus::InvalidHandle;
+
+		RequestPtr pRequest = it->second;
+		if (!pRequest->isDelivered)
+			return PathRequestStatus::Pending;
+
+		// The last handle can take the path instead of copying it
+		m_Handles.erase(it);
+		if (--pRequest->nrOfHandles == 0)
+			path = std::move(pRequest->path);
+		else
+			path = pRequest->path;
+
+		return pRequest->isFound ? PathRequestStatus::Found : PathRequestStatus::NotFound;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool PathRequestQueue<T_NodeType, T_ConnectionType>::CancelRequest(int handle)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto it = m_Handles.find(handle);
+		if (it == m_Handles.end())
+			return false;
+
+		RequestPtr pRequest = it->second;
+		m_Handles.erase(it);
+		if (--pRequest->nrOfHandles > 0)
+			return true;
+
+		// Requests that are searched or solved already are released by the worker and Update
+		auto pendingIt = std::find(m_PendingRequests.begin(), m_PendingRequests.end(), pRequest);
+		if (pendingIt != m_PendingRequests.end())
+		{
+			m_PendingRequests.erase(pendingIt);
+			std::make_heap(m_PendingRequests.begin(), m_PendingRequests.end(), HasLowerPriority);
+			m_UndeliveredRequests.erase(RequestKey{ pRequest->pGraph.get(), pRequest->startIdx, pRequest->goalIdx });
+		}
+
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::Update()
+	{
+		const auto now = std::chrono::high_resolution_clock::now();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			float totalLatency = 0.f;
+			for (const RequestPtr& pRequest : m_SolvedRequests)
+			{
+				pRequest->isDelivered = true;
+				m_UndeliveredRequests.erase(RequestKey{ pRequest->pGraph.get(), pRequest->startIdx, pRequest->goalIdx });
+
+				// The snapshot can be released as soon as no request uses it
+				pRequest->pGraph.reset();
+
+				const float latency = std::chrono::duration<float, std::milli>(now - pRequest->requestTime).count();
+				totalLatency += latency;
+				m_MaxLatency = std::max(m_MaxLatency, latency);
+			}
+
+			m_NrOfDeliveredRequests = (int)m_SolvedRequests.size();
+			m_AverageLatency = m_SolvedRequests.empty() ? 0.f : totalLatency / m_SolvedRequests.size();
+			m_SolvedRequests.clear();
+
+			m_FrameMilliseconds = 0.f;
+			m_FrameExpandedNodes = 0;
+		}
+
+		m_RequestAvailable.notify_all();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::SetFrameBudget(float maxMilliseconds, int maxExpandedNodes)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_MaxFrameMilliseconds = maxMilliseconds;
+			m_MaxFrameExpandedNodes = maxExpandedNodes;
+		}
+
+		// A larger budget can let waiting workers start right away
+		m_RequestAvailable.notify_all();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int PathRequestQueue<T_NodeType, T_ConnectionType>::GetNrOfPendingRequests() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		return (int)m_PendingRequests.size();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void PathRequestQueue<T_NodeType, T_ConnectionType>::RunWorker()
+	{
+		AStarContext<T_NodeType, T_ConnectionType> context{};
+		std::vector<int> path{};
+
+		for (;;)
+		{
+			RequestPtr pRequest{};
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_RequestAvailable.wait(lock, [this]() { return m_IsStopping || (!m_PendingRequests.empty() && !IsBudgetSpent()); });
+
+				if (m_IsStopping)
+					return;
+
+				std::pop_heap(m_PendingRequests.begin(), m_PendingRequests.end(), HasLowerPriority);
+				pRequest = m_PendingRequests.back();
+				m_PendingRequests.pop_back();
+			}
+
+			const auto searchStart = std::chrono::high_resolution_clock::now();
+			auto pathfinder = AStar<T_NodeType, T_ConnectionType, CSRGraph<T_NodeType>>(pRequest->pGraph.get(), m_HeuristicFunction);
+			const bool isFound = pathfinder.FindPath(pRequest->startIdx, pRequest->goalIdx, context, path);
+			const auto searchEnd = std::chrono::high_resolution_clock::now();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				pRequest->isFound = isFound;
+				pRequest->path = path;
+				m_SolvedRequests.push_back(pRequest);
+
+				m_FrameMilliseconds += std::chrono::duration<float, std::milli>(searchEnd - searchStart).count();
+				m_FrameExpandedNodes += pathfinder.GetNrOfExpandedNodes();
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool PathRequestQueue<T_NodeType, T_ConnectionType>::IsBudgetSpent() const
+	{
+		return (m_MaxFrameMilliseconds > 0.f && m_FrameMilliseconds >= m_MaxFrameMilliseconds)
+			|| (m_MaxFrameExpandedNodes > 0 && m_FrameExpandedNodes >= m_MaxFrameExpandedNodes);
+	}
+}
@@ -3,6 +3,61 @@
 
 
 bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>* pGraph)
+{
+	UpdateTerrainTypeUI();
+
+	//Check if clicked on grid
+	auto mouseLeftData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eLeft);
+	auto mouseMotionData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseMotion);
+
+	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eLeft))
+	{
+		Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseLeftData.X, (float)mouseLeftData.Y });
+		int idx = pGraph->GetNodeIdxAtWorldPos(mousePos);
+		
+		if (idx != invalid_node_index)
+		{
+			pGraph->GetNode(idx)->SetTerrainType(GetSelectedTerrainType());
+			
+			switch (GetSelectedTerrainType())
+			{
+			case TerrainType::Water:
+				pGraph->RemoveConnectionsToAdjacentNodes(idx);
+				break;
+			default:
+				pGraph->RemoveConnectionsToAdjacentNodes(idx);
+				pGraph->AddConnectionsToAdjacentCells(idx);
+				break;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Elite::GraphEditor::UpdateGraph(ImplicitGridGraph* pGraph)
+{
+	UpdateTerrainTypeUI();
+
+	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eLeft))
+	{
+		auto mouseLeftData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eLeft);
+		Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseLeftData.X, (float)mouseLeftData.Y });
+		int idx = pGraph->GetNodeIdxAtWorldPos(mousePos);
+
+		if (idx != invalid_node_index)
+		{
+			// Connection costs follow from the terrain, so there are no connections to rebuild
+			pGraph->SetTerrainType(idx, GetSelectedTerrainType());
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Elite::GraphEditor::UpdateTerrainTypeUI()
 {
 #pragma region UI
 	//Extra Grid Terrain UI
@@ -31,36 +86,10 @@ bool Elite::GraphEditor::UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>
 		ImGui::End();
 	}
 #pragma endregion
+}
 
-
-	//Check if clicked on grid
-	auto mouseLeftData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eLeft);
-	auto mouseMotionData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseMotion);
-
-	if (INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eLeft))
-	{
-		Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseLeftData.X, (float)mouseLeftData.Y });
-		int idx = pGraph->GetNodeIdxAtWorldPos(mousePos);
-		
-		if (idx != invalid_node_index)
-		{
-			std::vector<TerrainType> terrainTypeVec{ TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
-
-			pGraph->GetNode(idx)->SetTerrainType(terrainTypeVec[m_SelectedTerrainType]);
-			
-			switch (terrainTypeVec[m_SelectedTerrainType])
-			{
-			case TerrainType::Water:
-				pGraph->RemoveConnectionsToAdjacentNodes(idx);
-				break;
-			default:
-				pGraph->RemoveConnectionsToAdjacentNodes(idx);
-				pGraph->AddConnectionsToAdjacentCells(idx);
-				break;
-			}
-			return true;
-		}
-	}
-
-	return false;
+TerrainType Elite::GraphEditor::GetSelectedTerrainType() const
+{
+	const TerrainType terrainTypes[]{ TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
+	return terrainTypes[m_SelectedTerrainType];
 }
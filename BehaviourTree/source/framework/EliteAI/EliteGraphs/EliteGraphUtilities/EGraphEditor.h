@@ -4,6 +4,7 @@
 #include "framework\EliteAI\EliteGraphs\EGraphConnectionTypes.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
+#include "framework\EliteAI\EliteGraphs\EImplicitGridGraph.h"
 
 namespace Elite
 {
@@ -17,11 +18,15 @@ namespace Elite
 		bool UpdateGraph(Graph2D<T_NodeType, T_ConnectionType>* pGraph);
 
 		bool UpdateGraph(GridGraph<GridTerrainNode, GraphConnection>* pGraph);
+		bool UpdateGraph(ImplicitGridGraph* pGraph);
 
 		template <class T_NodeType, class T_ConnectionType>
 		bool UpdateGraph(GridGraph<T_NodeType, T_ConnectionType>* pGraph);
 
 	private:
+		void UpdateTerrainTypeUI();
+		TerrainType GetSelectedTerrainType() const;
+
 		int m_SelectedNodeIdx = -1;
 		int m_SelectedTerrainType = (int)TerrainType::Ground;
 
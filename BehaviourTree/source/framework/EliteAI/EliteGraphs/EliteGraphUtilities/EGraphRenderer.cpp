@@ -35,4 +35,62 @@ namespace Elite
 		DEBUGRENDERER2D->DrawSegment(toPos, fromPos, col, depth);
 		DEBUGRENDERER2D->DrawString(center, text.c_str());
 	}
+
+	void GraphRenderer::RenderGraph(ImplicitGridGraph* pGraph, bool renderNodes, bool renderNodeNumbers, bool renderConnections, bool renderConnectionsCosts) const
+	{
+		if (renderNodes)
+		{
+			//Nodes/Grid
+			for (int idx = 0; idx < pGraph->GetNrOfNodes(); ++idx)
+			{
+				std::string nodeTxt{};
+				if (renderNodeNumbers)
+					nodeTxt = std::to_string(idx);
+
+				RenderRectNode(pGraph->GetNodeWorldPos(idx), nodeTxt, float(pGraph->GetCellSize()), GetTerrainColor(pGraph->GetTerrainType(idx)), 0.1f);
+			}
+		}
+
+		if (renderConnections)
+		{
+			for (int idx = 0; idx < pGraph->GetNrOfNodes(); ++idx)
+			{
+				//Connections, there are no connection objects so only the edge is known
+				for (const GraphEdge& edge : pGraph->GetNeighbors(idx))
+				{
+					std::string conTxt{};
+					if (renderConnectionsCosts)
+					{
+						std::stringstream ss;
+						ss << std::fixed << std::setprecision(m_FloatPrintPrecision) << edge.cost;
+						conTxt = ss.str();
+					}
+
+					RenderConnection(nullptr, pGraph->GetNodeWorldPos(edge.to), pGraph->GetNodeWorldPos(edge.from), conTxt, DEFAULT_CONNECTION_COLOR);
+				}
+			}
+		}
+	}
+
+	void GraphRenderer::HighlightNodes(ImplicitGridGraph* pGraph, const std::vector<int>& path, Color col /*= HIGHLIGHTED_NODE_COLOR*/) const
+	{
+		for (int idx : path)
+		{
+			//Node
+			RenderCircleNode(pGraph->GetNodeWorldPos(idx), "", 3.1f, col, -0.2f);
+		}
+	}
+
+	Elite::Color GraphRenderer::GetTerrainColor(TerrainType terrain) const
+	{
+		switch (terrain)
+		{
+		case TerrainType::Mud:
+			return MUD_NODE_COLOR;
+		case TerrainType::Water:
+			return WATER_NODE_COLOR;
+		default:
+			return GROUND_NODE_COLOR;
+		}
+	}
 }
\ No newline at end of file
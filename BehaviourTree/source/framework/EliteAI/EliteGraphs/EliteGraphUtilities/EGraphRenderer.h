@@ -5,6 +5,7 @@
 #include "framework\EliteAI\EliteGraphs\EGraphConnectionTypes.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
+#include "framework\EliteAI\EliteGraphs\EImplicitGridGraph.h"
 #include  <type_traits>
 
 namespace Elite 
@@ -24,6 +25,9 @@ namespace Elite
 		template<class T_NodeType, class T_ConnectionType>
 		void HighlightNodes(GridGraph<T_NodeType, T_ConnectionType>* pGraph, std::vector<T_NodeType*> path, Color col = HIGHLIGHTED_NODE_COLOR) const;
 
+		void RenderGraph(ImplicitGridGraph* pGraph, bool renderNodes, bool renderNodeNumbers, bool renderConnections, bool renderConnectionsCosts) const;
+		void HighlightNodes(ImplicitGridGraph* pGraph, const std::vector<int>& path, Color col = HIGHLIGHTED_NODE_COLOR) const;
+
 		void SetNumberPrintPrecision(int precision) { m_FloatPrintPrecision = precision; }
 
 	private:
@@ -36,6 +40,7 @@ namespace Elite
 		Elite::Color GetNodeColor(T_NodeType* pNode) const;
 		Elite::Color GetNodeColor(GraphNode2D* pNode) const;
 		Elite::Color GetNodeColor(GridTerrainNode* pNode) const;
+		Elite::Color GetTerrainColor(TerrainType terrain) const;
 
 		template<class T_ConnectionType>
 		Elite::Color GetConnectionColor(T_ConnectionType* pConnection) const;
@@ -0,0 +1,26 @@
+/*=============================================================================*/
+// EGridUtilities.h: Helpers shared by the grid shaped graphs and maps (GridGraph, ImplicitGridGraph,
+// the influence maps and flow fields), so the same world position gives the same cell in all of them.
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteGraphs/EGraphEnums.h"
+
+namespace Elite
+{
+	// Index (row * columns + column) of the cell at the world position, for a grid with its first cell at the origin.
+	// invalid_node_index outside the grid
+	inline int GetGridCellIdxAtWorldPos(const Vector2& pos, int columns, int rows, float cellSize)
+	{
+		// Checked first, int(pos.x / cellSize) rounds towards zero and would put positions just below 0 in the first cell
+		if (pos.x < 0.f || pos.y < 0.f)
+			return invalid_node_index;
+
+		const int column = int(pos.x / cellSize);
+		const int row = int(pos.y / cellSize);
+		if (column >= columns || row >= rows)
+			return invalid_node_index;
+
+		return row * columns + column;
+	}
+}
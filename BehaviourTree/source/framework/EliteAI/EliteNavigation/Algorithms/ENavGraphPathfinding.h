@@ -3,6 +3,8 @@
 #include <iostream>
 #include "framework/EliteMath/EMath.h"
 #include "framework\EliteAI\EliteGraphs\ENavGraph.h"
+#include "framework\EliteAI\EliteGraphs\ETiledNavGraph.h"
+#include "framework\EliteAI\EliteGraphs\EGraphOverlay.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
 
 namespace Elite
@@ -10,73 +12,141 @@ namespace Elite
 	class NavMeshPathfinding
 	{
 	public:
-		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, NavGraph* pNavGraph, std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals)
+		// Landmarks are optional, they have to be built for pNavGraph.
+		// The graph isn't copied or changed, so several queries on the same graph can run at the same time.
+		// Agents wider than the radius the mesh was built with pass their extra radius, the path keeps that much further from obstacles
+		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, const NavGraph* pNavGraph, std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals,
+			const Landmarks* pLandmarks = nullptr, float agentRadius = 0.f)
+		{
+			AStarContext<NavGraphNode, GraphConnection2D> context{};
+			return FindPath(startPos, endPos, pNavGraph, context, debugNodePositions, debugPortals, pLandmarks, agentRadius);
+		}
+
+		// Same, reusing the search workspace of earlier queries (one context per thread)
+		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, const NavGraph* pNavGraph, AStarContext<NavGraphNode, GraphConnection2D>& context,
+			std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals, const Landmarks* pLandmarks = nullptr, float agentRadius = 0.f)
 		{
 			//Create the path to return
 			std::vector<Vector2> finalPath{};
 
+			std::vector<int> lineIndices{};
+			if (!FindCrossedLines(startPos, endPos, pNavGraph, context, lineIndices, debugNodePositions, pLandmarks, agentRadius))
+				return finalPath;
+
+			if (lineIndices.empty())
+			{
+				finalPath.push_back(endPos);
+				return finalPath;
+			}
+
+			//Run optimiser on new graph, MAKE SURE the A star path is working properly before starting this section and uncommenting this!!!
+			const std::vector<Line*>& lines = pNavGraph->GetNavMeshPolygon()->GetLines();
+			std::vector<Line> pathLines{};
+			for (int lineIdx : lineIndices)
+				pathLines.push_back(*lines[lineIdx]);
+
+			debugPortals = SSFA::FindPortals(startPos, pathLines, endPos, agentRadius);
+			finalPath = SSFA::OptimizePortals(debugPortals);
+
+			return finalPath;
+		}
+
+		// Lines of the navigation mesh crossed by the shortest path from startPos to endPos, in order. Lines and triangles too narrow
+		// for the agent radius aren't crossed. False when either position is off the mesh or there is no path, no lines are crossed
+		// when both are in the same triangle
+		static bool FindCrossedLines(Vector2 startPos, Vector2 endPos, const NavGraph* pNavGraph, AStarContext<NavGraphNode, GraphConnection2D>& context,
+			std::vector<int>& lineIndices, std::vector<Vector2>& debugNodePositions, const Landmarks* pLandmarks = nullptr, float agentRadius = 0.f)
+		{
+			lineIndices.clear();
+
 			//Get the start and endTriangle
 			const Triangle* startTr = pNavGraph->GetNavMeshPolygon()->GetTriangleFromPosition(startPos);
 			const Triangle* endTr = pNavGraph->GetNavMeshPolygon()->GetTriangleFromPosition(endPos);
 
 			if (!startTr || !endTr)
-				return finalPath;
+				return false;
 
 			if (startTr == endTr)
-			{
-				finalPath.push_back(endPos);
-				return finalPath;
-			}
+				return true;
 
 			//We have valid start/end triangles and they are not the same
 			//=> Start looking for a path
-			//Copy the graph
-			auto graphClone = pNavGraph->Clone();
-			IGraph<NavGraphNode, GraphConnection2D>* graphCopy = graphClone.get();
-
-			//Create extra node for the Start Node (Agent's position
-			NavGraphNode* startNode{ new NavGraphNode(graphCopy->GetNextFreeNodeIndex(),invalid_node_index,startPos) };
-			graphCopy->AddNode(startNode);
-			
-			int currentConnectionIdx{ 0 };
-			for (int lineIdx : startTr->metaData.IndexLines)
-			{
-				if (pNavGraph->GetNodeIdxFromLineIdx(lineIdx) != invalid_node_index)
-				{					
-					GraphConnection2D* connection{new GraphConnection2D( startNode->GetIndex(),pNavGraph->GetNodeIdxFromLineIdx(lineIdx)) };
-					connection->SetCost(Distance(startNode->GetPosition(), graphCopy->GetNode(pNavGraph->GetNodeIdxFromLineIdx(lineIdx))->GetPosition()));
+			//The start and end node only exist in the overlay, they connect to the nodes on the lines of their triangle
+			GraphOverlay<NavGraphNode, GraphConnection2D> overlay{ *pNavGraph, pLandmarks };
+
+			const int startIdx = overlay.AddVirtualNode(NavGraphNode(invalid_node_index, invalid_node_index, startPos));
+			const int endIdx = overlay.AddVirtualNode(NavGraphNode(invalid_node_index, invalid_node_index, endPos));
 
-					graphCopy->AddConnection(connection);
+			for (const auto& triangleNode : { std::make_pair(startTr, startIdx), std::make_pair(endTr, endIdx) })
+			{
+				for (int lineIdx : triangleNode.first->metaData.IndexLines)
+				{
+					const int lineNodeIdx = pNavGraph->GetNodeIdxFromLineIdx(lineIdx);
+					if (lineNodeIdx != invalid_node_index && pNavGraph->GetLineClearance(lineIdx) >= agentRadius)
+						overlay.AddVirtualConnection(triangleNode.second, lineNodeIdx, Distance(overlay.GetNodePos(triangleNode.second), pNavGraph->GetNodePos(lineNodeIdx)));
 				}
 			}
 
-			//Create extra node for the endNode
-			NavGraphNode* endNode{ new NavGraphNode(graphCopy->GetNextFreeNodeIndex(),invalid_node_index,endPos) };
-			graphCopy->AddNode(endNode);
-
-			for (int lineIdx : endTr->metaData.IndexLines)
+			//Run A star on the overlay
+			auto pathfinder = AStar<NavGraphNode, GraphConnection2D, GraphOverlay<NavGraphNode, GraphConnection2D>>(&overlay, HeuristicFunctions::Chebyshev);
+			pathfinder.SetLandmarks(overlay.GetLandmarks());
+			if (agentRadius > 0.f)
 			{
-				if (pNavGraph->GetNodeIdxFromLineIdx(lineIdx) != invalid_node_index)
+				pathfinder.SetConnectionFilter([&overlay, pNavGraph, agentRadius](const GraphEdge& connection)
 				{
-					GraphConnection2D* connection{ new GraphConnection2D( endNode->GetIndex(),pNavGraph->GetNodeIdxFromLineIdx(lineIdx)) };
-					connection->SetCost(Distance(endNode->GetPosition(), graphCopy->GetNode(pNavGraph->GetNodeIdxFromLineIdx(lineIdx))->GetPosition()));
-					graphCopy->AddConnection(connection);
-				}
+					return overlay.IsVirtualNode(connection.from) || overlay.IsVirtualNode(connection.to)
+						|| pNavGraph->GetClearance(connection.from, connection.to) >= agentRadius;
+				});
 			}
 
-			//Run A star on new graph
-			auto pathfinder = AStar<NavGraphNode, GraphConnection2D>(graphCopy, HeuristicFunctions::Chebyshev);
-			auto path = pathfinder.FindPath(graphCopy->GetNode(graphCopy->GetNrOfNodes() - 2), graphCopy->GetNode(graphCopy->GetNrOfNodes() - 1));
-			
+			std::vector<NavGraphNode*> path{};
+			if (!pathfinder.FindPath(overlay.GetNode(startIdx), overlay.GetNode(endIdx), context, path))
+				return false;
+
 			//OPTIONAL BUT ADVICED: Debug Visualisation
 			for (auto& node : path)
-			{
-				finalPath.push_back(node->GetPosition());
 				debugNodePositions.push_back(node->GetPosition());
+
+			//Every node between the start and end is in the middle of a line
+			for (size_t nodeIdx = 1; nodeIdx < path.size() - 1; ++nodeIdx)
+				lineIndices.push_back(path[nodeIdx]->GetLineIndex());
+
+			return true;
+		}
+
+		// Same, on a snapshot of a tiled navigation mesh. Holding the snapshot keeps its tiles alive while they are rebuilt
+		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, const TiledNavGraph::Snapshot& snapshot, AStarContext<NavGraphNode, GraphConnection2D>& context,
+			std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals)
+		{
+			std::vector<Vector2> finalPath{};
+
+			//The start and end node only exist in the query, they connect to the nodes on the lines of their triangle
+			TiledNavGraphQuery query{ snapshot, startPos, endPos };
+			if (!query.IsValid())
+				return finalPath;
+
+			if (query.IsInSameTriangle())
+			{
+				finalPath.push_back(endPos);
+				return finalPath;
 			}
 
-			//Run optimiser on new graph, MAKE SURE the A star path is working properly before starting this section and uncommenting this!!!
-			debugPortals = SSFA::FindPortals(path, pNavGraph->GetNavMeshPolygon());
+			auto pathfinder = AStar<NavGraphNode, GraphConnection2D, TiledNavGraphQuery>(&query, HeuristicFunctions::Chebyshev);
+
+			std::vector<int> path{};
+			if (!pathfinder.FindPath(query.GetStartIdx(), query.GetGoalIdx(), context, path))
+				return finalPath;
+
+			//Path nodes between the start and end lie on the lines crossed by the path, in this tile or the next one
+			std::vector<Line> pathLines{};
+			for (int nodeIdx : path)
+			{
+				debugNodePositions.push_back(query.GetNodePos(nodeIdx));
+				if (nodeIdx != query.GetStartIdx() && nodeIdx != query.GetGoalIdx())
+					pathLines.push_back(snapshot.GetNodeLine(nodeIdx));
+			}
+
+			debugPortals = SSFA::FindPortals(startPos, pathLines, endPos);
 			finalPath = SSFA::OptimizePortals(debugPortals);
 
 			return finalPath;
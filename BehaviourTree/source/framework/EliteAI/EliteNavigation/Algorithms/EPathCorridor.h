@@ -0,0 +1,221 @@
+/*=============================================================================*/
+// EPathCorridor.h: Triangles of a navigation mesh a path runs through, kept between frames.
+// When the agent or its target moves a little only the ends of the corridor are patched and the
+// funnel is run again, A* is only needed when either of them leaves the corridor. A patched corridor
+// always leads to the target, but it isn't always the one A* would pick, plan again when that matters.
+/*=============================================================================*/
+#pragma once
+
+#include "framework/EliteAI/EliteNavigation/Algorithms/ENavGraphPathfinding.h"
+
+namespace Elite
+{
+	class PathCorridor final
+	{
+	public:
+		// The corridor points to the triangles of the graph, it's valid as long as the graph isn't changed.
+		// The agent radius is on top of the radius the mesh was built with, it's used from the next Reset on
+		explicit PathCorridor(const NavGraph* pNavGraph, float agentRadius = 0.f) : m_pNavGraph(pNavGraph), m_AgentRadius(agentRadius) {}
+
+		// Plans a new corridor with A*, false (and an empty corridor) when there is no path
+		bool Reset(const Vector2& position, const Vector2& target, AStarContext<NavGraphNode, GraphConnection2D>& context, const Landmarks* pLandmarks = nullptr)
+		{
+			Clear();
+
+			std::vector<int> lineIndices{};
+			std::vector<Vector2> debugNodePositions{};
+			if (!NavMeshPathfinding::FindCrossedLines(position, target, m_pNavGraph, context, lineIndices, debugNodePositions, pLandmarks, m_AgentRadius))
+				return false;
+
+			//Walk from the start triangle over the crossed lines, every line leads to the next triangle
+			const Polygon* pPolygon = m_pNavGraph->GetNavMeshPolygon();
+			m_pTriangles.push_back(pPolygon->GetTriangleFromPosition(position));
+			for (int lineIdx : lineIndices)
+			{
+				const Triangle* pNext = GetNeighbour(m_pTriangles.back(), lineIdx);
+				if (!pNext)
+				{
+					Clear();
+					return false;
+				}
+
+				m_pTriangles.push_back(pNext);
+				m_LineIndices.push_back(lineIdx);
+			}
+
+			m_Position = position;
+			m_Target = target;
+			return true;
+		}
+
+		void Clear()
+		{
+			m_pTriangles.clear();
+			m_LineIndices.clear();
+		}
+
+		// The agent moved: the triangles it passed are dropped. When it's in a triangle next to the corridor, the corridor
+		// continues from the last triangle it borders. False when the position is further away, the corridor has to be planned again
+		bool MovePosition(const Vector2& position)
+		{
+			if (!IsValid())
+				return false;
+
+			const int triangleIdx = FindTriangle(position, true);
+			if (triangleIdx >= 0)
+			{
+				m_pTriangles.erase(m_pTriangles.begin(), m_pTriangles.begin() + triangleIdx);
+				m_LineIndices.erase(m_LineIndices.begin(), m_LineIndices.begin() + triangleIdx);
+			}
+			else
+			{
+				int lineIdx = -1;
+				const Triangle* pNeighbour = nullptr;
+				int borderIdx = static_cast<int>(m_pTriangles.size());
+				while (!pNeighbour && borderIdx > 0)
+				{
+					--borderIdx;
+					const int exitLineIdx = borderIdx < static_cast<int>(m_LineIndices.size()) ? m_LineIndices[borderIdx] : -1;
+					pNeighbour = FindNeighbour(m_pTriangles[borderIdx], exitLineIdx, position, lineIdx);
+				}
+				if (!pNeighbour)
+					return false;
+
+				m_pTriangles.erase(m_pTriangles.begin(), m_pTriangles.begin() + borderIdx);
+				m_LineIndices.erase(m_LineIndices.begin(), m_LineIndices.begin() + borderIdx);
+				m_pTriangles.insert(m_pTriangles.begin(), pNeighbour);
+				m_LineIndices.insert(m_LineIndices.begin(), lineIdx);
+			}
+
+			m_Position = position;
+			return true;
+		}
+
+		// The target moved: the corridor is cut off at the triangle it's in now. When it's in a triangle next to the corridor,
+		// the corridor ends there from the first triangle it borders. False when the target is further away, the corridor has to be planned again
+		bool MoveTarget(const Vector2& target)
+		{
+			if (!IsValid())
+				return false;
+
+			const int triangleIdx = FindTriangle(target, false);
+			if (triangleIdx >= 0)
+			{
+				m_pTriangles.resize(triangleIdx + 1);
+				m_LineIndices.resize(triangleIdx);
+			}
+			else
+			{
+				int lineIdx = -1;
+				const Triangle* pNeighbour = nullptr;
+				int borderIdx = -1;
+				while (!pNeighbour && borderIdx + 1 < static_cast<int>(m_pTriangles.size()))
+				{
+					++borderIdx;
+					const int entryLineIdx = borderIdx > 0 ? m_LineIndices[borderIdx - 1] : -1;
+					pNeighbour = FindNeighbour(m_pTriangles[borderIdx], entryLineIdx, target, lineIdx);
+				}
+				if (!pNeighbour)
+					return false;
+
+				m_pTriangles.resize(borderIdx + 1);
+				m_LineIndices.resize(borderIdx);
+				m_pTriangles.push_back(pNeighbour);
+				m_LineIndices.push_back(lineIdx);
+			}
+
+			m_Target = target;
+			return true;
+		}
+
+		// Funnel through the corridor, the portals are shrunk by the agent radius
+		std::vector<Vector2> FindPath(std::vector<Portal>& debugPortals) const
+		{
+			std::vector<Vector2> path{};
+			debugPortals.clear();
+			if (!IsValid())
+				return path;
+
+			if (m_LineIndices.empty())
+			{
+				path.push_back(m_Target);
+				return path;
+			}
+
+			const std::vector<Line*>& lines = m_pNavGraph->GetNavMeshPolygon()->GetLines();
+			std::vector<Line> pathLines{};
+			for (int lineIdx : m_LineIndices)
+				pathLines.push_back(*lines[lineIdx]);
+
+			debugPortals = SSFA::FindPortals(m_Position, pathLines, m_Target, m_AgentRadius);
+			return SSFA::OptimizePortals(debugPortals);
+		}
+
+		bool IsValid() const { return !m_pTriangles.empty(); }
+		const Vector2& GetPosition() const { return m_Position; }
+		const Vector2& GetTarget() const { return m_Target; }
+		const std::vector<const Triangle*>& GetTriangles() const { return m_pTriangles; }
+		float GetAgentRadius() const { return m_AgentRadius; }
+		void SetAgentRadius(float agentRadius) { m_AgentRadius = agentRadius; }
+
+	private:
+		const NavGraph* m_pNavGraph;
+		float m_AgentRadius;
+		std::vector<const Triangle*> m_pTriangles{}; // from the triangle of the position to the one of the target
+		std::vector<int> m_LineIndices{}; // line between every triangle and the next one
+		Vector2 m_Position{};
+		Vector2 m_Target{};
+
+		// Index of the corridor triangle that holds the position, a position on a line or corner can be in several of them.
+		// The last one keeps the corridor of the agent shortest, the first one the corridor to the target
+		int FindTriangle(const Vector2& position, bool findLast) const
+		{
+			const int nrOfTriangles = static_cast<int>(m_pTriangles.size());
+			for (int i = 0; i < nrOfTriangles; ++i)
+			{
+				const int idx = findLast ? nrOfTriangles - 1 - i : i;
+				const Triangle* pTriangle = m_pTriangles[idx];
+				if (PointInTriangle(position, pTriangle->p1, pTriangle->p2, pTriangle->p3, true))
+					return idx;
+			}
+			return -1;
+		}
+
+		const Triangle* GetNeighbour(const Triangle* pTriangle, int lineIdx) const
+		{
+			const auto& lineTriangles = m_pNavGraph->GetNavMeshPolygon()->GetTrianglesFromLineIndex(lineIdx);
+			if (std::find(lineTriangles.begin(), lineTriangles.end(), pTriangle) == lineTriangles.end())
+				return nullptr;
+
+			for (const Triangle* pLineTriangle : lineTriangles)
+			{
+				if (pLineTriangle != pTriangle)
+					return pLineTriangle;
+			}
+			return nullptr;
+		}
+
+		// Triangle next to pTriangle that holds the position, lineIdx becomes the line they share. Like the A* filter, the agent has to fit
+		// through that line and through pTriangle between it and corridorLineIdx, the other corridor line of pTriangle (-1 if there is none)
+		const Triangle* FindNeighbour(const Triangle* pTriangle, int corridorLineIdx, const Vector2& position, int& lineIdx) const
+		{
+			for (int triangleLineIdx : pTriangle->metaData.IndexLines)
+			{
+				if (m_pNavGraph->GetLineClearance(triangleLineIdx) < m_AgentRadius)
+					continue;
+
+				if (corridorLineIdx >= 0 && m_pNavGraph->GetClearance(m_pNavGraph->GetNodeIdxFromLineIdx(triangleLineIdx),
+					m_pNavGraph->GetNodeIdxFromLineIdx(corridorLineIdx)) < m_AgentRadius)
+					continue;
+
+				const Triangle* pNeighbour = GetNeighbour(pTriangle, triangleLineIdx);
+				if (pNeighbour && PointInTriangle(position, pNeighbour->p1, pNeighbour->p2, pNeighbour->p3, true))
+				{
+					lineIdx = triangleLineIdx;
+					return pNeighbour;
+				}
+			}
+			return nullptr;
+		}
+	};
+}
@@ -25,29 +25,82 @@ namespace Elite
 		//--- References ---
 		//http://digestingduck.blogspot.be/2010/03/simple-stupid-funnel-algorithm.html
 		//https://gamedev.stackexchange.com/questions/68302/how-does-the-simple-stupid-funnel-algorithm-work
+		//The portals are shrunk by the agent radius at both ends, so agents wider than the radius the mesh was built with keep clear of the corners
 		static std::vector<Portal> FindPortals(
 			const std::vector<NavGraphNode*>& nodePath,
-			Polygon* navMeshPolygon)
+			Polygon* navMeshPolygon,
+			float agentRadius = 0.f)
+		{
+			//For each node received, get its corresponding line (except the first and last node, they are the start and end of the path)
+			std::vector<Line*> lines = navMeshPolygon->GetLines();
+
+			std::vector<Line> pathLines = {};
+			for (size_t nodeIdx = 1; nodeIdx < nodePath.size() - 1; ++nodeIdx)
+				pathLines.push_back(*lines[nodePath[nodeIdx]->GetLineIndex()]);
+
+			return FindPortals(nodePath[0]->GetPosition(), pathLines, nodePath[nodePath.size() - 1]->GetPosition(), agentRadius);
+		}
+
+		//Same, with the lines the path crosses (the nodes of a navigation mesh are in the middle of these lines).
+		//Consecutive lines on top of each other (the border of two tiles, seen from both tiles) become one portal, their overlap
+		static std::vector<Portal> FindPortals(
+			const Vector2& startPosition,
+			const std::vector<Line>& pathLines,
+			const Vector2& endPosition,
+			float agentRadius = 0.f)
 		{
 			//Container
 			std::vector<Portal> vPortals = {};
 
-			vPortals.push_back(Portal(Line(nodePath[0]->GetPosition(), nodePath[0]->GetPosition())));
+			vPortals.push_back(Portal(Line(startPosition, startPosition)));
 
-			std::vector<Line*> lines = navMeshPolygon->GetLines();
+			std::vector<Line> portalLines = {};
+			for (const Line& line : pathLines)
+			{
+				if (!portalLines.empty() && IsOnLine(portalLines.back(), line.p1) && IsOnLine(portalLines.back(), line.p2))
+					portalLines.back() = GetOverlap(portalLines.back(), line);
+				else
+					portalLines.push_back(line);
+			}
 
-			//For each node received, get its corresponding line
-			for (size_t nodeIdx = 1; nodeIdx < nodePath.size() - 1; ++nodeIdx)
+			for (size_t lineIdx = 0; lineIdx < portalLines.size(); ++lineIdx)
 			{
 				//Local variables
-				NavGraphNode* pNode = nodePath[nodeIdx]; //Store node, except last node, because this is our target node!
-				Line* pLine = lines[pNode->GetLineIndex()];
+				const Line* pLine = &portalLines[lineIdx];
 
-				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point
+				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point.
+				//This is decided by the last point before the line that isn't on it, or else the first one after it (seen from the other side)
 				Vector2 centerLine = (pLine->p1 + pLine->p2) / 2.0f;
-				Vector2 previousPosition = nodeIdx == 0 ? nodePath[0]->GetPosition() : nodePath[nodeIdx - 1]->GetPosition();
+				Vector2 referencePosition = startPosition;
+				for (size_t previousIdx = lineIdx; previousIdx > 0; --previousIdx)
+				{
+					const Vector2 previousCenter = (portalLines[previousIdx - 1].p1 + portalLines[previousIdx - 1].p2) / 2.0f;
+					if (!IsOnLine(*pLine, previousCenter))
+					{
+						referencePosition = previousCenter;
+						break;
+					}
+				}
+
+				bool isReferenceBefore = true;
+				if (IsOnLine(*pLine, referencePosition))
+				{
+					isReferenceBefore = false;
+					referencePosition = endPosition;
+					for (size_t nextIdx = lineIdx + 1; nextIdx < portalLines.size(); ++nextIdx)
+					{
+						const Vector2 nextCenter = (portalLines[nextIdx].p1 + portalLines[nextIdx].p2) / 2.0f;
+						if (!IsOnLine(*pLine, nextCenter))
+						{
+							referencePosition = nextCenter;
+							break;
+						}
+					}
+				}
 
-				float cross = Cross((centerLine - previousPosition), (pLine->p1 - previousPosition));
+				float cross = Cross((centerLine - referencePosition), (pLine->p1 - referencePosition));
+				if (!isReferenceBefore)
+					cross = -cross;
 
 				Line portalLine = {};
 				if (cross > 0)//Left
@@ -55,11 +108,28 @@ namespace Elite
 				else //Right
 					portalLine = Line(pLine->p1, pLine->p2);
 
+				//Every end of a portal is a corner of the mesh, a portal narrower than the agent is pinched to its center
+				if (agentRadius > 0.f)
+				{
+					const float length = Distance(portalLine.p1, portalLine.p2);
+					if (length <= 2.f * agentRadius)
+					{
+						portalLine.p1 = centerLine;
+						portalLine.p2 = centerLine;
+					}
+					else
+					{
+						const Vector2 offset = (portalLine.p2 - portalLine.p1) * (agentRadius / length);
+						portalLine.p1 += offset;
+						portalLine.p2 -= offset;
+					}
+				}
+
 				//Store portal
 				vPortals.push_back(Portal(portalLine));
 			}
 			//Add degenerate portal to force end evaluation
-			vPortals.push_back(Portal(Line(nodePath[nodePath.size() - 1]->GetPosition(), nodePath[nodePath.size() - 1]->GetPosition())));
+			vPortals.push_back(Portal(Line(endPosition, endPosition)));
 
 			return vPortals;
 		}
@@ -147,5 +217,35 @@ namespace Elite
 	private:
 		SSFA() {};
 		~SSFA() {};
+
+		//Whether the point lies on the (infinite) line, within a small distance
+		static bool IsOnLine(const Line& line, const Vector2& point)
+		{
+			const float epsilon = 1e-3f;
+			const Vector2 direction = line.p2 - line.p1;
+			const float length = direction.Magnitude();
+			if (length <= epsilon)
+				return Distance(line.p1, point) <= epsilon;
+
+			return abs(Cross(direction, point - line.p1)) <= epsilon * length;
+		}
+
+		//Part of both collinear lines, in the direction of the first one. Lines that only touch give the shorter one
+		static Line GetOverlap(const Line& first, const Line& second)
+		{
+			const Vector2 direction = first.p2 - first.p1;
+			const float lengthSquared = direction.MagnitudeSquared();
+			if (lengthSquared <= 0.f)
+				return second;
+
+			const float t1 = Dot(second.p1 - first.p1, direction) / lengthSquared;
+			const float t2 = Dot(second.p2 - first.p1, direction) / lengthSquared;
+			const float from = std::max(0.f, std::min(t1, t2));
+			const float to = std::min(1.f, std::max(t1, t2));
+			if (from >= to)
+				return DistanceSquared(first.p1, first.p2) <= DistanceSquared(second.p1, second.p2) ? first : second;
+
+			return Line(first.p1 + direction * from, first.p1 + direction * to);
+		}
 	};
 }
@@ -8,6 +8,9 @@
 //#include "EGeometry.h"
 #include "EGeometry2DTypes.h"
 #include "EGeometry2DUtilities.h"
+#include "framework/EliteHelpers/EBinaryStream.h"
+
+#include <cstring>
 
 #pragma region Polygon
 #pragma region Constructors
@@ -166,9 +169,26 @@ bool Elite::Polygon::OverlappingYAxis(const Polygon& poly) const
 
 std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangle* t) const
 {
+	//Adjacent triangles share an edge (two points) with this triangle
+	std::vector<Triangle*> adjTriangles;
+
+#ifdef USE_TRIANGLE_METADATA
+	//The triangles on the lines of this triangle
+	for (const int lineIndex : t->metaData.IndexLines)
+	{
+		if (lineIndex < 0 || lineIndex >= static_cast<int>(m_vpLines.size()))
+			continue;
+
+		for (int i = m_LineTriangleStarts[lineIndex]; i < m_LineTriangleStarts[lineIndex + 1]; ++i)
+		{
+			Triangle* ct = m_vpTriangles[m_LineTriangles[i]];
+			if (ct != t && std::find(adjTriangles.begin(), adjTriangles.end(), ct) == adjTriangles.end())
+				adjTriangles.push_back(ct);
+		}
+	}
+#else
 	//For this triangle, go over all triangles and look if any of it's edges matches the edges of a triangle,
 	//in other words, two points overlap. If two points match, it's an adjacent triangle
-	std::vector<Triangle*> adjTriangles;
 	for (auto ct : m_vpTriangles)
 	{
 		if (t == ct) //If same triangle, ignore
@@ -187,36 +207,28 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangl
 		if (matchingVerts == 2)
 			adjTriangles.push_back(ct);
 	}
+#endif
 	return adjTriangles;
 }
 
 std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const
 {
-	//For this triangle, go over all triangles and look if it's edges matches the given line.
+	//For this triangle, look up the other triangles on the given line.
 	//WARNING: this only works when metadata has been enabled!
 	std::vector<Triangle*> adjTriangles;
 
 #ifdef USE_TRIANGLE_METADATA
-	//Start by getting index of line in matrix
-	auto lRev = Line(l.p2, l.p1);
-	const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
-	{ return (*rl == l || *rl == lRev); });
-	if (it == m_vpLines.end())
+	const int lineIndex = GetLineIndex(l.p1, l.p2);
+	if (lineIndex == -1)
 	{
 		std::cout << "WARNING: line not found!" << std::endl;
 		return adjTriangles;
 	}
-	const int lineIndex = it - m_vpLines.begin();
 
-	//Go over all the triangles and compare lines
-	for (auto ct : m_vpTriangles)
+	for (int i = m_LineTriangleStarts[lineIndex]; i < m_LineTriangleStarts[lineIndex + 1]; ++i)
 	{
-		if (t == ct) //If same triangle, ignore
-			continue;
-
-		if (ct->metaData.IndexLines[0] == lineIndex
-			|| ct->metaData.IndexLines[1] == lineIndex
-			|| ct->metaData.IndexLines[2] == lineIndex)
+		Triangle* ct = m_vpTriangles[m_LineTriangles[i]];
+		if (t != ct) //If same triangle, ignore
 			adjTriangles.push_back(ct);
 	}
 #endif
@@ -226,29 +238,91 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 
 const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& position, bool onLineAllowed /*= false*/) const
 {
-	for (size_t i = 0; i < m_vpTriangles.size(); i++)
+	if (m_TriangleGridCellStarts.empty())
+		return nullptr;
+
+	//Only the triangles of the cell the position is in, positions outside of the grid end up in a border cell and fail the test
+	const int cell = GetTriangleGridRow(position.y) * m_TriangleGridColumns + GetTriangleGridColumn(position.x);
+	for (int i = m_TriangleGridCellStarts[cell]; i < m_TriangleGridCellStarts[cell + 1]; ++i)
 	{
-		if (PointInTriangle(position, m_vpTriangles[i]->p1, m_vpTriangles[i]->p2, m_vpTriangles[i]->p3, onLineAllowed))
-			return m_vpTriangles[i];
+		const Triangle* pTriangle = m_vpTriangles[m_TriangleGridTriangles[i]];
+		if (PointInTriangle(position, pTriangle->p1, pTriangle->p2, pTriangle->p3, onLineAllowed))
+			return pTriangle;
 	}
 	return nullptr;
 }
 
-#ifdef USE_TRIANGLE_METADATA
-const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIndex(unsigned int lineIndex) const
+const Elite::Triangle* Elite::Polygon::GetClosestTriangleFromPosition(const Vector2& position, Vector2& closestPosition) const
 {
-	std::vector<const Triangle*> vpFoundTriangles = {};
-	for (auto pT : m_vpTriangles)
+	closestPosition = position;
+	if (m_TriangleGridCellStarts.empty())
+		return nullptr;
+
+	const Triangle* pClosestTriangle = GetTriangleFromPosition(position, true);
+	if (pClosestTriangle)
+		return pClosestTriangle;
+
+	//Outside of the polygon, the closest point is on the edge of a triangle. Search the cells in rings around
+	//the position, triangles in the next rings are at least ring * cellSize away
+	const int startColumn = GetTriangleGridColumn(position.x);
+	const int startRow = GetTriangleGridRow(position.y);
+	float closestDistanceSquared = FLT_MAX;
+
+	for (int ring = 0; ring <= max(m_TriangleGridColumns, m_TriangleGridRows); ++ring)
 	{
-		if (pT->metaData.IndexLines[0] == lineIndex ||
-			pT->metaData.IndexLines[1] == lineIndex ||
-			pT->metaData.IndexLines[2] == lineIndex)
+		for (int row = max(startRow - ring, 0); row <= min(startRow + ring, m_TriangleGridRows - 1); ++row)
 		{
-			vpFoundTriangles.push_back(pT);
+			//Only the border of the ring, the cells inside it were searched already
+			const bool isBorderRow = row == startRow - ring || row == startRow + ring;
+			const int columnStep = isBorderRow ? 1 : 2 * ring;
+			for (int column = startColumn - ring; column <= startColumn + ring; column += columnStep)
+			{
+				if (column < 0 || column >= m_TriangleGridColumns)
+					continue;
+
+				const int cell = row * m_TriangleGridColumns + column;
+				for (int i = m_TriangleGridCellStarts[cell]; i < m_TriangleGridCellStarts[cell + 1]; ++i)
+				{
+					const Triangle* pTriangle = m_vpTriangles[m_TriangleGridTriangles[i]];
+					for (const Vector2& edgePosition : { ProjectOnLineSegment(pTriangle->p1, pTriangle->p2, position),
+						ProjectOnLineSegment(pTriangle->p2, pTriangle->p3, position), ProjectOnLineSegment(pTriangle->p3, pTriangle->p1, position) })
+					{
+						const float distanceSquared = DistanceSquared(position, edgePosition);
+						if (distanceSquared < closestDistanceSquared)
+						{
+							closestDistanceSquared = distanceSquared;
+							closestPosition = edgePosition;
+							pClosestTriangle = pTriangle;
+						}
+					}
+				}
+			}
 		}
+
+		const float ringDistance = ring * m_TriangleGridCellSize;
+		if (pClosestTriangle && closestDistanceSquared <= ringDistance * ringDistance)
+			break;
 	}
+	return pClosestTriangle;
+}
+
+#ifdef USE_TRIANGLE_METADATA
+const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIndex(unsigned int lineIndex) const
+{
+	std::vector<const Triangle*> vpFoundTriangles = {};
+	if (lineIndex >= m_vpLines.size())
+		return vpFoundTriangles;
+
+	for (int i = m_LineTriangleStarts[lineIndex]; i < m_LineTriangleStarts[lineIndex + 1]; ++i)
+		vpFoundTriangles.push_back(m_vpTriangles[m_LineTriangles[i]]);
 	return vpFoundTriangles;
 }
+
+int Elite::Polygon::GetLineIndex(const Vector2& p1, const Vector2& p2) const
+{
+	const auto it = m_LineIndices.find(GetLineKey(p1, p2));
+	return it != m_LineIndices.end() ? it->second : -1;
+}
 #endif
 
 
@@ -261,75 +335,24 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 	OrientateWithChildren(Winding::CCW);
 
 	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
-	for (auto child : m_vChildren)
+	for (const auto& child : m_vChildren)
 	{
 		//Check for overlap, if so merge, create new child and remove old ones!
 		//FILL IN FUNCTIONS!
 	}
 
-	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
-	std::sort(m_vChildren.begin(), m_vChildren.end(),
-		[](const Polygon& p1, const Polygon& p2)
-	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
-
-	//Copy children as backup after sort
-	const auto children = m_vChildren;
-	
-	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
-	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
-	{
-		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
-		{
-			//Swap if i.y < i+1.y
-			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
-			{
-				const auto temp = m_vChildren[i];
-				m_vChildren[i] = m_vChildren[i + 1];
-				m_vChildren[i + 1] = temp;
-			}
-		}
-	}
-
-	//First split polygon
-	while (m_vChildren.size() != 0)
-		Split();
+	//First split polygon: bridge all children (holes) into one contour. This works on a copy, so the polygon keeps it's own
+	//points and children and can be triangulated again
+	std::vector<Vector2> points(m_vPoints.begin(), m_vPoints.end());
+	Split(points);
 
 	//Triangle list - Clear first (if already containing triangles)
 	for (auto t : m_vpTriangles)
 		SAFE_DELETE(t);
 	m_vpTriangles.clear();
+	m_vpTriangles.reserve(points.size());
 
-	std::list<Vector2> copyPoints;
-	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
-
-	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
-	while (copyPoints.size() > 3)
-	{
-		list<Vector2>::const_iterator earListIt = copyPoints.end();
-		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
-		{
-			if (earListIt != copyPoints.end())
-				break;
-			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
-				earListIt = it;
-		}
-
-		//Push triangle
-		Vector2 current, prev, next;
-		GetTriangle(copyPoints, earListIt, current, prev, next);
-		Triangle* t = new Triangle(prev, current, next);
-		m_vpTriangles.push_back(t);
-
-		//Remove current from pointslist
-		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
-		copyPoints.erase(currentIt); //remove
-	}
-	//Add the remaining 3 vertices to the triangulated polygon
-	std::vector<Vector2> tempCopy;
-	for (const auto p : copyPoints)
-		tempCopy.push_back(p);
-	Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
-	m_vpTriangles.push_back(lastTriangle);
+	ClipEars(points);
 
 	//Flag as triangulated for later use
 	m_isTriangulated = true; 
@@ -337,8 +360,8 @@ const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
 #ifdef USE_TRIANGLE_METADATA
 	GenerateLineMatrix();
 #endif
+	BuildTriangleGrid();
 
-	m_vChildren = children;
 	return m_vpTriangles;
 }
 
@@ -352,7 +375,7 @@ void Elite::Polygon::OrientateWithChildren(Winding winding)
 
 	//Rewind the children if necessary
 	auto windingChildren = abs(winding - 1); //CCW -> CW, CW -> CCW ----- abs(0-1)=1, abs(1-1)=0
-	for (auto child : m_vChildren)
+	for (auto& child : m_vChildren)
 		child.OrientateWithChildren(static_cast<Winding>(windingChildren));
 }
 
@@ -389,6 +412,198 @@ void Elite::Polygon::ExpandShape(float amount)
 	//Overwrite data
 	m_vPoints = adjustedPoints;
 }
+
+void Elite::Polygon::WriteTriangulation(std::ostream& stream, bool includeTriangleGrid) const
+{
+	//Vertices are shared by the triangles and lines, both refer to them by index
+	vector<Vector2> vertices = {};
+	map<pair<float, float>, int> vertexIndices = {};
+	const auto getVertexIndex = [&vertices, &vertexIndices](const Vector2& v)
+	{
+		const auto result = vertexIndices.insert({ { v.x, v.y }, static_cast<int>(vertices.size()) });
+		if (result.second)
+			vertices.push_back(v);
+		return result.first->second;
+	};
+
+	vector<int> triangleVertices = {};
+	vector<int> triangleLines = {};
+	for (auto t : m_vpTriangles)
+	{
+		for (const Vector2& p : { t->p1, t->p2, t->p3 })
+			triangleVertices.push_back(getVertexIndex(p));
+#ifdef USE_TRIANGLE_METADATA
+		triangleLines.insert(triangleLines.end(), t->metaData.IndexLines.begin(), t->metaData.IndexLines.end());
+#endif
+	}
+
+	vector<int> lineVertices = {};
+	for (auto l : m_vpLines)
+	{
+		lineVertices.push_back(getVertexIndex(l->p1));
+		lineVertices.push_back(getVertexIndex(l->p2));
+	}
+
+	WriteBinaryArray(stream, vertices);
+	WriteBinaryArray(stream, triangleVertices);
+	WriteBinaryArray(stream, triangleLines);
+	WriteBinaryArray(stream, lineVertices);
+#ifdef USE_TRIANGLE_METADATA
+	WriteBinaryArray(stream, m_LineTriangleStarts);
+	WriteBinaryArray(stream, m_LineTriangles);
+#else
+	WriteBinaryArray(stream, vector<int>{});
+	WriteBinaryArray(stream, vector<int>{});
+#endif
+
+	WriteBinary(stream, includeTriangleGrid);
+	if (includeTriangleGrid)
+	{
+		WriteBinary(stream, m_TriangleGridOrigin);
+		WriteBinary(stream, m_TriangleGridCellSize);
+		WriteBinary(stream, m_TriangleGridColumns);
+		WriteBinary(stream, m_TriangleGridRows);
+		WriteBinaryArray(stream, m_TriangleGridCellStarts);
+		WriteBinaryArray(stream, m_TriangleGridTriangles);
+	}
+}
+
+bool Elite::Polygon::ReadTriangulation(std::istream& stream)
+{
+	vector<Vector2> vertices = {};
+	vector<int> triangleVertices = {};
+	vector<int> triangleLines = {};
+	vector<int> lineVertices = {};
+	vector<int> lineTriangleStarts = {};
+	vector<int> lineTriangles = {};
+	if (!ReadBinaryArray(stream, vertices) || !ReadBinaryArray(stream, triangleVertices) || !ReadBinaryArray(stream, triangleLines)
+		|| !ReadBinaryArray(stream, lineVertices) || !ReadBinaryArray(stream, lineTriangleStarts) || !ReadBinaryArray(stream, lineTriangles))
+		return false;
+
+	const int nrOfVertices = static_cast<int>(vertices.size());
+	const int nrOfTriangles = static_cast<int>(triangleVertices.size() / 3);
+	const int nrOfLines = static_cast<int>(lineVertices.size() / 2);
+	const auto isIndexValid = [](const vector<int>& indices, int count)
+	{
+		return all_of(indices.begin(), indices.end(), [count](int idx) { return idx >= 0 && idx < count; });
+	};
+
+	//Every index is checked, so a damaged file can't make the lookups go out of range
+	if (triangleVertices.size() % 3 != 0 || lineVertices.size() % 2 != 0
+		|| !isIndexValid(triangleVertices, nrOfVertices) || !isIndexValid(lineVertices, nrOfVertices)
+		|| !all_of(vertices.begin(), vertices.end(), [](const Vector2& v) { return isfinite(v.x) && isfinite(v.y); }))
+		return false;
+#ifdef USE_TRIANGLE_METADATA
+	if (triangleLines.size() != triangleVertices.size() || !isIndexValid(triangleLines, nrOfLines)
+		|| lineTriangleStarts.size() != static_cast<size_t>(nrOfLines + 1) || !isIndexValid(lineTriangles, nrOfTriangles)
+		|| lineTriangleStarts.front() != 0 || lineTriangleStarts.back() != static_cast<int>(lineTriangles.size())
+		|| !is_sorted(lineTriangleStarts.begin(), lineTriangleStarts.end()))
+		return false;
+#endif
+
+	bool hasTriangleGrid = false;
+	Vector2 gridOrigin = {};
+	float gridCellSize = 0.f;
+	int gridColumns = 0;
+	int gridRows = 0;
+	vector<int> gridCellStarts = {};
+	vector<int> gridTriangles = {};
+	if (!ReadBinary(stream, hasTriangleGrid))
+		return false;
+	if (hasTriangleGrid)
+	{
+		if (!ReadBinary(stream, gridOrigin) || !ReadBinary(stream, gridCellSize) || !ReadBinary(stream, gridColumns) || !ReadBinary(stream, gridRows)
+			|| !ReadBinaryArray(stream, gridCellStarts) || !ReadBinaryArray(stream, gridTriangles))
+			return false;
+
+		const bool isGridEmpty = gridColumns == 0 && gridRows == 0 && gridCellStarts.empty();
+		if (!isGridEmpty && (gridColumns <= 0 || gridRows <= 0 || !isfinite(gridCellSize) || gridCellSize <= 0.f
+			|| !isfinite(gridOrigin.x) || !isfinite(gridOrigin.y)
+			|| gridCellStarts.size() != static_cast<size_t>(gridColumns) * gridRows + 1 || !isIndexValid(gridTriangles, nrOfTriangles)
+			|| gridCellStarts.front() != 0 || gridCellStarts.back() != static_cast<int>(gridTriangles.size())
+			|| !is_sorted(gridCellStarts.begin(), gridCellStarts.end())))
+			return false;
+	}
+
+	//Replace the current triangulation, the pointers are set up from the indices in one pass
+	for (auto t : m_vpTriangles)
+		SAFE_DELETE(t);
+	m_vpTriangles.clear();
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+	m_vpLines.clear();
+
+	m_vpTriangles.reserve(nrOfTriangles);
+	for (int i = 0; i < nrOfTriangles; ++i)
+	{
+		Triangle* pTriangle = new Triangle(vertices[triangleVertices[i * 3]], vertices[triangleVertices[i * 3 + 1]], vertices[triangleVertices[i * 3 + 2]]);
+#ifdef USE_TRIANGLE_METADATA
+		pTriangle->metaData.IndexLines = { { triangleLines[i * 3], triangleLines[i * 3 + 1], triangleLines[i * 3 + 2] } };
+#endif
+		m_vpTriangles.push_back(pTriangle);
+	}
+
+	m_vpLines.reserve(nrOfLines);
+	for (int i = 0; i < nrOfLines; ++i)
+		m_vpLines.push_back(new Line(vertices[lineVertices[i * 2]], vertices[lineVertices[i * 2 + 1]], i));
+
+#ifdef USE_TRIANGLE_METADATA
+	m_LineIndices.clear();
+	m_LineIndices.reserve(nrOfLines);
+	for (auto l : m_vpLines)
+		m_LineIndices.insert({ GetLineKey(l->p1, l->p2), l->index });
+	m_LineTriangleStarts = std::move(lineTriangleStarts);
+	m_LineTriangles = std::move(lineTriangles);
+#endif
+
+	if (hasTriangleGrid)
+	{
+		m_TriangleGridOrigin = gridOrigin;
+		m_TriangleGridCellSize = gridCellSize;
+		m_TriangleGridColumns = gridColumns;
+		m_TriangleGridRows = gridRows;
+		m_TriangleGridCellStarts = std::move(gridCellStarts);
+		m_TriangleGridTriangles = std::move(gridTriangles);
+	}
+	else
+		BuildTriangleGrid();
+
+	m_isTriangulated = true;
+	return true;
+}
+
+uint64_t Elite::Polygon::GetShapeHash() const
+{
+	//FNV-1a over the bits of every coordinate, the amount of points separates the shapes
+	uint64_t hash = 14695981039346656037ull;
+	const auto addToHash = [&hash](uint32_t value)
+	{
+		for (int byte = 0; byte < 4; ++byte)
+		{
+			hash ^= (value >> (byte * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	};
+
+	addToHash(static_cast<uint32_t>(m_vPoints.size()));
+	for (const Vector2& p : m_vPoints)
+	{
+		uint32_t bits[2];
+		memcpy(bits, &p, sizeof(bits));
+		addToHash(bits[0]);
+		addToHash(bits[1]);
+	}
+
+	addToHash(static_cast<uint32_t>(m_vChildren.size()));
+	for (const auto& child : m_vChildren)
+	{
+		const uint64_t childHash = child.GetShapeHash();
+		addToHash(static_cast<uint32_t>(childHash));
+		addToHash(static_cast<uint32_t>(childHash >> 32));
+	}
+
+	return hash;
+}
 #pragma endregion //TriangulationFunctions
 //----------------------------------------------------------
 #pragma region PrivateGeneralFunctions
@@ -411,239 +626,516 @@ void Elite::Polygon::GetTriangle(const list<Vector2>& l, const list<Vector2>::co
 	next = *n;
 }
 
-bool Elite::Polygon::IsConvexInPolygon(const list<Vector2>& l, const list<Vector2>::const_iterator p) const
+void Elite::Polygon::GenerateLineMatrix()
 {
-	//Look at the point list of this polygon as it where a circular list (end attach begin)
-	Vector2 current, prev, next;
-	GetTriangle(l, p, current, prev, next);
-	return IsConvex(current, prev, next);
-}
+#ifdef USE_TRIANGLE_METADATA
+	//Start over, the lines of old triangles don't exist anymore
+	for (auto l : m_vpLines)
+		SAFE_DELETE(l);
+	m_vpLines.clear();
+	m_LineIndices.clear();
+	m_LineIndices.reserve(m_vpTriangles.size() * 2);
 
-bool Elite::Polygon::IsEar(const list<Vector2>& l, const list<Vector2>::const_iterator p) const
-{
-	//Look at the point list of this polygon as it where a circular list (end attach begin)
-	Vector2 current, prev, next;
-	GetTriangle(l, p, current, prev, next);
-	
-	//See if there are any vertices (excluding the ones of the triangle) are in the triangle
-	for (auto it = l.begin(); it != l.end(); ++it)
+	//Go over all the lines of all the triangles, search if they are already in the matrix (by their points)
+	//If not add them and store it's index in the triangles meta data
+	for (auto t : m_vpTriangles)
 	{
-		if (*it == current || *it == prev || *it == next)
-			continue;
+		const Vector2* points[3] = { &t->p1, &t->p2, &t->p3 };
+		for (int i = 0; i < 3; ++i)
+		{
+			const Vector2& p1 = *points[i];
+			const Vector2& p2 = *points[(i + 1) % 3];
 
-		if (PointInTriangle(*it, current, prev, next))
-			return false;
+			const auto result = m_LineIndices.insert({ GetLineKey(p1, p2), static_cast<int>(m_vpLines.size()) });
+			if (result.second) //Not found, add to matrix
+				m_vpLines.push_back(new Line(p1, p2, result.first->second));
+			t->metaData.IndexLines[i] = result.first->second;
+		}
 	}
-	return true;
+
+	//Triangles per line: count them, then fill the lines in triangle order
+	m_LineTriangleStarts.assign(m_vpLines.size() + 1, 0);
+	for (auto t : m_vpTriangles)
+	{
+		for (const int lineIndex : t->metaData.IndexLines)
+			++m_LineTriangleStarts[lineIndex + 1];
+	}
+	for (size_t line = 1; line < m_LineTriangleStarts.size(); ++line)
+		m_LineTriangleStarts[line] += m_LineTriangleStarts[line - 1];
+
+	std::vector<int> lineEnds(m_LineTriangleStarts.begin(), m_LineTriangleStarts.end() - 1);
+	m_LineTriangles.resize(m_LineTriangleStarts.back());
+	for (int triangleIdx = 0; triangleIdx < static_cast<int>(m_vpTriangles.size()); ++triangleIdx)
+	{
+		for (const int lineIndex : m_vpTriangles[triangleIdx]->metaData.IndexLines)
+			m_LineTriangles[lineEnds[lineIndex]++] = triangleIdx;
+	}
+#endif
 }
 
-void Elite::Polygon::GenerateLineMatrix()
-{
 #ifdef USE_TRIANGLE_METADATA
-	//Go over all the triangles
+Elite::Polygon::LineKey Elite::Polygon::GetLineKey(const Vector2& p1, const Vector2& p2)
+{
+	if (p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y))
+		return { p1, p2 };
+	return { p2, p1 };
+}
+
+size_t Elite::Polygon::LineKeyHash::operator()(const LineKey& key) const
+{
+	//Combine the hashes of the four coordinates (boost::hash_combine)
+	size_t seed = 0;
+	for (const float coordinate : { key.first.x, key.first.y, key.second.x, key.second.y })
+		seed ^= std::hash<float>()(coordinate) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+#endif
+
+void Elite::Polygon::BuildTriangleGrid()
+{
+	m_TriangleGridCellStarts.clear();
+	m_TriangleGridTriangles.clear();
+	m_TriangleGridColumns = 0;
+	m_TriangleGridRows = 0;
+
+	if (m_vpTriangles.empty())
+		return;
+
+	//Bounds of all triangles
+	Vector2 minPos{ FLT_MAX, FLT_MAX };
+	Vector2 maxPos{ -FLT_MAX, -FLT_MAX };
 	for (auto t : m_vpTriangles)
 	{
-		//Go over all the lines of the triangle, search if they are already in the matrix
-		//If not add them and store it's index in the triangles meta data
-		const Line l1{ t->p1, t->p2 };
-		const Line l1rev{ t->p2, t->p1 };
-		const Line l2{ t->p2, t->p3 };
-		const Line l2rev{ t->p3, t->p2 };
-		const Line l3{ t->p3, t->p1 };
-		const Line l3rev{ t->p1, t->p3 };
-		for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
+		for (const Vector2& p : { t->p1, t->p2, t->p3 })
 		{
-			const auto l = m_vpLines[i];
-			if (*l == l1 || *l == l1rev)
-				t->metaData.IndexLines[0] = i;
-			if (*l == l2 || *l == l2rev)
-				t->metaData.IndexLines[1] = i;
-			if (*l == l3 || *l == l3rev)
-				t->metaData.IndexLines[2] = i;
-		}
-		//Not found, add to matrix
-		if (t->metaData.IndexLines[0] == -1)
-		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p1, t->p2, index));
-			t->metaData.IndexLines[0] = index;
-		}
-		if (t->metaData.IndexLines[1] == -1)
-		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p2, t->p3, index));
-			t->metaData.IndexLines[1] = index;
-		}
-		if (t->metaData.IndexLines[2] == -1)
-		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p3, t->p1, index));
-			t->metaData.IndexLines[2] = index;
+			minPos = Vector2{ min(minPos.x, p.x), min(minPos.y, p.y) };
+			maxPos = Vector2{ max(maxPos.x, p.x), max(maxPos.y, p.y) };
 		}
 	}
-#endif
+
+	//On average about one triangle per cell
+	const Vector2 size = maxPos - minPos;
+	const float area = size.x * size.y;
+	m_TriangleGridCellSize = area > 0.f ? sqrtf(area / m_vpTriangles.size()) : max(max(size.x, size.y), 1.f);
+	//Long thin meshes would get more columns or rows than triangles
+	m_TriangleGridCellSize = max(m_TriangleGridCellSize, max(size.x, size.y) / m_vpTriangles.size());
+	m_TriangleGridOrigin = minPos;
+	m_TriangleGridColumns = static_cast<int>(size.x / m_TriangleGridCellSize) + 1;
+	m_TriangleGridRows = static_cast<int>(size.y / m_TriangleGridCellSize) + 1;
+
+	//Cells overlapped by the bounding box of every triangle, with the same margin as PointInTriangleBoundingBox
+	std::vector<std::array<int, 4>> triangleCells{};
+	triangleCells.reserve(m_vpTriangles.size());
+	for (auto t : m_vpTriangles)
+	{
+		triangleCells.push_back({ {
+			GetTriangleGridColumn(min(t->p1.x, min(t->p2.x, t->p3.x)) - FLT_EPSILON),
+			GetTriangleGridColumn(max(t->p1.x, max(t->p2.x, t->p3.x)) + FLT_EPSILON),
+			GetTriangleGridRow(min(t->p1.y, min(t->p2.y, t->p3.y)) - FLT_EPSILON),
+			GetTriangleGridRow(max(t->p1.y, max(t->p2.y, t->p3.y)) + FLT_EPSILON) } });
+	}
+
+	//Count the triangles per cell, then fill the cells in triangle order (lookups find the same triangle as a linear search)
+	m_TriangleGridCellStarts.assign(m_TriangleGridColumns * m_TriangleGridRows + 1, 0);
+	for (const auto& cells : triangleCells)
+	{
+		for (int row = cells[2]; row <= cells[3]; ++row)
+			for (int column = cells[0]; column <= cells[1]; ++column)
+				++m_TriangleGridCellStarts[row * m_TriangleGridColumns + column + 1];
+	}
+	for (size_t cell = 1; cell < m_TriangleGridCellStarts.size(); ++cell)
+		m_TriangleGridCellStarts[cell] += m_TriangleGridCellStarts[cell - 1];
+
+	std::vector<int> cellEnds(m_TriangleGridCellStarts.begin(), m_TriangleGridCellStarts.end() - 1);
+	m_TriangleGridTriangles.resize(m_TriangleGridCellStarts.back());
+	for (int triangleIdx = 0; triangleIdx < static_cast<int>(triangleCells.size()); ++triangleIdx)
+	{
+		const auto& cells = triangleCells[triangleIdx];
+		for (int row = cells[2]; row <= cells[3]; ++row)
+			for (int column = cells[0]; column <= cells[1]; ++column)
+				m_TriangleGridTriangles[cellEnds[row * m_TriangleGridColumns + column]++] = triangleIdx;
+	}
+}
+
+int Elite::Polygon::GetTriangleGridColumn(float x) const
+{
+	return static_cast<int>(Clamp(floorf((x - m_TriangleGridOrigin.x) / m_TriangleGridCellSize), 0.f, static_cast<float>(m_TriangleGridColumns - 1)));
+}
+
+int Elite::Polygon::GetTriangleGridRow(float y) const
+{
+	return static_cast<int>(Clamp(floorf((y - m_TriangleGridOrigin.y) / m_TriangleGridCellSize), 0.f, static_cast<float>(m_TriangleGridRows - 1)));
 }
 #pragma endregion //PrivateGeneralFunctions
 //----------------------------------------------------------
 #pragma region PrivateTriangulationFunctions
-void Elite::Polygon::FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner)
-{
-	//1. Find vertex with the biggest x value of the inner polygon AND biggest x value of outer polygon (used for size ray)
-	const auto maxInnerPoint = std::max_element(inner.m_vPoints.begin(), inner.m_vPoints.end(),
-		[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
-
-	const auto maxOuterPoint = std::max_element(outer.m_vPoints.begin(), outer.m_vPoints.end(),
-		[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
-	const float rayMaxX = maxOuterPoint->x;
-
-	//Store inner point to output
-	pInner = *maxInnerPoint;
-
-	// --- 2. Based on found inner point, find mutually visisble outer point
-	//2.1 Intersect ray M + t(1,0) with all directed edges of OUTER (M is left of edges) - Result point I
-	//http://stackoverflow.com/questions/563198/how-do-you-detect-where-two-line-segments-intersect
-	const Vector2 furthestPointRay = Vector2(rayMaxX, maxInnerPoint->y);
-	Vector2 p = pInner;
-	Vector2 r = furthestPointRay - pInner; //Ray
-	Vector2 I = ZeroVector2; //Found intersection
-	Vector2 intersectedLine[2] = { ZeroVector2, ZeroVector2 }; //Store to find point P if I is found
-	for (auto it = outer.m_vPoints.begin(); it != outer.m_vPoints.end(); ++it)
-	{
-		const auto next = std::next(it);
-		//If on right of innerPoint AND has a next point (to make line)
-		if (it->x > maxInnerPoint->x && next != outer.m_vPoints.end())
-		{
-			//Poly line segment
-			const Vector2 q = *it;
-			Vector2 s = *next - q;
+int Elite::Polygon::FindMutualVisibleVertex(const std::vector<Vector2>& outer, const Vector2& innerPoint)
+{
+	//innerPoint (M) is the vertex with the biggest x value of the inner polygon, all inner polygons more to the right are already merged
+	//https://www.geometrictools.com/Documentation/TriangulationByEarClipping.pdf
+	const int nrOfPoints = static_cast<int>(outer.size());
+
+	//1. Intersect ray M + t(1,0) with all edges of OUTER (including the closing one) - Result point I on the closest edge
+	int intersectedEdge = -1;
+	float intersectionX = FLT_MAX;
+	for (int i = 0; i < nrOfPoints; ++i)
+	{
+		const Vector2& q = outer[i];
+		const Vector2& next = outer[(i + 1) % nrOfPoints];
 
-			//Capture parallel and collinear cases
-			if (Cross(r, s) == 0)
-			{
-				if (Cross(q - p, r) == 0) //== Collinear
-				{
-					//Get closest vertex (OR the correct way see link :)) - We don't check
-					//overlap because the max x of our ray is within the boundaries
-					if (it->x < next->x)
-						I = *it;
-					else
-						I = *next;
-				}
-				continue;
-			}
+		//Parallel edges are skipped, their end points are hit by the adjacent edges
+		if (q.y == next.y || (q.y < innerPoint.y && next.y < innerPoint.y) || (q.y > innerPoint.y && next.y > innerPoint.y))
+			continue;
 
-			//If not parallel or collinear, search point, calculate T and U
-			float crossRS = Cross(r, s);
-			float t = Cross(q - p, s) / crossRS;
-			float u = Cross(q - p, r) / crossRS;
+		float x = q.x + (innerPoint.y - q.y) * (next.x - q.x) / (next.y - q.y);
+		if (innerPoint.y == q.y)
+			x = q.x;
+		else if (innerPoint.y == next.y)
+			x = next.x;
 
-			//If U == 0 || u == 1, endpoints touch, else if within range also a hit
-			if (t >= 0 && t <= 1 && u >= 0 && u <= 1)
-			{
-				Vector2 tempI = p + (t * r);
-				auto distanceTemp = abs(Distance(p, tempI));
-				auto distanceI = abs(Distance(p, I));
-				//Check if closer than other intersected lines, if it is, replace stored line!
-				if (intersectedLine[0] == ZeroVector2 && intersectedLine[1] == ZeroVector2
-					|| distanceTemp < distanceI)
-				{
-					//Determine point with T and U
-					I = p + (t * r);
-					intersectedLine[0] = *it;
-					intersectedLine[1] = *next;
-				}
-			}
+		if (x >= innerPoint.x && x < intersectionX)
+		{
+			intersectionX = x;
+			intersectedEdge = i;
 		}
 	}
+	if (intersectedEdge == -1)
+		return -1;
+
+	const Vector2 I{ intersectionX, innerPoint.y };
+	const int edgeStart = intersectedEdge;
+	const int edgeEnd = (intersectedEdge + 1) % nrOfPoints;
+
+	//2. IF I is vertex of OUTER == mutually visible so terminate algorithm
+	if (outer[edgeStart] == I)
+		return GetLocallyInsideVertex(outer, edgeStart, innerPoint);
+	if (outer[edgeEnd] == I)
+		return GetLocallyInsideVertex(outer, edgeEnd, innerPoint);
+
+	//3. ELSE I is interior point on edge, select vertex with maximum x value of the hit edge - Result point P
+	int visibleIdx = outer[edgeStart].x > outer[edgeEnd].x ? edgeStart : edgeEnd;
+	const Vector2 P = outer[visibleIdx];
+
+	//4. Reflex vertices inside (or on) triangle (M,I,P) block the view on P. Take the one that minimizes the angle
+	//between (1,0) and (M,R), on equal angles the closest one
+	float smallestSlope = FLT_MAX;
+	float smallestDistance = FLT_MAX;
+	for (int i = 0; i < nrOfPoints; ++i)
+	{
+		const Vector2& r = outer[i];
+		if (r == P || IsConvex(r, outer[(i + nrOfPoints - 1) % nrOfPoints], outer[(i + 1) % nrOfPoints]))
+			continue;
+		if (!IsInsideTriangle(r, innerPoint, I, P))
+			continue;
 
-	//2.2 IF I is vertex of OUTER == mutually visisble so terminate algorithm
-	const auto IOuter = std::find(outer.m_vPoints.begin(), outer.m_vPoints.end(), I);
-	if (IOuter != outer.m_vPoints.end()) //Point is vertex of outer, so I is correct vertex!
+		const Vector2 toReflex = r - innerPoint;
+		const float slope = abs(toReflex.y) / toReflex.x;
+		if (slope < smallestSlope || (slope == smallestSlope && toReflex.x < smallestDistance))
+		{
+			smallestSlope = slope;
+			smallestDistance = toReflex.x;
+			visibleIdx = i;
+		}
+	}
+	return GetLocallyInsideVertex(outer, visibleIdx, innerPoint);
+}
+
+int Elite::Polygon::GetLocallyInsideVertex(const std::vector<Vector2>& points, int index, const Vector2& target)
+{
+	//Merged holes duplicate their bridge vertices, only one of the duplicates has the target on it's inner side
+	//(on the inner side of both edges of a convex vertex, or of one of the edges of a reflex vertex)
+	const int nrOfPoints = static_cast<int>(points.size());
+	const auto isLocallyInside = [&](int i)
 	{
-		pOuter = I;
-		return;
+		const Vector2& prev = points[(i + nrOfPoints - 1) % nrOfPoints];
+		const Vector2& current = points[i];
+		const Vector2& next = points[(i + 1) % nrOfPoints];
+		const bool insidePrevEdge = Cross(current - prev, target - current) > 0.f;
+		const bool insideNextEdge = Cross(next - current, target - current) > 0.f;
+		if (IsConvex(current, prev, next))
+			return insidePrevEdge && insideNextEdge;
+		return insidePrevEdge || insideNextEdge;
+	};
+
+	if (isLocallyInside(index))
+		return index;
+	for (int i = 0; i < nrOfPoints; ++i)
+	{
+		if (i != index && points[i] == points[index] && isLocallyInside(i))
+			return i;
 	}
+	return index;
+}
 
-	//2.3 ELSE I is interior point on edge, select vertex with maximum x value of the hitted edge - Result point P
-	Vector2 P = intersectedLine[(intersectedLine[0].x > intersectedLine[1].x ? 0 : 1)];
-	
-	//2.4 Search for reflex vertices (excluding P if it's a reflex)
-	std::list<Vector2> reflexVertices;
-	for (auto it = outer.m_vPoints.begin(); it != outer.m_vPoints.end(); ++it)
+bool Elite::Polygon::IsInsideTriangle(const Vector2& point, const Vector2& p1, const Vector2& p2, const Vector2& p3)
+{
+	//The point is on the same side of all edges (or on them). Unlike the barycentric coordinates of PointInTriangle
+	//this stays accurate for the long thin triangles that ear clipping and bridges create
+	const float side1 = Cross(p2 - p1, point - p1);
+	const float side2 = Cross(p3 - p2, point - p2);
+	const float side3 = Cross(p1 - p3, point - p3);
+	const bool hasNegative = side1 < 0.f || side2 < 0.f || side3 < 0.f;
+	const bool hasPositive = side1 > 0.f || side2 > 0.f || side3 > 0.f;
+	return !(hasNegative && hasPositive);
+}
+
+void Elite::Polygon::Split(std::vector<Vector2>& points) const
+{
+	//Collect the holes: the children (wound CW) and their children, which are also treated as holes of this polygon
+	std::vector<std::vector<Vector2>> holes;
+	std::vector<const Polygon*> vpChildren;
+	for (const auto& child : m_vChildren)
+		vpChildren.push_back(&child);
+	while (!vpChildren.empty())
 	{
-		if (*it == P)
+		const Polygon* pChild = vpChildren.back();
+		vpChildren.pop_back();
+		for (const auto& grandChild : pChild->m_vChildren)
+			vpChildren.push_back(&grandChild);
+
+		if (pChild->m_vPoints.size() < 3)
 			continue;
+		std::vector<Vector2> hole(pChild->m_vPoints.begin(), pChild->m_vPoints.end());
+		if (GetPolygonWinding(hole) != Winding::CW)
+			std::reverse(hole.begin(), hole.end());
+		holes.push_back(hole);
+	}
 
-		if (!outer.IsConvexInPolygon(outer.m_vPoints, it))
-			reflexVertices.push_back(*it);
+	//Sort the children from right to left (vertices are what matters, not the "center" pos of the polygon!). A hole can then
+	//only be blocked by the outer shape and the holes that are already merged into it
+	std::vector<std::pair<int, float>> holeOrder; //Index of the vertex with the biggest x value, and that x value
+	for (const auto& hole : holes)
+	{
+		const auto maxPoint = std::max_element(hole.begin(), hole.end(),
+			[](const Vector2& p1, const Vector2& p2) { return p1.x < p2.x; });
+		holeOrder.push_back({ static_cast<int>(maxPoint - hole.begin()), maxPoint->x });
 	}
+	std::vector<int> sortedHoles(holes.size());
+	for (int i = 0; i < static_cast<int>(sortedHoles.size()); ++i)
+		sortedHoles[i] = i;
+	std::sort(sortedHoles.begin(), sortedHoles.end(),
+		[&holeOrder](int h1, int h2) { return holeOrder[h1].second > holeOrder[h2].second; });
+
+	std::vector<Vector2> mergedPoints;
+	for (const int holeIdx : sortedHoles)
+	{
+		const auto& hole = holes[holeIdx];
+		const int innerIdx = holeOrder[holeIdx].first;
 
-	//2.5 IF all reflex vertices are OUTSIDE of triangle (M,I,P), then P is mutually visible == terminate algorithm
-	std::vector<Vector2> pointsInTriangle;
-	for (auto it = reflexVertices.begin(); it != reflexVertices.end(); ++it)
+		//Find mutually visible vertices
+		const int outerIdx = FindMutualVisibleVertex(points, hole[innerIdx]);
+		if (outerIdx == -1)
+		{
+			std::cout << "WARNING: child polygon is not inside it's parent, it is ignored for triangulation!" << std::endl;
+			continue;
+		}
+
+		//Insert the child polygon vertices AFTER the outer vertex, starting from the inner vertex untill we've reached it again.
+		//End by "duplicating" both the inner and outer vertex, which links this back to the outer vertex
+		const int nrOfHolePoints = static_cast<int>(hole.size());
+		mergedPoints.clear();
+		mergedPoints.reserve(points.size() + nrOfHolePoints + 2);
+		mergedPoints.insert(mergedPoints.end(), points.begin(), points.begin() + outerIdx + 1);
+		for (int i = 0; i <= nrOfHolePoints; ++i)
+			mergedPoints.push_back(hole[(innerIdx + i) % nrOfHolePoints]);
+		mergedPoints.push_back(points[outerIdx]);
+		mergedPoints.insert(mergedPoints.end(), points.begin() + outerIdx + 1, points.end());
+		points.swap(mergedPoints);
+	}
+}
+
+void Elite::Polygon::ClipEars(const std::vector<Vector2>& points)
+{
+	//The remaining polygon is a ring of indices in points, removing an ear only relinks it's neighbours
+	const int nrOfPoints = static_cast<int>(points.size());
+	if (nrOfPoints < 3)
+		return;
+
+	std::vector<int> previous(nrOfPoints);
+	std::vector<int> next(nrOfPoints);
+	std::vector<bool> isReflex(nrOfPoints);
+	std::vector<bool> isRemoved(nrOfPoints, false);
+	Vector2 minPos{ FLT_MAX, FLT_MAX };
+	Vector2 maxPos{ -FLT_MAX, -FLT_MAX };
+	for (int i = 0; i < nrOfPoints; ++i)
 	{
-		if (PointInTriangle(*it, pInner, I, P))
-			pointsInTriangle.push_back(*it);
+		previous[i] = (i + nrOfPoints - 1) % nrOfPoints;
+		next[i] = (i + 1) % nrOfPoints;
+		isReflex[i] = !IsConvex(points[i], points[previous[i]], points[next[i]]);
+		minPos = Vector2{ min(minPos.x, points[i].x), min(minPos.y, points[i].y) };
+		maxPos = Vector2{ max(maxPos.x, points[i].x), max(maxPos.y, points[i].y) };
 	}
 
-	if (pointsInTriangle.size() == 0)
+	//Only reflex vertices can be inside an ear, so they are put in a grid and an ear only checks the ones near it.
+	//Clipping an ear never turns a convex vertex into a reflex one, so vertices that became convex are skipped instead of removed
+	const Vector2 size = maxPos - minPos;
+	const float cellSize = max(max(size.x, size.y) / max(sqrtf(static_cast<float>(nrOfPoints)), 1.f), FLT_EPSILON);
+	const int nrOfColumns = static_cast<int>(size.x / cellSize) + 1;
+	const int nrOfRows = static_cast<int>(size.y / cellSize) + 1;
+	const auto getColumn = [&](float x) { return static_cast<int>(Clamp(floorf((x - minPos.x) / cellSize), 0.f, static_cast<float>(nrOfColumns - 1))); };
+	const auto getRow = [&](float y) { return static_cast<int>(Clamp(floorf((y - minPos.y) / cellSize), 0.f, static_cast<float>(nrOfRows - 1))); };
+
+	std::vector<int> cellStarts;
+	std::vector<int> cellVertices;
+	const auto buildReflexGrid = [&](int start)
 	{
-		pOuter = P;
-		return;
+		//Count the reflex vertices of the ring per cell, then fill the cells
+		cellStarts.assign(nrOfColumns * nrOfRows + 1, 0);
+		int i = start;
+		do
+		{
+			if (isReflex[i])
+				++cellStarts[getRow(points[i].y) * nrOfColumns + getColumn(points[i].x) + 1];
+			i = next[i];
+		} while (i != start);
+		for (size_t cell = 1; cell < cellStarts.size(); ++cell)
+			cellStarts[cell] += cellStarts[cell - 1];
+
+		std::vector<int> cellEnds(cellStarts.begin(), cellStarts.end() - 1);
+		cellVertices.resize(cellStarts.back());
+		do
+		{
+			if (isReflex[i])
+				cellVertices[cellEnds[getRow(points[i].y) * nrOfColumns + getColumn(points[i].x)]++] = i;
+			i = next[i];
+		} while (i != start);
+	};
+	buildReflexGrid(0);
+
+	//Bridges duplicate vertices. The polygon touches itself there, so a convex neighbour of a duplicate can be inside an ear on the
+	//other side, those are checked as well. Duplicates are linked in a ring per position
+	std::vector<int> nextDuplicate(nrOfPoints);
+	std::vector<int> sortedPoints(nrOfPoints);
+	for (int i = 0; i < nrOfPoints; ++i)
+		sortedPoints[i] = nextDuplicate[i] = i;
+	std::sort(sortedPoints.begin(), sortedPoints.end(), [&points](int i1, int i2)
+		{ return points[i1].x < points[i2].x || (points[i1].x == points[i2].x && points[i1].y < points[i2].y); });
+	for (int first = 0, last = 0; first < nrOfPoints; first = last)
+	{
+		for (last = first + 1; last < nrOfPoints && points[sortedPoints[last]] == points[sortedPoints[first]]; ++last)
+			nextDuplicate[sortedPoints[last - 1]] = sortedPoints[last];
+		nextDuplicate[sortedPoints[last - 1]] = sortedPoints[first];
 	}
 
-	//2.6 ELSE at least one reflex vertex lies in triangle (M,I,P). Search for reflex R that minimizes the angle
-	//between (1,0) and the line (M,R). If found more choose one, else use the one found and terminate algorithm
-	auto smallestAngle = 2 * M_PI;
-	for (const auto point : pointsInTriangle)
+	const auto isEar = [&](int i)
+	{
+		const Vector2& current = points[i];
+		const Vector2& prev = points[previous[i]];
+		const Vector2& nxt = points[next[i]];
+		if (!IsConvex(current, prev, nxt))
+			return false;
+
+		//See if there are any vertices (excluding the ones of the triangle, and their duplicates) in the triangle or on it's edges
+		const int minColumn = getColumn(min(current.x, min(prev.x, nxt.x)) - FLT_EPSILON);
+		const int maxColumn = getColumn(max(current.x, max(prev.x, nxt.x)) + FLT_EPSILON);
+		const int minRow = getRow(min(current.y, min(prev.y, nxt.y)) - FLT_EPSILON);
+		const int maxRow = getRow(max(current.y, max(prev.y, nxt.y)) + FLT_EPSILON);
+		for (int row = minRow; row <= maxRow; ++row)
+		{
+			for (int column = minColumn; column <= maxColumn; ++column)
+			{
+				const int cell = row * nrOfColumns + column;
+				for (int c = cellStarts[cell]; c < cellStarts[cell + 1]; ++c)
+				{
+					const int r = cellVertices[c];
+					if (!isReflex[r] || points[r] == current || points[r] == prev || points[r] == nxt)
+						continue;
+
+					if (IsInsideTriangle(points[r], current, prev, nxt))
+						return false;
+				}
+			}
+		}
+
+		for (const int corner : { previous[i], i, next[i] })
+		{
+			for (int d = nextDuplicate[corner]; d != corner; d = nextDuplicate[d])
+			{
+				if (isRemoved[d])
+					continue;
+				for (const int neighbour : { previous[d], next[d] })
+				{
+					const Vector2& point = points[neighbour];
+					if (point != current && point != prev && point != nxt && IsInsideTriangle(point, current, prev, nxt))
+						return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	//Removes a vertex from the ring, returns true when one of it's neighbours became reflex
+	const auto removeVertex = [&](int i)
 	{
-		//Angle between r and (M,p)
-		Vector2 seg = point - p;
-		auto angle = acos((Dot(seg, r)) / (seg.Magnitude() * r.Magnitude()));
-		if (angle < smallestAngle)
+		const int prev = previous[i];
+		const int nxt = next[i];
+		next[prev] = nxt;
+		previous[nxt] = prev;
+		isReflex[i] = false;
+		isRemoved[i] = true;
+
+		bool becameReflex = false;
+		for (const int neighbour : { prev, nxt })
 		{
-			smallestAngle = angle;
-			pOuter = point;
+			const bool reflex = !IsConvex(points[neighbour], points[previous[neighbour]], points[next[neighbour]]);
+			becameReflex = becameReflex || (reflex && !isReflex[neighbour]);
+			isReflex[neighbour] = reflex;
 		}
-	}
-}
+		return becameReflex;
+	};
 
-void Elite::Polygon::Split()
-{
-	//Temporary new children vector
-	std::vector<Polygon> newChildren;
-	//Split polygon into pieces based on it's children (holes)
-	for (auto child : m_vChildren)
+	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
+	int nrOfRemainingPoints = nrOfPoints;
+	int current = 0;
+	int nrOfVisitedPoints = 0;
+	while (nrOfRemainingPoints > 3)
 	{
-		//Find mutually visible vertices
-		Vector2 pInner, pOuter;
-		FindMutualVisibleVertices(*this, child, pOuter, pInner);
-		//Based on mutually visible vertices, merge meshes at the split
-		const auto itOuter = std::find(m_vPoints.begin(), m_vPoints.end(), pOuter); //Find where to start inserting
-		const auto itInner = std::find(child.m_vPoints.begin(), child.m_vPoints.end(), pInner);
-		//insert child polygon vertices to outer starting from the found inner vertex
-		std::list<Vector2> mergeableChild;
-		for (auto it = itInner; it != child.m_vPoints.end(); ++it)
-			mergeableChild.push_back(*it);
-		for (auto it = child.m_vPoints.begin(); it != itInner; ++it)
-			mergeableChild.push_back(*it);
-		//End by "duplicating" both the inner and outer vertex
-		mergeableChild.push_back(*itInner);
-		mergeableChild.push_back(*itOuter);
-
-		//untill we've reached it again, and link this back to the outer vertex
-		m_vPoints.insert(std::next(itOuter), mergeableChild.begin(), mergeableChild.end()); //insert AFTER itOuter (so next)
-
-		//Add it's children as new children of this newly generated polygon. We remove the old ones later
-		for (auto newChild : child.m_vChildren)
+		if (isEar(current))
+		{
+			//Push triangle
+			m_vpTriangles.push_back(new Triangle(points[previous[current]], points[current], points[next[current]]));
+
+			const int nxt = next[current];
+			if (removeVertex(current))
+				buildReflexGrid(nxt);
+			--nrOfRemainingPoints;
+			current = nxt;
+			nrOfVisitedPoints = 0;
+			continue;
+		}
+
+		current = next[current];
+		if (++nrOfVisitedPoints < nrOfRemainingPoints)
+			continue;
+
+		//Went around without finding an ear, remove a degenerate vertex (collinear, a spike or a duplicate of it's neighbour)
+		//which only leaves a triangle without area
+		int degenerate = -1;
+		for (int i = next[current]; degenerate == -1; i = next[i])
+		{
+			if (Cross(points[i] - points[previous[i]], points[next[i]] - points[previous[i]]) == 0.f)
+				degenerate = i;
+			if (i == current)
+				break;
+		}
+
+		//Broken polygon (e.g. overlapping holes), stop with the triangles found so far
+		if (degenerate == -1)
 		{
-			newChild.OrientateWithChildren(Winding::CW);
-			newChildren.push_back(newChild);
+			std::cout << "WARNING: no ear left to clip, triangulation is incomplete!" << std::endl;
+			return;
 		}
+
+		current = next[degenerate];
+		if (removeVertex(degenerate))
+			buildReflexGrid(current);
+		--nrOfRemainingPoints;
+		nrOfVisitedPoints = 0;
 	}
-	//Remove all "old" children and replace with new vector
-	m_vChildren.clear();
-	m_vChildren = newChildren;
+
+	//Add the remaining 3 vertices to the triangulated polygon, unless they are a leftover without area
+	if (IsConvex(points[current], points[previous[current]], points[next[current]]))
+		m_vpTriangles.push_back(new Triangle(points[previous[current]], points[current], points[next[current]]));
 }
 #pragma endregion //PrivateTriangulationFunctions
 //----------------------------------------------------------
@@ -9,6 +9,9 @@
 
 #include "EGeometry2DUtilities.h"
 #include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <unordered_map>
 
 
 namespace Elite 
@@ -117,8 +120,12 @@ namespace Elite
 		std::vector<Triangle*> GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const;
 
 		const Triangle* GetTriangleFromPosition(const Vector2& position, bool onLineAllowed = false) const;
+		//Triangle closest to a position that can be outside of the polygon, closestPosition is the closest point on that triangle
+		const Triangle* GetClosestTriangleFromPosition(const Vector2& position, Vector2& closestPosition) const;
 #ifdef USE_TRIANGLE_METADATA
 		const std::vector<const Triangle*> GetTrianglesFromLineIndex(unsigned int lineIndex) const;
+		//Index of the line between both points (in any direction), -1 when it isn't a line of the triangles
+		int GetLineIndex(const Vector2& p1, const Vector2& p2) const;
 #endif
 
 
@@ -128,6 +135,13 @@ namespace Elite
 		void OrientateWithChildren(Winding winding);
 		void ExpandShape(float amount);
 
+		//Baked triangulation, read back into a polygon with the same points and children instead of triangulating it.
+		//The bucket grid is optional, it is rebuilt when it wasn't written
+		void WriteTriangulation(std::ostream& stream, bool includeTriangleGrid = true) const;
+		bool ReadTriangulation(std::istream& stream);
+		//Hash of the points of the polygon and its children, to recognise data baked from the same shape
+		uint64_t GetShapeHash() const;
+
 		//=== Operators ===
 		bool operator ==(const Polygon& b) const
 		{ return this->m_vChildren == b.m_vChildren && this->m_vPoints == b.m_vPoints; }
@@ -140,16 +154,41 @@ namespace Elite
 		std::vector<Line*> m_vpLines; //Lines constructing this polygon!
 		bool m_isTriangulated = false;
 
+		//Uniform bucket grid over the triangles, baked after triangulating, so triangles can be looked up by position
+		Vector2 m_TriangleGridOrigin = {};
+		float m_TriangleGridCellSize = 0.f;
+		int m_TriangleGridColumns = 0;
+		int m_TriangleGridRows = 0;
+		std::vector<int> m_TriangleGridCellStarts; //Per cell the first entry in m_TriangleGridTriangles, plus one past the last cell
+		std::vector<int> m_TriangleGridTriangles; //Indices in m_vpTriangles of the triangles overlapping the cell (bounding box), grouped per cell
+
+#ifdef USE_TRIANGLE_METADATA
+		//Lines by their end points (ordered, so both directions give the same key) and the triangles on every line
+		using LineKey = std::pair<Vector2, Vector2>;
+		struct LineKeyHash final
+		{
+			size_t operator()(const LineKey& key) const;
+		};
+		std::unordered_map<LineKey, int, LineKeyHash> m_LineIndices;
+		std::vector<int> m_LineTriangleStarts; //Per line the first entry in m_LineTriangles, plus one past the last line
+		std::vector<int> m_LineTriangles; //Indices in m_vpTriangles, grouped per line
+		static LineKey GetLineKey(const Vector2& p1, const Vector2& p2);
+#endif
+
 		//=== Functions ===
 		//Private General Functions
 		void GetTriangle(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p, Vector2& currentTip, Vector2& previous, Vector2& next) const;
-		bool IsConvexInPolygon(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
-		bool IsEar(const std::list<Vector2>& l, const std::list<Vector2>::const_iterator p) const;
 		void GenerateLineMatrix();
+		void BuildTriangleGrid();
+		int GetTriangleGridColumn(float x) const;
+		int GetTriangleGridRow(float y) const;
 
 		//Private Triangulation Functions
-		void FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner);
-		void Split();
+		static int FindMutualVisibleVertex(const std::vector<Vector2>& outer, const Vector2& innerPoint);
+		static int GetLocallyInsideVertex(const std::vector<Vector2>& points, int index, const Vector2& target);
+		static bool IsInsideTriangle(const Vector2& point, const Vector2& p1, const Vector2& p2, const Vector2& p3);
+		void Split(std::vector<Vector2>& points) const;
+		void ClipEars(const std::vector<Vector2>& points);
 	};
 #pragma endregion //Polygon
 
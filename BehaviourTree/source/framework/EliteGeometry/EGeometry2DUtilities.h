@@ -35,12 +35,13 @@ namespace Elite
 		//	2-------1		 1-------2			 3-------2
 		//	   ??				CCW				    CW
 
-		auto signArea = 0;
+		auto signArea = 0.f;
 		for (auto it = shape.begin(); it != shape.end(); ++it)
 		{
 			auto next = std::next(it);
-			if (next != shape.end())
-				signArea += static_cast<int>((next->x - it->x) * (next->y + it->y));
+			if (next == shape.end()) //Closing edge
+				next = shape.begin();
+			signArea += (next->x - it->x) * (next->y + it->y);
 		}
 		if (signArea >= 0)
 			return CW;
@@ -0,0 +1,58 @@
+/*=============================================================================*/
+// EBinaryStream.h: Reading and writing plain values and flat arrays in binary files.
+// Arrays are stored as their element count followed by the raw elements, so a whole
+// array is read with a single read call.
+/*=============================================================================*/
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace Elite
+{
+	template <typename T>
+	void WriteBinary(std::ostream& stream, const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "<WriteBinary>: only plain values can be written");
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadBinary(std::istream& stream, T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "<ReadBinary>: only plain values can be read");
+		stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return static_cast<bool>(stream);
+	}
+
+	template <typename T>
+	void WriteBinaryArray(std::ostream& stream, const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "<WriteBinaryArray>: only plain values can be written");
+		WriteBinary(stream, static_cast<int>(values.size()));
+		stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+
+	// Returns false when the stream ends early or the count is invalid (also when it's more than the stream has left)
+	template <typename T>
+	bool ReadBinaryArray(std::istream& stream, std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "<ReadBinaryArray>: only plain values can be read");
+		int count = 0;
+		if (!ReadBinary(stream, count) || count < 0)
+			return false;
+
+		const std::streampos start = stream.tellg();
+		stream.seekg(0, std::ios::end);
+		const std::streamoff remaining = stream.tellg() - start;
+		stream.seekg(start);
+		if (!stream || remaining < static_cast<std::streamoff>(count * sizeof(T)))
+			return false;
+
+		values.resize(count);
+		stream.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+		return static_cast<bool>(stream);
+	}
+}
@@ -29,6 +29,9 @@ App_AgarioGame_BT::~App_AgarioGame_BT()
 	SAFE_DELETE(m_pContactListener);
 	SAFE_DELETE(m_pSmartAgent);
 
+	SAFE_DELETE(m_pFoodMap); // removes its listener from the grid, so before the grid
+	SAFE_DELETE(m_pFoodGrid);
+
 	for (auto pNC : m_vNavigationColliders)
 		SAFE_DELETE(pNC);
 	m_vNavigationColliders.clear();
@@ -51,13 +54,21 @@ void App_AgarioGame_BT::Start()
 	//Creating the world contact listener that informs us of collisions
 	m_pContactListener = new AgarioContactListener();
 
+	//Grid over the world for the food map, the costs are the distances between the cell centers
+	const int nrOfCells{ static_cast<int>(ceilf(m_TrimWorldSize / m_FoodGridCellSize)) };
+	m_pFoodGrid = new GridGraph<GridTerrainNode, GraphConnection>(nrOfCells, nrOfCells, m_FoodGridCellSize, false, true,
+		float(m_FoodGridCellSize), float(m_FoodGridCellSize) * sqrtf(2.f));
+	m_pFoodMap = new DijkstraMap<GridTerrainNode, GraphConnection>(m_pFoodGrid);
+
 	//Create food items
 	m_pFoodVec.reserve(m_AmountOfFood);
 	for (int i = 0; i < m_AmountOfFood; i++)
 	{
 		Elite::Vector2 randomPos = randomVector2(0.f, m_TrimWorldSize);
 		m_pFoodVec.push_back(new AgarioFood(randomPos));
+		AddFoodSource(m_pFoodVec.back());
 	}
+	m_pFoodMap->Update();
 
 	//Create agents
 	m_pAgentVec.reserve(m_AmountOfAgents);
@@ -133,6 +144,7 @@ void App_AgarioGame_BT::Update(float deltaTime)
 	m_pSmartAgent->Update(deltaTime);
 	
 	//Update the other agents and food
+	RemoveEatenFoodSources(); // while the eaten food still exists, it is deleted below
 	UpdateAgarioEntities(m_pFoodVec, deltaTime);
 	UpdateAgarioEntities(m_pAgentVec, deltaTime);
 
@@ -143,7 +155,11 @@ void App_AgarioGame_BT::Update(float deltaTime)
 	{
 		m_TimeSinceLastFoodSpawn = 0.f;
 		m_pFoodVec.push_back(new AgarioFood(randomVector2(0.f, m_TrimWorldSize)));
+		AddFoodSource(m_pFoodVec.back());
 	}
+
+	//Only repairs the cells around food that was eaten or spawned
+	m_pFoodMap->Update();
 }
 
 void App_AgarioGame_BT::Render(float deltaTime) const
@@ -169,6 +185,8 @@ Blackboard* App_AgarioGame_BT::CreateBlackboard(AgarioAgent* a)
 	pBlackboard->AddData("Agent", a);
 	pBlackboard->AddData("AgentsVec", &m_pAgentVec);
 	pBlackboard->AddData("FoodVec", &m_pFoodVec);
+	pBlackboard->AddData("FoodMap", m_pFoodMap);
+	pBlackboard->AddData("FoodSources", &m_FoodSources);
 	pBlackboard->AddData("WorldSize", m_TrimWorldSize);
 	pBlackboard->AddData("Target", Elite::Vector2{});
 	pBlackboard->AddData("AgentFleeTarget", static_cast<AgarioAgent*>(nullptr)); // Needs the cast for the type
@@ -178,6 +196,32 @@ Blackboard* App_AgarioGame_BT::CreateBlackboard(AgarioAgent* a)
 	return pBlackboard;
 }
 
+void App_AgarioGame_BT::AddFoodSource(AgarioFood* pFood)
+{
+	const int nodeIdx{ m_pFoodGrid->GetNodeIdxAtWorldPos(pFood->GetPosition()) };
+	if (nodeIdx == invalid_node_index)
+		return;
+
+	m_FoodSources[m_pFoodMap->AddSource(nodeIdx)] = pFood;
+}
+
+void App_AgarioGame_BT::RemoveEatenFoodSources()
+{
+	//Eaten food is only marked, so one pass over the sources finds it
+	for (auto it = m_FoodSources.begin(); it != m_FoodSources.end();)
+	{
+		if (it->second->CanBeDestroyed())
+		{
+			m_pFoodMap->RemoveSource(it->first);
+			it = m_FoodSources.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
 void App_AgarioGame_BT::UpdateImGui()
 {
 	//------- UI --------
@@ -209,6 +253,7 @@ void App_AgarioGame_BT::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("Food map: %d cells", m_pFoodMap->GetNrOfExpandedNodes());
 		ImGui::Unindent();
 
 		ImGui::Spacing();
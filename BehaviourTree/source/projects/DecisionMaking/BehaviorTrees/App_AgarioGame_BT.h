@@ -4,6 +4,8 @@
 // Includes & Forward Declarations
 //-----------------------------------------------------------------
 #include "framework/EliteInterfaces/EIApp.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EDijkstraMap.h"
 
 class AgarioFood;
 class AgarioAgent;
@@ -31,6 +33,12 @@ private:
 	float m_TimeSinceLastFoodSpawn{ 0.f };
 	std::vector<AgarioFood*> m_pFoodVec{};
 
+	//Walking distance to the nearest food from every cell, the smart agent looks its food up instead of checking all of it
+	const int m_FoodGridCellSize{ 5 };
+	Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>* m_pFoodGrid = nullptr;
+	Elite::DijkstraMap<Elite::GridTerrainNode, Elite::GraphConnection>* m_pFoodMap = nullptr;
+	std::unordered_map<int, AgarioFood*> m_FoodSources{}; // food per source of m_pFoodMap
+
 	AgarioContactListener* m_pContactListener = nullptr;
 	bool m_GameOver = false;
 
@@ -41,6 +49,8 @@ private:
 	void UpdateAgarioEntities(std::vector<T_AgarioType*>& entities, float deltaTime);
 
 	Elite::Blackboard* CreateBlackboard(AgarioAgent* a);
+	void AddFoodSource(AgarioFood* pFood);
+	void RemoveEatenFoodSources();
 	void UpdateImGui();
 private:
 	//C++ make the class non-copyable
@@ -10,6 +10,9 @@
 //-----------------------------------------------------------------
 #include "framework/EliteMath/EMath.h"
 #include "framework/EliteAI/EliteDecisionMaking/EliteBehaviorTree/EBehaviorTree.h"
+#include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+#include "framework/EliteAI/EliteGraphs/EGraphConnectionTypes.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EDijkstraMap.h"
 #include "projects/Shared/Agario/AgarioAgent.h"
 #include "projects/Shared/Agario/AgarioFood.h"
 #include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
@@ -93,15 +96,16 @@ namespace BT_Conditions
 	bool IsFoodNearby(Elite::Blackboard* pBlackboard)
 	{
 		AgarioAgent* pAgent;
-		std::vector<AgarioFood*>* pFoodVec;
+		Elite::DijkstraMap<Elite::GridTerrainNode, Elite::GraphConnection>* pFoodMap;
+		std::unordered_map<int, AgarioFood*>* pFoodSources;
 
 		if (!pBlackboard->GetData("Agent", pAgent) || !pAgent)
 			return false;
 
-		if (!pBlackboard->GetData("FoodVec", pFoodVec) || !pFoodVec)
+		if (!pBlackboard->GetData("FoodMap", pFoodMap) || !pFoodMap)
 			return false;
 
-		if (pFoodVec->empty())
+		if (!pBlackboard->GetData("FoodSources", pFoodSources) || !pFoodSources)
 			return false;
 
 		
@@ -110,27 +114,16 @@ namespace BT_Conditions
 
 		DEBUGRENDERER2D->DrawCircle(agentPos, searchRadius, { 1.f,0.f,0.f,1.f }, DEBUGRENDERER2D->NextDepthSlice());
 
-		float closestDistSqr{searchRadius * searchRadius};
-		AgarioFood* pClosestFood{ nullptr };
-
-		for (auto& pFood : *pFoodVec)
-		{
-			float distSqr = pFood->GetPosition().DistanceSquared(agentPos);
+		//The food map knows the nearest food of every cell and how far it is to walk there
+		if (pFoodMap->GetDistance(agentPos) > searchRadius)
+			return false;
 
-			if (distSqr < closestDistSqr)
-			{
-				closestDistSqr = distSqr;
-				pClosestFood = pFood;
-			}
-		}
+		auto foodIt = pFoodSources->find(pFoodMap->GetNearestSource(agentPos));
+		if (foodIt == pFoodSources->end())
+			return false;
 
-		if (pClosestFood)
-		{
-			pBlackboard->ChangeData("Target", pClosestFood->GetPosition());
-			return true;
-		}
-		
-		return false;
+		pBlackboard->ChangeData("Target", foodIt->second->GetPosition());
+		return true;
 
 	}
 
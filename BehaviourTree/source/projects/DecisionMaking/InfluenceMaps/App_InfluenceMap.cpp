@@ -11,6 +11,9 @@ using namespace Elite;
 App_InfluenceMap::~App_InfluenceMap()
 {
 	SAFE_DELETE(m_pInfluenceGrid);
+	SAFE_DELETE(m_pAllyStamper);
+	SAFE_DELETE(m_pEnemyStamper);
+	SAFE_DELETE(m_pGridInfluence);
 	SAFE_DELETE(m_pInfluenceGraph2D);
 }
 
@@ -27,6 +30,17 @@ void App_InfluenceMap::Start()
 	m_pInfluenceGrid->InitializeGrid(10, 10, 10, false, true);
 	m_pInfluenceGrid->InitializeBuffer();
 
+	//Left clicks add allies, right clicks enemies. Control shows the same signed influence as the waypoint graph
+	m_pGridInfluence = new LayeredInfluenceMap(10, 10, 10.f, true);
+	m_AllyLayerIdx = m_pGridInfluence->AddLayer("Ally");
+	m_EnemyLayerIdx = m_pGridInfluence->AddLayer("Enemy");
+	using Expression = InfluenceExpression;
+	m_pGridInfluence->AddWorkingMap("Control", Expression::Layer("Ally") - Expression::Layer("Enemy"));
+	m_pGridInfluence->AddWorkingMap("Tension", Expression::Layer("Ally") + Expression::Layer("Enemy"));
+	m_pGridInfluence->AddWorkingMap("Vulnerability", Expression::Layer("Tension") - Abs(Expression::Layer("Control")));
+	m_pAllyStamper = new InfluenceStamper(m_pGridInfluence->GetLayer(m_AllyLayerIdx));
+	m_pEnemyStamper = new InfluenceStamper(m_pGridInfluence->GetLayer(m_EnemyLayerIdx));
+
 	m_pInfluenceGraph2D = new InfluenceMap<InfluenceGraph>(false);
 	m_pInfluenceGraph2D->InitializeBuffer();
 
@@ -44,7 +58,8 @@ void App_InfluenceMap::Update(float deltaTime)
 		}
 		else
 		{
-			m_GridEditor.UpdateGraph(m_pInfluenceGrid);
+			if (m_GridEditor.UpdateGraph(m_pInfluenceGrid))
+				UpdateBlockedCells();
 		}
 	}
 	else
@@ -58,8 +73,13 @@ void App_InfluenceMap::Update(float deltaTime)
 	}
 
 	m_pInfluenceGraph2D->PropagateInfluence(deltaTime);
-	m_pInfluenceGrid->PropagateInfluence(deltaTime);
+	m_pAllyStamper->ApplyStamps();
+	m_pEnemyStamper->ApplyStamps();
+	m_pGridInfluence->Update(deltaTime);
 
+	//The grid graph only renders the influence
+	for (int idx = 0; idx < m_pInfluenceGrid->GetNrOfNodes(); ++idx)
+		m_pInfluenceGrid->GetNode(idx)->SetInfluence(m_pGridInfluence->GetWorkingInfluence(m_ShownWorkingMapIdx, idx));
 
 	UpdateUI();
 }
@@ -107,19 +127,52 @@ void App_InfluenceMap::UpdateUI()
 	ImGui::Checkbox("Enable graph editing", &m_EditGraphEnabled);
 	ImGui::Checkbox("Render as graph", &m_RenderAsGraph);
 
-	auto momentum = m_pInfluenceGrid->GetMomentum();
-	auto decay = m_pInfluenceGrid->GetDecay();
-	auto propagationInterval = m_pInfluenceGrid->GetPropagationInterval();
+	//Every layer of the grid gets the same settings
+	GridInfluenceMap* pFirstLayer = m_pGridInfluence->GetLayer(0);
+	auto momentum = pFirstLayer->GetMomentum();
+	auto decay = pFirstLayer->GetDecay();
+	auto propagationInterval = pFirstLayer->GetPropagationInterval();
 
 	ImGui::SliderFloat("Momentum", &momentum, 0.0f, 1.f, "%.2");
 	ImGui::SliderFloat("Decay", &decay, 0.f, 1.f, "%.2");
 	ImGui::SliderFloat("Propagation Interval", &propagationInterval, 0.f, 2.f, "%.2");
 	ImGui::Spacing();
 
+	int nrOfThreads = pFirstLayer->GetNrOfThreads();
+	auto timeBudget = pFirstLayer->GetTimeBudget();
+	bool isSparse = pFirstLayer->IsSparse();
+
+	ImGui::SliderInt("Threads", &nrOfThreads, 1, std::max(int(std::thread::hardware_concurrency()), 1));
+	ImGui::SliderFloat("Budget (ms)", &timeBudget, 0.f, 5.f, "%.2");
+	ImGui::Checkbox("Sparse propagation", &isSparse);
+	ImGui::Checkbox("Stamp on click", &m_StampOnClick);
+	ImGui::SliderFloat("Stamp radius", &m_StampRadius, 0.f, 50.f, "%.1");
+	ImGui::Spacing();
+
+	ImGui::Text("Shown grid map");
+	ImGui::Combo("", &m_ShownWorkingMapIdx, "Control\0Tension\0Vulnerability", 3);
+	ImGui::Spacing();
+
+	if (ImGui::Button("Benchmark grid"))
+		BenchmarkGridInfluence();
+	if (ImGui::Button("Benchmark sparse"))
+		BenchmarkSparseInfluence();
+	if (ImGui::Button("Benchmark stamps"))
+		BenchmarkStamps();
+	ImGui::Spacing();
+
 	//Set data
-	m_pInfluenceGrid->SetMomentum(momentum);
-	m_pInfluenceGrid->SetDecay(decay);
-	m_pInfluenceGrid->SetPropagationInterval(propagationInterval);
+	for (int layerIdx = 0; layerIdx < m_pGridInfluence->GetNrOfLayers(); ++layerIdx)
+	{
+		GridInfluenceMap* pLayer = m_pGridInfluence->GetLayer(layerIdx);
+		pLayer->SetMomentum(momentum);
+		if (decay != pLayer->GetDecay())
+			pLayer->SetDecay(decay);
+		pLayer->SetPropagationInterval(propagationInterval);
+		pLayer->SetNrOfThreads(nrOfThreads);
+		pLayer->SetTimeBudget(timeBudget);
+		pLayer->SetSparse(isSparse);
+	}
 
 	m_pInfluenceGraph2D->SetMomentum(momentum);
 	m_pInfluenceGraph2D->SetDecay(decay);
@@ -157,6 +210,158 @@ void App_InfluenceMap::AddInfluenceOnMouseClick(Elite::InputMouseButton mouseBtn
 
 	if (m_UseWaypointGraph)
 		m_pInfluenceGraph2D->SetInfluenceAtPosition(mousePos, inf);
+	else if (m_StampOnClick)
+		(mouseBtn == InputMouseButton::eLeft ? m_pAllyStamper : m_pEnemyStamper)->Stamp(mousePos, m_StampRadius, abs(inf));
 	else
-		m_pInfluenceGrid->SetInfluenceAtPosition(mousePos, inf);
+		m_pGridInfluence->SetInfluenceAtPosition(mouseBtn == InputMouseButton::eLeft ? m_AllyLayerIdx : m_EnemyLayerIdx, mousePos, abs(inf));
+}
+
+void App_InfluenceMap::UpdateBlockedCells()
+{
+	//Cells without connections are blocked
+	for (int idx = 0; idx < m_pInfluenceGrid->GetNrOfNodes(); ++idx)
+		m_pGridInfluence->SetCellBlocked(idx, m_pInfluenceGrid->GetConnections(idx).empty());
+}
+
+void App_InfluenceMap::BenchmarkGridInfluence() const
+{
+	const int nrOfPropagations = 100;
+
+	//Same propagation on a 1024x1024 grid influence map and on a 128x128 grid graph
+	GridInfluenceMap gridInfluence{ 1024, 1024, 1.f, true };
+	InfluenceMap<InfluenceGrid> graphInfluence{ false };
+	graphInfluence.InitializeGrid(128, 128, 1, false, true);
+	graphInfluence.InitializeBuffer();
+	graphInfluence.SetPropagationInterval(0.f);
+
+	for (int i = 0; i < 200; ++i)
+	{
+		const Vector2 pos{ randomFloat(1024.f), randomFloat(1024.f) };
+		gridInfluence.SetInfluenceAtPosition(pos, randomFloat(-100.f, 100.f));
+		graphInfluence.SetInfluenceAtPosition(pos / 8.f, randomFloat(-100.f, 100.f));
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < nrOfPropagations; ++i)
+		gridInfluence.Propagate();
+	auto end = std::chrono::high_resolution_clock::now();
+	const float gridTime = std::chrono::duration<float, std::milli>(end - start).count() / nrOfPropagations;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < nrOfPropagations; ++i)
+		graphInfluence.PropagateInfluence(0.f);
+	end = std::chrono::high_resolution_clock::now();
+	const float graphTime = std::chrono::duration<float, std::milli>(end - start).count() / nrOfPropagations;
+
+	std::cout << "Grid influence 1024x1024: " << gridTime << " ms per propagation ("
+		<< gridTime * 1e6f / (1024 * 1024) << " ns per cell)" << std::endl;
+	std::cout << "Graph influence 128x128: " << graphTime << " ms per propagation ("
+		<< graphTime * 1e6f / (128 * 128) << " ns per cell)" << std::endl;
+
+	//Row bands on more threads, the result has to stay the same
+	const int maxNrOfThreads = std::max(int(std::thread::hardware_concurrency()), 1);
+	for (int nrOfThreads = 2; nrOfThreads <= maxNrOfThreads; nrOfThreads *= 2)
+	{
+		GridInfluenceMap threadedInfluence{ 1024, 1024, 1.f, true };
+		threadedInfluence.SetNrOfThreads(nrOfThreads);
+		for (int idx = 0; idx < 1024 * 1024; ++idx)
+			threadedInfluence.SetInfluence(idx, gridInfluence.GetInfluence(idx));
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < nrOfPropagations; ++i)
+			threadedInfluence.Propagate();
+		end = std::chrono::high_resolution_clock::now();
+		const float threadedTime = std::chrono::duration<float, std::milli>(end - start).count() / nrOfPropagations;
+
+		for (int i = 0; i < nrOfPropagations; ++i)
+			gridInfluence.Propagate();
+
+		bool isSame = true;
+		for (int idx = 0; idx < 1024 * 1024 && isSame; ++idx)
+			isSame = threadedInfluence.GetInfluence(idx) == gridInfluence.GetInfluence(idx);
+
+		std::cout << "Grid influence 1024x1024 on " << nrOfThreads << " threads: " << threadedTime << " ms per propagation, "
+			<< (isSame ? "same result" : "DIFFERENT result") << std::endl;
+	}
+}
+
+void App_InfluenceMap::BenchmarkSparseInfluence() const
+{
+	const int nrOfPropagations = 20;
+	const int size = 1024;
+
+	//A square of influence in the middle of the map, covering part of its area
+	const float activeAreas[] = { 0.01f, 0.1f, 0.5f };
+	for (float activeArea : activeAreas)
+	{
+		float times[2]{};
+		int nrOfActiveSpans = 0;
+
+		for (int isSparse = 0; isSparse < 2; ++isSparse)
+		{
+			GridInfluenceMap gridInfluence{ size, size, 1.f, true };
+			gridInfluence.SetDecay(2.f);
+			gridInfluence.SetSparse(isSparse == 1);
+
+			const int side = int(sqrtf(activeArea) * size);
+			const int first = (size - side) / 2;
+			for (int row = first; row < first + side; ++row)
+			{
+				for (int column = first; column < first + side; ++column)
+					gridInfluence.SetInfluence(row * size + column, 100.f);
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < nrOfPropagations; ++i)
+				gridInfluence.Propagate();
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			times[isSparse] = std::chrono::duration<float, std::milli>(end - start).count() / nrOfPropagations;
+			nrOfActiveSpans = gridInfluence.GetNrOfActiveSpans();
+		}
+
+		std::cout << "Influence " << size << "x" << size << " with " << activeArea * 100.f << "% active: full "
+			<< times[0] << " ms, sparse " << times[1] << " ms (" << nrOfActiveSpans * GridInfluenceMap::sparse_span_width * 100.f / (size * size)
+			<< "% of the cells in active spans)" << std::endl;
+	}
+}
+
+void App_InfluenceMap::BenchmarkStamps() const
+{
+	const int nrOfFrames = 100;
+	const int nrOfEmitters = 500;
+	const float size = 1024.f;
+
+	GridInfluenceMap gridInfluence{ int(size), int(size), 1.f, true };
+	InfluenceStamper stamper{ &gridInfluence };
+
+	std::vector<int> emitterIds{};
+	std::vector<Vector2> positions{};
+	std::vector<Vector2> velocities{};
+	for (int i = 0; i < nrOfEmitters; ++i)
+	{
+		positions.push_back(Vector2{ randomFloat(size), randomFloat(size) });
+		velocities.push_back(randomVector2(-2.f, 2.f));
+		emitterIds.push_back(stamper.AddEmitter(positions.back(), randomFloat(2.f, 16.f), randomFloat(-100.f, 100.f)));
+	}
+	stamper.ApplyStamps();
+
+	//Every emitter moves every frame
+	int nrOfAppliedRows = 0;
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < nrOfFrames; ++frame)
+	{
+		for (int i = 0; i < nrOfEmitters; ++i)
+		{
+			positions[i] += velocities[i];
+			stamper.MoveEmitter(emitterIds[i], positions[i]);
+		}
+		stamper.ApplyStamps();
+		nrOfAppliedRows += stamper.GetNrOfAppliedRows();
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << nrOfEmitters << " moving emitters on " << size << "x" << size << ": "
+		<< std::chrono::duration<float, std::milli>(end - start).count() / nrOfFrames << " ms per frame, "
+		<< nrOfAppliedRows / nrOfFrames << " stamp rows per frame, " << stamper.GetNrOfKernels() << " kernels" << std::endl;
 }
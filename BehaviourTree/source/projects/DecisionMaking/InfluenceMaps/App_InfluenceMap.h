@@ -8,6 +8,8 @@
 //--- Includes and Forward Declarations ---
 #include "projects/Movement/SteeringBehaviors/SteeringHelpers.h"
 #include "framework\EliteAI\EliteGraphs\EInfluenceMap.h"
+#include "framework\EliteAI\EliteGraphs\ELayeredInfluenceMap.h"
+#include "framework\EliteAI\EliteGraphs\EInfluenceStamper.h"
 #include "framework\EliteAI\EliteGraphs\EGraph2D.h"
 #include "framework\EliteAI\EliteGraphs\EGridGraph.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
@@ -39,7 +41,15 @@ public:
 	using InfluenceGraph = Elite::Graph2D<Elite::InfluenceNode, Elite::GraphConnection2D>;
 
 private:
-	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid = nullptr;
+	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid = nullptr; //Editing and rendering of the grid
+	Elite::LayeredInfluenceMap* m_pGridInfluence = nullptr; //Influence of the grid
+	int m_AllyLayerIdx = -1;
+	int m_EnemyLayerIdx = -1;
+	int m_ShownWorkingMapIdx = 0;
+	Elite::InfluenceStamper* m_pAllyStamper = nullptr;
+	Elite::InfluenceStamper* m_pEnemyStamper = nullptr;
+	bool m_StampOnClick = false;
+	float m_StampRadius = 20.f;
 	Elite::GraphEditor m_WaypointGraphEditor{};
 	Elite::InfluenceMap<InfluenceGraph>* m_pInfluenceGraph2D = nullptr;
 	Elite::GraphEditor m_GridEditor{};
@@ -50,6 +60,10 @@ private:
 	bool m_RenderAsGraph = false;
 
 	void AddInfluenceOnMouseClick(Elite::InputMouseButton mouseBtn, float inf);
+	void UpdateBlockedCells();
+	void BenchmarkGridInfluence() const;
+	void BenchmarkSparseInfluence() const;
+	void BenchmarkStamps() const;
 private:
 	//C++ make the class non-copyable
 	App_InfluenceMap(const App_InfluenceMap&) = delete;
@@ -5,15 +5,112 @@
 #include "App_PathfindingAStar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAstar.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
+#include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
+#include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
 
 using namespace Elite;
 
+namespace
+{
+	// Turns the cell into water without connections. Only removes the connections of the cell itself,
+	// RemoveConnectionsToAdjacentNodes visits the whole graph
+	void BlockCell(GridGraph<GridTerrainNode, GraphConnection>& grid, int idx)
+	{
+		std::vector<int> neighbors{};
+		for (auto pConnection : grid.GetNodeConnections(idx))
+			neighbors.push_back(pConnection->GetTo());
+		for (int neighborIdx : neighbors)
+			grid.RemoveConnection(idx, neighborIdx);
+		grid.GetNode(idx)->SetTerrainType(TerrainType::Water);
+	}
+
+	// The list scan AStar::FindPath used before it got a binary heap, kept as the reference the heap version has to match.
+	// Both lists are searched for every neighbor, so it is quadratic in the amount of expanded nodes
+	template <class T_GraphType>
+	std::vector<int> FindPathListScan(const T_GraphType& graph, int startIdx, int goalIdx, Heuristic heuristicFunction)
+	{
+		struct NodeRecord
+		{
+			int nodeIdx = invalid_node_index;
+			GraphEdge connection{};
+			float costSoFar = 0.f;
+			float estimatedTotalCost = 0.f;
+		};
+
+		auto getHeuristicCost = [&graph, goalIdx, heuristicFunction](int idx)
+		{
+			const Vector2 toDestination = graph.GetNodePos(goalIdx) - graph.GetNodePos(idx);
+			return heuristicFunction(abs(toDestination.x), abs(toDestination.y));
+		};
+		auto findRecord = [](std::vector<NodeRecord>& list, int idx)
+		{
+			return std::find_if(list.begin(), list.end(), [idx](const NodeRecord& record) { return record.nodeIdx == idx; });
+		};
+
+		std::vector<NodeRecord> openList{ { startIdx, GraphEdge{}, 0.f, getHeuristicCost(startIdx) } };
+		std::vector<NodeRecord> closedList{};
+		std::vector<int> path{};
+
+		while (!openList.empty())
+		{
+			//First one of the cheapest records, the oldest one on equal f-costs
+			const auto currentIt = std::min_element(openList.begin(), openList.end(),
+				[](const NodeRecord& a, const NodeRecord& b) { return a.estimatedTotalCost < b.estimatedTotalCost; });
+			const NodeRecord currentRecord = *currentIt;
+			openList.erase(currentIt);
+			closedList.push_back(currentRecord);
+
+			if (currentRecord.nodeIdx == goalIdx)
+				break;
+
+			for (const GraphEdge& connection : graph.GetNeighbors(currentRecord.nodeIdx))
+			{
+				const float costSoFar = currentRecord.costSoFar + connection.cost;
+
+				//An existing record is only replaced by a cheaper one, closed nodes are opened again
+				std::vector<NodeRecord>* pList = &closedList;
+				auto existingIt = findRecord(closedList, connection.to);
+				if (existingIt == closedList.end())
+				{
+					pList = &openList;
+					existingIt = findRecord(openList, connection.to);
+				}
+
+				if (existingIt != pList->end())
+				{
+					if (existingIt->costSoFar <= costSoFar)
+						continue;
+					pList->erase(existingIt);
+				}
+
+				openList.push_back({ connection.to, connection, costSoFar, costSoFar + getHeuristicCost(connection.to) });
+			}
+		}
+
+		if (closedList.back().nodeIdx != goalIdx)
+			return path;
+
+		for (int idx = goalIdx; idx != invalid_node_index; idx = findRecord(closedList, idx)->connection.from)
+			path.push_back(idx);
+
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+}
+
 //Destructor
 App_PathfindingAStar::~App_PathfindingAStar()
 {
+	SAFE_DELETE(m_pHPAStar); // removes its listener from the grid, so before the grid
+	SAFE_DELETE(m_pDStarLite);
 	SAFE_DELETE(m_pGridGraph);
 	SAFE_DELETE(m_pGraphRenderer);
 	SAFE_DELETE(m_pGraphEditor);
+	SAFE_DELETE(m_pJPS);
+	SAFE_DELETE(m_pPathRequestQueue);
+	SAFE_DELETE(m_pFlowFieldWorker);
+	ClearCrowd();
+	SAFE_DELETE(m_pFollowFlowField);
 }
 
 //Functions
@@ -27,11 +124,20 @@ void App_PathfindingAStar::Start()
 
 	//Create Graph
 	MakeGridGraph();
+	m_pPathRequestQueue = new PathRequestQueue<GridTerrainNode, GraphConnection>(std::max(1, (int)std::thread::hardware_concurrency() - 1), m_pHeuristicFunction);
+	m_pPathRequestQueue->SetFrameBudget(2.f, 0);
+	m_pFlowFieldWorker = new FlowFieldWorker<GridTerrainNode>(COLUMNS, ROWS, (float)m_SizeCell);
+	m_pFlowFieldWorker->SetGraph(m_pGraphSnapshot);
+	m_pFollowFlowField = new FollowFlowField();
+	ResetJPS();
+	ResetHPAStar();
+	ResetDStarLite();
 
 	//Setup default start path
 	startPathIdx = 44;
 	endPathIdx = 88;
 	CalculatePath();
+	m_pFlowFieldWorker->SetGoals({ endPathIdx });
 }
 
 void App_PathfindingAStar::Update(float deltaTime)
@@ -56,15 +162,39 @@ void App_PathfindingAStar::Update(float deltaTime)
 		{
 			endPathIdx = closestNode;
 			CalculatePath();
+			m_pFlowFieldWorker->SetGoals({ endPathIdx });
 		}
 	}
+	//Paths requested last frame
+	m_pPathRequestQueue->Update();
+	PollPathRequests();
+
 	//IMGUI
 	UpdateImGui();
 
 	//UPDATE/CHECK GRID HAS CHANGED
 	if (m_pGraphEditor->UpdateGraph(m_pGridGraph))
 	{
+		m_BakedGraph.Bake(*m_pGridGraph);
+		m_pGraphSnapshot = std::make_shared<CSRGraph<GridTerrainNode>>(m_BakedGraph);
+		ResetJPS();
 		CalculatePath();
+		m_pFlowFieldWorker->SetGraph(m_pGraphSnapshot);
+	}
+
+	//The crowd uses the last finished field, the worker may still be building a newer one
+	if (m_UseFlowField)
+	{
+		m_pFollowFlowField->SetFlowField(m_pFlowFieldWorker->GetFlowField());
+		if (endPathIdx != invalid_node_index)
+			m_pFollowFlowField->SetTarget(m_pGridGraph->GetNodeWorldPos(endPathIdx));
+
+		const Vector2 worldSize{ float(COLUMNS * m_SizeCell), float(ROWS * m_SizeCell) };
+		for (SteeringAgent* pAgent : m_CrowdAgents)
+		{
+			pAgent->Update(deltaTime);
+			pAgent->TrimToWorld(ZeroVector2, worldSize, false);
+		}
 	}
 }
 
@@ -92,6 +222,21 @@ void App_PathfindingAStar::Render(float deltaTime) const
 		m_pGraphRenderer->HighlightNodes(m_pGridGraph, m_vPath);
 	}
 
+	if (m_UseFlowField)
+	{
+		const auto pFlowField = m_pFlowFieldWorker->GetFlowField();
+		if (m_DrawFlowField && pFlowField)
+		{
+			for (int idx = 0; idx < pFlowField->GetNrOfCells(); ++idx)
+			{
+				if (pFlowField->GetDirection(idx) != ZeroVector2)
+					DEBUGRENDERER2D->DrawDirection(m_pGridGraph->GetNodeWorldPos(idx), pFlowField->GetDirection(idx), m_SizeCell * 0.4f, { 0.f, 0.f, 1.f });
+			}
+		}
+
+		for (SteeringAgent* pAgent : m_CrowdAgents)
+			pAgent->Render(deltaTime);
+	}
 }
 
 void App_PathfindingAStar::MakeGridGraph()
@@ -107,6 +252,9 @@ void App_PathfindingAStar::MakeGridGraph()
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(66);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(67);
 	m_pGridGraph->RemoveConnectionsToAdjacentNodes(47);
+
+	m_BakedGraph.Bake(*m_pGridGraph);
+	m_pGraphSnapshot = std::make_shared<CSRGraph<GridTerrainNode>>(m_BakedGraph);
 }
 
 void App_PathfindingAStar::UpdateImGui()
@@ -138,6 +286,18 @@ void App_PathfindingAStar::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("Search: %.3f ms", m_LastSearchTime);
+		ImGui::Text("Expanded: %d nodes", m_NrOfExpandedNodes);
+		ImGui::Text("Graph: %.1f M neighbors/s", m_NeighborsPerSecondGraph);
+		ImGui::Text("Baked: %.1f M neighbors/s", m_NeighborsPerSecondBaked);
+		ImGui::Text("HPA*: %d clusters", m_pHPAStar->GetNrOfClusters());
+		ImGui::Text("HPA*: %d nodes, %d edges", m_pHPAStar->GetNrOfAbstractNodes(), m_pHPAStar->GetNrOfAbstractEdges());
+		ImGui::Text("Abstract search: %.3f ms", m_pHPAStar->GetLastAbstractSearchTime());
+		ImGui::Text("Refine: %.3f ms", m_pHPAStar->GetLastRefineTime());
+		ImGui::Text("Rebuilt %d clusters: %.3f ms", m_pHPAStar->GetNrOfRebuiltClusters(), m_pHPAStar->GetLastRebuildTime());
+		ImGui::Text("Queued paths: %d", m_pPathRequestQueue->GetNrOfPendingRequests());
+		ImGui::Text("Delivered: %d, shared: %d", m_pPathRequestQueue->GetNrOfDeliveredRequests(), m_pPathRequestQueue->GetNrOfDeduplicatedRequests());
+		ImGui::Text("Latency: %.2f ms (max %.2f)", m_pPathRequestQueue->GetAverageLatency(), m_pPathRequestQueue->GetMaxLatency());
 		ImGui::Unindent();
 
 		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
@@ -158,6 +318,56 @@ void App_PathfindingAStar::UpdateImGui()
 			m_StartSelected = !m_StartSelected;
 		}
 
+		if (ImGui::Button("Benchmark A*"))
+			BenchmarkAStar();
+
+		if (ImGui::Checkbox("Use baked graph", &m_UseBakedGraph))
+			CalculatePath();
+		if (ImGui::Button("Benchmark neighbors"))
+			BenchmarkNeighborIteration();
+
+		if (ImGui::Checkbox("Jump Point Search", &m_UseJPS))
+			CalculatePath();
+		if (ImGui::Checkbox("JPS+ jump distances", &m_UseJumpDistances))
+		{
+			ResetJPS();
+			CalculatePath();
+		}
+		ImGui::Text(m_pJPS->IsUniformGrid() ? "JPS: uniform grid" : "JPS: falls back to A*");
+		if (ImGui::Button("Benchmark JPS"))
+			BenchmarkJPS();
+
+		if (ImGui::Checkbox("Hierarchical (HPA*)", &m_UseHPAStar))
+			CalculatePath();
+		if (ImGui::SliderInt("Cluster size", &m_HPAClusterSize, 2, 10))
+		{
+			ResetHPAStar();
+			CalculatePath();
+		}
+		if (ImGui::Button("Check HPA* diagonal gaps"))
+			CheckHPAStarDiagonalGaps();
+
+		if (ImGui::Checkbox("Incremental (D* Lite)", &m_UseDStarLite))
+			CalculatePath();
+
+		if (ImGui::Button("Request 100 paths"))
+			RequestRandomPaths(100);
+		if (ImGui::Button("Cancel requested paths"))
+			CancelPathRequests();
+
+		if (ImGui::Checkbox("Flow field crowd", &m_UseFlowField))
+		{
+			if (m_UseFlowField)
+				SpawnCrowd();
+			else
+				ClearCrowd();
+		}
+		ImGui::SliderInt("Crowd size", &m_CrowdSize, 10, 2000);
+		ImGui::Checkbox("Draw flow field", &m_DrawFlowField);
+		ImGui::Text("Field: %.3f ms, %d cells", m_pFlowFieldWorker->GetLastUpdateTime(), m_pFlowFieldWorker->GetNrOfExpandedCells());
+		if (ImGui::Button("Benchmark flow field"))
+			BenchmarkFlowField();
+
 		ImGui::Checkbox("Grid", &m_DebugSettings.DrawNodes);
 		ImGui::Checkbox("NodeNumbers", &m_DebugSettings.DrawNodeNumbers);
 		ImGui::Checkbox("Connections", &m_DebugSettings.DrawConnections);
@@ -185,6 +395,9 @@ void App_PathfindingAStar::UpdateImGui()
 				m_pHeuristicFunction = HeuristicFunctions::Chebyshev;
 				break;
 			}
+			ResetJPS();
+			ResetHPAStar();
+			ResetDStarLite();
 		}
 		ImGui::Spacing();
 
@@ -205,12 +418,39 @@ void App_PathfindingAStar::CalculatePath()
 	{
 		//BFS Pathfinding
 		//auto pathfinder = BFS<GridTerrainNode, GraphConnection>(m_pGridGraph);
-		auto pathfinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph,m_pHeuristicFunction);
 		//AStar
 		auto startNode = m_pGridGraph->GetNode(startPathIdx);
 		auto endNode = m_pGridGraph->GetNode(endPathIdx);
 
-		m_vPath = pathfinder.FindPath(startNode, endNode);
+		int nrOfAStarExpandedNodes = 0;
+		const auto searchStart = std::chrono::high_resolution_clock::now();
+		if (m_UseDStarLite)
+			m_vPath = m_pDStarLite->FindPath(startNode, endNode);
+		else if (m_UseHPAStar)
+			m_vPath = m_pHPAStar->FindPath(startNode, endNode);
+		else if (m_UseJPS)
+			m_vPath = m_pJPS->FindPath(startNode, endNode, true);
+		else if (m_UseBakedGraph)
+		{
+			auto pathfinder = AStar<GridTerrainNode, GraphConnection, CSRGraph<GridTerrainNode>>(&m_BakedGraph, m_pHeuristicFunction);
+			pathfinder.FindPath(startNode, endNode, m_AStarContext, m_vPath);
+			nrOfAStarExpandedNodes = pathfinder.GetNrOfExpandedNodes();
+		}
+		else
+		{
+			auto pathfinder = AStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+			pathfinder.FindPath(startNode, endNode, m_AStarContext, m_vPath);
+			nrOfAStarExpandedNodes = pathfinder.GetNrOfExpandedNodes();
+		}
+		const auto searchEnd = std::chrono::high_resolution_clock::now();
+
+		m_LastSearchTime = std::chrono::duration<float, std::milli>(searchEnd - searchStart).count();
+		if (m_UseDStarLite)
+			m_NrOfExpandedNodes = m_pDStarLite->GetNrOfExpandedNodes();
+		else if (m_UseHPAStar)
+			m_NrOfExpandedNodes = 0;
+		else
+			m_NrOfExpandedNodes = m_UseJPS ? m_pJPS->GetNrOfExpandedNodes() : nrOfAStarExpandedNodes;
 
 
 		std::cout << "New Path Calculated" << std::endl;
@@ -221,3 +461,461 @@ void App_PathfindingAStar::CalculatePath()
 		m_vPath.clear();
 	}
 }
+
+void App_PathfindingAStar::BenchmarkNeighborIteration()
+{
+	// Visits every connection of every node a number of times, once through the connection lists
+	// of the grid graph and once through its baked snapshot
+	const int nrOfPasses = 1000;
+
+	auto measure = [nrOfPasses](const auto& graph)
+	{
+		float totalCost = 0.f;
+		int nrOfNeighbors = 0;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int pass = 0; pass < nrOfPasses; ++pass)
+		{
+			for (int idx = 0; idx < graph.GetNrOfNodes(); ++idx)
+			{
+				for (const GraphEdge& edge : graph.GetNeighbors(idx))
+				{
+					totalCost += edge.cost;
+					++nrOfNeighbors;
+				}
+			}
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		// Printing the sum keeps the loop from being optimized away
+		std::cout << "Visited " << nrOfNeighbors << " neighbors (total cost " << totalCost << ")" << std::endl;
+
+		const float seconds = std::chrono::duration<float>(end - start).count();
+		return seconds > 0.f ? nrOfNeighbors / seconds / 1000000.f : 0.f;
+	};
+
+	m_NeighborsPerSecondGraph = measure(*m_pGridGraph);
+	m_NeighborsPerSecondBaked = measure(m_BakedGraph);
+}
+
+void App_PathfindingAStar::BenchmarkAStar()
+{
+	// The list scan reference against the binary heap AStar on growing random grids, both have to find the same paths.
+	// The list scan is quadratic in the nodes it expands, so the goals stay near the start or the largest grid takes hours
+	const int sizes[] = { 64, 256, 1024 };
+	const int nrOfQueries = 20;
+	const int maxQueryDistance = 128;
+	std::mt19937 randomEngine{ 2022 };
+	int nrOfMismatches = 0;
+
+	for (int size : sizes)
+	{
+		// Implicit, so the largest grid doesn't store millions of connections. 20% of the cells are water
+		ImplicitGridGraph grid(size, size, m_SizeCell, false, true, 1.f, 1.5f);
+		for (int i = 0; i < size * size * 2 / 10; ++i)
+			grid.SetTerrainType(randomEngine() % (size * size), TerrainType::Water);
+
+		std::vector<std::pair<int, int>> queries{};
+		while ((int)queries.size() < nrOfQueries)
+		{
+			const int startCol = randomEngine() % size;
+			const int startRow = randomEngine() % size;
+			const int endCol = Clamp(startCol + int(randomEngine() % (2 * maxQueryDistance + 1)) - maxQueryDistance, 0, size - 1);
+			const int endRow = Clamp(startRow + int(randomEngine() % (2 * maxQueryDistance + 1)) - maxQueryDistance, 0, size - 1);
+
+			const int startIdx = grid.GetIndex(startCol, startRow);
+			const int endIdx = grid.GetIndex(endCol, endRow);
+			if (grid.GetTerrainType(startIdx) != TerrainType::Water && grid.GetTerrainType(endIdx) != TerrainType::Water)
+				queries.push_back({ startIdx, endIdx });
+		}
+
+		std::vector<std::vector<int>> referencePaths{};
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const auto& query : queries)
+			referencePaths.push_back(FindPathListScan(grid, query.first, query.second, m_pHeuristicFunction));
+		auto end = std::chrono::high_resolution_clock::now();
+		const float listScanMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+		auto aStar = AStar<GridTerrainNode, GraphConnection, ImplicitGridGraph>(&grid, m_pHeuristicFunction);
+		AStarContext<GridTerrainNode, GraphConnection> context{ size * size };
+		std::vector<std::vector<int>> paths(queries.size());
+		start = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < queries.size(); ++i)
+			aStar.FindPath(queries[i].first, queries[i].second, context, paths[i]);
+		end = std::chrono::high_resolution_clock::now();
+		const float heapMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+		int nrOfPaths = 0;
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			if (!paths[i].empty())
+				++nrOfPaths;
+			if (paths[i] != referencePaths[i])
+				++nrOfMismatches;
+		}
+
+		std::cout << size << "x" << size << ", " << nrOfPaths << " paths: list scan " << listScanMilliseconds
+			<< " ms, binary heap " << heapMilliseconds << " ms" << std::endl;
+	}
+
+	std::cout << "A* against the list scan: " << nrOfMismatches << " different paths" << std::endl;
+	assert(nrOfMismatches == 0 && "<App_PathfindingAStar::BenchmarkAStar>: the binary heap found other paths than the list scan");
+}
+
+void App_PathfindingAStar::ResetJPS()
+{
+	SAFE_DELETE(m_pJPS);
+	m_pJPS = new JPS<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+
+	if (m_UseJumpDistances)
+		m_pJPS->BakeJumpDistances();
+}
+
+void App_PathfindingAStar::ResetHPAStar()
+{
+	SAFE_DELETE(m_pHPAStar);
+	m_pHPAStar = new HPAStar<GridTerrainNode, GraphConnection>(m_pGridGraph, m_HPAClusterSize, m_pHeuristicFunction);
+}
+
+void App_PathfindingAStar::ResetDStarLite()
+{
+	SAFE_DELETE(m_pDStarLite);
+	m_pDStarLite = new DStarLite<GridTerrainNode, GraphConnection>(m_pGridGraph, m_pHeuristicFunction);
+}
+
+void App_PathfindingAStar::RequestRandomPaths(int nrOfRequests)
+{
+	// Agents spread over the grid all heading to a few targets, like a group of zombies chasing players,
+	// so some of the requests share the same start and goal
+	static std::mt19937 randomEngine{ 2022 };
+	const int nrOfTargets = 3;
+
+	std::vector<int> walkableNodes{};
+	for (int idx = 0; idx < m_pGraphSnapshot->GetNrOfNodes(); ++idx)
+	{
+		if (m_pGraphSnapshot->GetNeighbors(idx).size() > 0)
+			walkableNodes.push_back(idx);
+	}
+	if (walkableNodes.empty())
+		return;
+
+	for (int i = 0; i < nrOfRequests; ++i)
+	{
+		const int startIdx = walkableNodes[randomEngine() % walkableNodes.size()];
+		const int goalIdx = walkableNodes[(randomEngine() % nrOfTargets) * walkableNodes.size() / nrOfTargets];
+		m_PathRequestHandles.push_back(m_pPathRequestQueue->RequestPath(m_pGraphSnapshot, startIdx, goalIdx, i % 2));
+	}
+}
+
+void App_PathfindingAStar::PollPathRequests()
+{
+	std::vector<int> path{};
+	auto isDone = [this, &path](int handle) { return m_pPathRequestQueue->GetResult(handle, path) != PathRequestStatus::Pending; };
+
+	m_PathRequestHandles.erase(std::remove_if(m_PathRequestHandles.begin(), m_PathRequestHandles.end(), isDone), m_PathRequestHandles.end());
+}
+
+void App_PathfindingAStar::CancelPathRequests()
+{
+	for (int handle : m_PathRequestHandles)
+		m_pPathRequestQueue->CancelRequest(handle);
+
+	m_PathRequestHandles.clear();
+}
+
+void App_PathfindingAStar::SpawnCrowd()
+{
+	ClearCrowd();
+
+	// Random spots in the cells that aren't blocked
+	static std::mt19937 randomEngine{ 2022 };
+	std::uniform_real_distribution<float> offset{ -0.4f, 0.4f };
+
+	std::vector<int> walkableNodes{};
+	for (int idx = 0; idx < m_pGridGraph->GetNrOfNodes(); ++idx)
+	{
+		if (!m_pGridGraph->GetNodeConnections(idx).empty())
+			walkableNodes.push_back(idx);
+	}
+	if (walkableNodes.empty())
+		return;
+
+	for (int i = 0; i < m_CrowdSize; ++i)
+	{
+		const int idx = walkableNodes[randomEngine() % walkableNodes.size()];
+		const Vector2 position = m_pGridGraph->GetNodeWorldPos(idx) + Vector2{ offset(randomEngine), offset(randomEngine) } * float(m_SizeCell);
+
+		SteeringAgent* pAgent = new SteeringAgent(1.f);
+		pAgent->SetSteeringBehavior(m_pFollowFlowField);
+		pAgent->SetMaxLinearSpeed(20.f);
+		pAgent->SetAutoOrient(true);
+		pAgent->SetPosition(position);
+		m_CrowdAgents.push_back(pAgent);
+	}
+}
+
+void App_PathfindingAStar::ClearCrowd()
+{
+	for (SteeringAgent* pAgent : m_CrowdAgents)
+		SAFE_DELETE(pAgent);
+	m_CrowdAgents.clear();
+}
+
+void App_PathfindingAStar::BenchmarkFlowField()
+{
+	// A crowd heading to a few goals on a larger random grid: one A* per agent against one flow field,
+	// and a field that is repaired when a goal moves a cell against building it again
+	const int size = 128;
+	const int nrOfAgents = 1000;
+	const int nrOfGoals = 4;
+	const int nrOfMoves = 100;
+	std::mt19937 randomEngine{ 2022 };
+
+	GridGraph<GridTerrainNode, GraphConnection> grid(size, size, m_SizeCell, false, true, 1.f, 1.5f);
+	for (int i = 0; i < size * size * 2 / 10; ++i)
+		BlockCell(grid, randomEngine() % (size * size));
+	CSRGraph<GridTerrainNode> bakedGrid{ grid };
+
+	std::vector<int> walkableNodes{};
+	for (int idx = 0; idx < bakedGrid.GetNrOfNodes(); ++idx)
+	{
+		if (bakedGrid.GetNeighbors(idx).size() > 0)
+			walkableNodes.push_back(idx);
+	}
+
+	std::vector<int> goals{};
+	for (int i = 0; i < nrOfGoals; ++i)
+		goals.push_back(walkableNodes[randomEngine() % walkableNodes.size()]);
+
+	// Every agent searches its own path to the first goal
+	auto aStar = AStar<GridTerrainNode, GraphConnection, CSRGraph<GridTerrainNode>>(&bakedGrid, m_pHeuristicFunction);
+	AStarContext<GridTerrainNode, GraphConnection> context{ size * size };
+	std::vector<GridTerrainNode*> path{};
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < nrOfAgents; ++i)
+		aStar.FindPath(bakedGrid.GetNode(walkableNodes[randomEngine() % walkableNodes.size()]), bakedGrid.GetNode(goals[0]), context, path);
+	auto end = std::chrono::high_resolution_clock::now();
+	std::cout << nrOfAgents << " agents, A* each: " << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+	FlowFieldSolver<GridTerrainNode> solver(size, size, (float)m_SizeCell);
+	solver.SetGraph(&bakedGrid);
+	start = std::chrono::high_resolution_clock::now();
+	solver.SetGoals({ goals[0] });
+	end = std::chrono::high_resolution_clock::now();
+	std::cout << nrOfAgents << " agents, one flow field: " << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+	// The first goal keeps walking to a random neighbor, the others stay where they are
+	solver.SetGoals(goals);
+	float repairMilliseconds = 0.f;
+	float rebuildMilliseconds = 0.f;
+	int nrOfRepairedCells = 0;
+	int nrOfRebuiltCells = 0;
+	for (int move = 0; move < nrOfMoves; ++move)
+	{
+		const auto neighbors = bakedGrid.GetNeighbors(goals[0]);
+		if (neighbors.size() == 0)
+			break;
+
+		int step = randomEngine() % neighbors.size();
+		for (const GraphEdge& connection : neighbors)
+		{
+			if (step-- == 0)
+			{
+				goals[0] = connection.to;
+				break;
+			}
+		}
+
+		start = std::chrono::high_resolution_clock::now();
+		solver.SetGoals(goals);
+		end = std::chrono::high_resolution_clock::now();
+		repairMilliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+		nrOfRepairedCells += solver.GetNrOfExpandedCells();
+
+		FlowFieldSolver<GridTerrainNode> rebuiltSolver(size, size, (float)m_SizeCell);
+		rebuiltSolver.SetGraph(&bakedGrid);
+		start = std::chrono::high_resolution_clock::now();
+		rebuiltSolver.SetGoals(goals);
+		end = std::chrono::high_resolution_clock::now();
+		rebuildMilliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+		nrOfRebuiltCells += rebuiltSolver.GetNrOfExpandedCells();
+	}
+
+	std::cout << nrOfGoals << " goals, one moving " << nrOfMoves << " cells:" << std::endl
+		<< "  repaired: " << repairMilliseconds << " ms, " << nrOfRepairedCells << " expanded cells" << std::endl
+		<< "  rebuilt: " << rebuildMilliseconds << " ms, " << nrOfRebuiltCells << " expanded cells" << std::endl;
+}
+
+void App_PathfindingAStar::BenchmarkJPS()
+{
+	// Compares A*, JPS and JPS+ on a larger, diagonally connected random grid and maze
+	const int size = 128;
+	const int nrOfQueries = 200;
+	std::mt19937 randomEngine{ 2022 };
+
+	for (int map = 0; map < 2; ++map)
+	{
+		GridGraph<GridTerrainNode, GraphConnection> grid(size, size, m_SizeCell, false, true, 1.f, 1.5f);
+
+		if (map == 0)
+		{
+			// 30% randomly blocked cells
+			for (int i = 0; i < size * size * 3 / 10; ++i)
+				BlockCell(grid, randomEngine() % (size * size));
+		}
+		else
+		{
+			// Maze carved with a depth first search, walls between the odd cells
+			std::vector<bool> isWall(size * size, true);
+			std::vector<int> stack{ grid.GetIndex(1, 1) };
+			isWall[stack.back()] = false;
+
+			while (!stack.empty())
+			{
+				const int col = stack.back() % size;
+				const int row = stack.back() / size;
+
+				std::vector<Vector2> options{};
+				for (const Vector2& direction : { Vector2{ 2, 0 }, Vector2{ -2, 0 }, Vector2{ 0, 2 }, Vector2{ 0, -2 } })
+				{
+					const int nextCol = col + (int)direction.x;
+					const int nextRow = row + (int)direction.y;
+					if (nextCol > 0 && nextRow > 0 && nextCol < size - 1 && nextRow < size - 1 && isWall[grid.GetIndex(nextCol, nextRow)])
+						options.push_back(direction);
+				}
+
+				if (options.empty())
+				{
+					stack.pop_back();
+					continue;
+				}
+
+				const Vector2 direction = options[randomEngine() % options.size()];
+				isWall[grid.GetIndex(col + (int)direction.x / 2, row + (int)direction.y / 2)] = false;
+				stack.push_back(grid.GetIndex(col + (int)direction.x, row + (int)direction.y));
+				isWall[stack.back()] = false;
+			}
+
+			for (int idx = 0; idx < size * size; ++idx)
+			{
+				if (isWall[idx])
+					BlockCell(grid, idx);
+			}
+		}
+
+		// Queries between random cells that aren't blocked
+		std::vector<std::pair<int, int>> queries{};
+		while ((int)queries.size() < nrOfQueries)
+		{
+			const int startIdx = randomEngine() % (size * size);
+			const int endIdx = randomEngine() % (size * size);
+			if (!grid.GetNodeConnections(startIdx).empty() && !grid.GetNodeConnections(endIdx).empty())
+				queries.push_back({ startIdx, endIdx });
+		}
+
+		auto aStar = AStar<GridTerrainNode, GraphConnection>(&grid, m_pHeuristicFunction);
+		AStarContext<GridTerrainNode, GraphConnection> context{ size * size };
+		std::vector<GridTerrainNode*> path{};
+
+		JPS<GridTerrainNode, GraphConnection> jps(&grid, m_pHeuristicFunction);
+		JPS<GridTerrainNode, GraphConnection> jpsPlus(&grid, m_pHeuristicFunction);
+		jpsPlus.BakeJumpDistances();
+
+		const std::string names[] = { "A*", "JPS", "JPS+" };
+		for (int algorithm = 0; algorithm < 3; ++algorithm)
+		{
+			int nrOfExpandedNodes = 0;
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (const auto& query : queries)
+			{
+				if (algorithm == 0)
+				{
+					aStar.FindPath(grid.GetNode(query.first), grid.GetNode(query.second), context, path);
+					nrOfExpandedNodes += aStar.GetNrOfExpandedNodes();
+				}
+				else
+				{
+					auto& pathfinder = algorithm == 1 ? jps : jpsPlus;
+					pathfinder.FindPath(grid.GetNode(query.first), grid.GetNode(query.second));
+					nrOfExpandedNodes += pathfinder.GetNrOfExpandedNodes();
+				}
+			}
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			std::cout << (map == 0 ? "Random " : "Maze ") << names[algorithm] << ": "
+				<< std::chrono::duration<float, std::milli>(end - start).count() << " ms, "
+				<< nrOfExpandedNodes << " expanded nodes" << std::endl;
+		}
+	}
+}
+
+void App_PathfindingAStar::CheckHPAStarDiagonalGaps()
+{
+	// Two clusters that only touch diagonally: over a border (both ways) and at a corner (both diagonals).
+	// HPA* has to find a path wherever A* does
+	const int size = 10;
+	const int clusterSize = 5;
+	int nrOfFailures = 0;
+
+	const std::string names[] = { "Vertical border", "Horizontal border", "Corner", "Other corner" };
+	for (int map = 0; map < 4; ++map)
+	{
+		GridGraph<GridTerrainNode, GraphConnection> grid(size, size, m_SizeCell, false, true, 1.f, 1.5f);
+		int startIdx = grid.GetIndex(0, 0);
+		int endIdx = grid.GetIndex(size - 1, size - 1);
+
+		if (map < 2)
+		{
+			// Walls on both sides of the border, with a gap in each that is one cell apart
+			const bool isHorizontal = map == 1;
+			for (int i = 0; i < size; ++i)
+			{
+				if (i != clusterSize - 2)
+					BlockCell(grid, isHorizontal ? grid.GetIndex(i, clusterSize - 1) : grid.GetIndex(clusterSize - 1, i));
+				if (i != clusterSize - 1)
+					BlockCell(grid, isHorizontal ? grid.GetIndex(i, clusterSize) : grid.GetIndex(clusterSize, i));
+			}
+		}
+		else
+		{
+			// Only two opposite clusters are open
+			const bool isOtherCorner = map == 3;
+			for (int col = 0; col < size; ++col)
+			{
+				for (int row = 0; row < size; ++row)
+				{
+					if (((col < clusterSize) == (row < clusterSize)) == isOtherCorner)
+						BlockCell(grid, grid.GetIndex(col, row));
+				}
+			}
+
+			if (isOtherCorner)
+			{
+				startIdx = grid.GetIndex(size - 1, 0);
+				endIdx = grid.GetIndex(0, size - 1);
+			}
+		}
+
+		AStar<GridTerrainNode, GraphConnection> aStar(&grid, HeuristicFunctions::Octile);
+		HPAStar<GridTerrainNode, GraphConnection> hpaStar(&grid, clusterSize, HeuristicFunctions::Octile);
+
+		for (int direction = 0; direction < 2; ++direction)
+		{
+			GridTerrainNode* pStartNode = grid.GetNode(direction == 0 ? startIdx : endIdx);
+			GridTerrainNode* pEndNode = grid.GetNode(direction == 0 ? endIdx : startIdx);
+
+			const size_t aStarLength = aStar.FindPath(pStartNode, pEndNode).size();
+			const size_t hpaStarLength = hpaStar.FindPath(pStartNode, pEndNode).size();
+			const bool isCorrect = (aStarLength == 0) == (hpaStarLength == 0);
+			if (!isCorrect)
+				++nrOfFailures;
+
+			std::cout << names[map] << (direction == 0 ? ", forward" : ", backward") << ": A* " << aStarLength
+				<< " nodes, HPA* " << hpaStarLength << " nodes" << (isCorrect ? "" : " FAILED") << std::endl;
+		}
+	}
+
+	std::cout << "HPA* diagonal gaps: " << nrOfFailures << " failures" << std::endl;
+	assert(nrOfFailures == 0 && "<App_PathfindingAStar::CheckHPAStarDiagonalGaps>: HPA* and A* disagree on a path existing");
+}
@@ -8,6 +8,15 @@
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 #include "framework\EliteAI\EliteNavigation\ENavigation.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
+#include "framework\EliteAI\EliteGraphs\ECSRGraph.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EJPS.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EHPAStar.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EDStarLite.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EPathRequestQueue.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EFlowField.h"
+class SteeringAgent;
+class FollowFlowField;
 
 
 //-----------------------------------------------------------------
@@ -44,11 +53,37 @@ private:
 	static const int ROWS = 10;
 	unsigned int m_SizeCell = 15;
 	Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>* m_pGridGraph;
+	Elite::CSRGraph<Elite::GridTerrainNode> m_BakedGraph{}; // snapshot of m_pGridGraph, rebaked whenever the editor changes it
+	bool m_UseBakedGraph = true;
 
 	//Pathfinding datamembers
 	int startPathIdx = invalid_node_index;
 	int endPathIdx = invalid_node_index;
 	std::vector<Elite::GridTerrainNode*> m_vPath;
+	Elite::AStarContext<Elite::GridTerrainNode, Elite::GraphConnection> m_AStarContext{};
+	float m_LastSearchTime = 0.f;
+	int m_NrOfExpandedNodes = 0;
+	float m_NeighborsPerSecondGraph = 0.f;
+	float m_NeighborsPerSecondBaked = 0.f;
+	Elite::JPS<Elite::GridTerrainNode, Elite::GraphConnection>* m_pJPS = nullptr; // recreated when the grid or heuristic changes
+	bool m_UseJPS = false;
+	bool m_UseJumpDistances = false;
+	Elite::HPAStar<Elite::GridTerrainNode, Elite::GraphConnection>* m_pHPAStar = nullptr; // follows the grid changes itself, recreated when the heuristic changes
+	bool m_UseHPAStar = false;
+	int m_HPAClusterSize = 5;
+	Elite::DStarLite<Elite::GridTerrainNode, Elite::GraphConnection>* m_pDStarLite = nullptr; // keeps its search state between edits, recreated when the heuristic changes
+	bool m_UseDStarLite = false;
+	Elite::PathRequestQueue<Elite::GridTerrainNode, Elite::GraphConnection>* m_pPathRequestQueue = nullptr;
+	std::shared_ptr<Elite::CSRGraph<Elite::GridTerrainNode>> m_pGraphSnapshot{}; // replaced (not changed) when the grid changes, queued requests keep the old one
+	std::vector<int> m_PathRequestHandles{};
+
+	//Crowd heading to the end node, it follows one flow field instead of searching a path per agent
+	Elite::FlowFieldWorker<Elite::GridTerrainNode>* m_pFlowFieldWorker = nullptr; // builds from m_pGraphSnapshot on its own thread
+	FollowFlowField* m_pFollowFlowField = nullptr; // shared by the whole crowd
+	std::vector<SteeringAgent*> m_CrowdAgents{};
+	int m_CrowdSize = 1000;
+	bool m_UseFlowField = false;
+	bool m_DrawFlowField = false;
 
 	//Editor and Visualisation
 	Elite::GraphEditor* m_pGraphEditor{ nullptr};
@@ -63,6 +98,19 @@ private:
 
 	//Functions
 	void MakeGridGraph();
+	void BenchmarkNeighborIteration();
+	void BenchmarkAStar();
+	void ResetJPS();
+	void ResetHPAStar();
+	void ResetDStarLite();
+	void BenchmarkJPS();
+	void CheckHPAStarDiagonalGaps();
+	void RequestRandomPaths(int nrOfRequests);
+	void PollPathRequests();
+	void CancelPathRequests();
+	void SpawnCrowd();
+	void ClearCrowd();
+	void BenchmarkFlowField();
 	void UpdateImGui();
 	void CalculatePath();
 
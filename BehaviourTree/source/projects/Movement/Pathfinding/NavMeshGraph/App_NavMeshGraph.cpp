@@ -11,6 +11,9 @@ using namespace Elite;
 
 
 #include "framework\EliteAI\EliteNavigation\Algorithms\ENavGraphPathfinding.h"
+#include "framework\EliteAI\EliteNavigation\Algorithms\EPathCorridor.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBidirectionalAStar.h"
+#include "framework\EliteAI\EliteGraphs\ETiledNavGraph.h"
 
 //Statics
 bool App_NavMeshGraph::sShowPolygon = true;
@@ -26,7 +29,13 @@ App_NavMeshGraph::~App_NavMeshGraph()
 		SAFE_DELETE(pNC);
 	m_vNavigationColliders.clear();
 
+	for (auto& dynamicCollider : m_vDynamicColliders)
+		SAFE_DELETE(dynamicCollider.first);
+	m_vDynamicColliders.clear();
+
+	SAFE_DELETE(m_pPathCorridor);
 	SAFE_DELETE(m_pNavGraph);
+	SAFE_DELETE(m_pTiledNavGraph);
 	SAFE_DELETE(m_pSeekBehavior);
 	SAFE_DELETE(m_pArriveBehavior);
 	SAFE_DELETE(m_pAgent);
@@ -47,10 +56,35 @@ void App_NavMeshGraph::Start()
 	m_vNavigationColliders.push_back(new NavigationColliderElement(Elite::Vector2(15.f, -21.f), 50.0f, 3.0f));
 
 	//----------- NAVMESH  ------------
-	std::list<Elite::Vector2> baseBox
-	{ { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
-
-	m_pNavGraph = new Elite::NavGraph(Elite::Polygon(baseBox), m_AgentRadius);
+	//Only triangulate when there is no navmesh baked from this level yet
+	const auto start = std::chrono::high_resolution_clock::now();
+	m_pNavGraph = Elite::NavGraph::Load(NAVMESH_FILE_PATH, Elite::Polygon(LEVEL_CONTOUR), m_AgentRadius);
+	const bool isLoaded = m_pNavGraph != nullptr;
+	if (!isLoaded)
+		m_pNavGraph = new Elite::NavGraph(Elite::Polygon(LEVEL_CONTOUR), m_AgentRadius);
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << (isLoaded ? "Loaded baked navmesh in " : "Built navmesh in ")
+		<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+	if (!isLoaded)
+		m_pNavGraph->Save(NAVMESH_FILE_PATH);
+	m_pPathCorridor = new Elite::PathCorridor(m_pNavGraph);
+
+	//Only preprocess when the saved landmarks don't belong to this level
+	if (!m_Landmarks.Load(LANDMARKS_FILE_PATH) || !m_Landmarks.IsBuiltFor(*m_pNavGraph))
+		BuildLandmarks();
+
+	m_pTiledNavGraph = new Elite::TiledNavGraph(Elite::Vector2(-60.f, -30.f), Elite::Vector2(60.f, 30.f), m_TileSize, m_AgentRadius);
+	for (auto pNC : m_vNavigationColliders)
+	{
+		// Level colliders are never removed, so their id isn't kept. One that is refused would leave a hole in the level
+		if (m_pTiledNavGraph->AddObstacle(pNC->GetShape()) == Elite::TiledNavGraph::invalid_obstacle_id)
+		{
+			std::cout << "<App_NavMeshGraph::Start>: level collider outside the tiled navmesh" << std::endl;
+			assert(false && "<App_NavMeshGraph::Start>: level collider outside the tiled navmesh");
+		}
+	}
+	RebuildTiles();
 
 	//----------- AGENT ------------
 	m_pSeekBehavior = new Seek();
@@ -74,7 +108,22 @@ void App_NavMeshGraph::Update(float deltaTime)
 		auto mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eMiddle);
 		Elite::Vector2 mouseTarget = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
 			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
-		m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, m_pNavGraph, m_DebugNodePositions, m_Portals);
+		if (m_UseTiledNavGraph)
+			m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, *m_pTiledNavGraph->GetSnapshot(), m_SearchContext, m_DebugNodePositions, m_Portals);
+		else if (m_UsePathCorridor)
+			UpdatePathCorridor(mouseTarget);
+		else
+			m_vPath = NavMeshPathfinding::FindPath(m_pAgent->GetPosition(), mouseTarget, m_pNavGraph, m_SearchContext, m_DebugNodePositions, m_Portals,
+				m_UseLandmarks ? &m_Landmarks : nullptr, m_ExtraAgentRadius);
+	}
+
+	//The corridor follows the agent, it's only planned again when the agent left it
+	if (m_UsePathCorridor && m_pPathCorridor->IsValid() && !m_pPathCorridor->MovePosition(m_pAgent->GetPosition()))
+	{
+		if (m_vPath.empty())
+			m_pPathCorridor->Clear();
+		else
+			UpdatePathCorridor(m_pPathCorridor->GetTarget());
 	}
 
 	//Check if a path exist and move to the following point
@@ -106,12 +155,29 @@ void App_NavMeshGraph::Update(float deltaTime)
 
 void App_NavMeshGraph::Render(float deltaTime) const
 {
-	if (sShowGraph)
+	if (m_UseTiledNavGraph)
+	{
+		for (const auto& pTile : m_pTiledNavGraph->GetSnapshot()->GetTiles())
+		{
+			for (NavGraph* pRegion : pTile->GetRegions())
+			{
+				if (sShowGraph)
+					m_GraphRenderer.RenderGraph(pRegion, true, true);
+
+				if (sShowPolygon)
+				{
+					DEBUGRENDERER2D->DrawPolygon(pRegion->GetNavMeshPolygon(), Color(0.1f, 0.1f, 0.1f));
+					DEBUGRENDERER2D->DrawSolidPolygon(pRegion->GetNavMeshPolygon(), Color(0.0f, 0.5f, 0.1f, 0.05f), 0.4f);
+				}
+			}
+		}
+	}
+	else if (sShowGraph)
 	{
 		m_GraphRenderer.RenderGraph(m_pNavGraph, true, true);
 	}
 
-	if (sShowPolygon)
+	if (sShowPolygon && !m_UseTiledNavGraph)
 	{
 		DEBUGRENDERER2D->DrawPolygon(m_pNavGraph->GetNavMeshPolygon(),
 			Color(0.1f, 0.1f, 0.1f));
@@ -210,6 +276,39 @@ void App_NavMeshGraph::UpdateImGui()
 		{
 			m_pAgent->SetMaxLinearSpeed(m_AgentSpeed);
 		}
+
+		ImGui::Checkbox("Landmarks", &m_UseLandmarks);
+		ImGui::SliderInt("Count", &m_NrOfLandmarks, 1, 16);
+		if (ImGui::Button("Rebuild"))
+			BuildLandmarks();
+		if (ImGui::Button("Benchmark"))
+			BenchmarkHeuristics();
+		if (ImGui::Button("Bidirectional"))
+			BenchmarkBidirectional();
+		if (ImGui::Button("Point location"))
+			BenchmarkPointLocation();
+		ImGui::Spacing();
+
+		ImGui::Checkbox("Corridor", &m_UsePathCorridor);
+		if (ImGui::SliderFloat("Extra radius", &m_ExtraAgentRadius, 0.0f, 3.0f))
+		{
+			m_pPathCorridor->SetAgentRadius(m_ExtraAgentRadius);
+			m_pPathCorridor->Clear();
+		}
+		if (ImGui::Button("Clearance"))
+			BenchmarkClearance();
+		ImGui::Spacing();
+
+		ImGui::Checkbox("Tiled", &m_UseTiledNavGraph);
+		if (m_UseTiledNavGraph)
+		{
+			if (ImGui::Button("Add collider"))
+				AddDynamicCollider();
+			if (ImGui::Button("Remove collider"))
+				RemoveDynamicCollider();
+			if (ImGui::Button("Check border crossings"))
+				CheckTileBorderCrossings();
+		}
 		
 		//End
 		ImGui::PopAllowKeyboardFocus();
@@ -217,4 +316,371 @@ void App_NavMeshGraph::UpdateImGui()
 	}
 #pragma endregion
 #endif
-}
\ No newline at end of file
+}
+
+void App_NavMeshGraph::UpdatePathCorridor(const Elite::Vector2& target)
+{
+	const Elite::Vector2 agentPosition = m_pAgent->GetPosition();
+	const bool isPatched = m_pPathCorridor->MovePosition(agentPosition) && m_pPathCorridor->MoveTarget(target);
+	if (!isPatched)
+		m_pPathCorridor->Reset(agentPosition, target, m_SearchContext, m_UseLandmarks ? &m_Landmarks : nullptr);
+
+	m_vPath = m_pPathCorridor->FindPath(m_Portals);
+}
+
+void App_NavMeshGraph::BuildLandmarks()
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	m_Landmarks.Build(*m_pNavGraph, m_NrOfLandmarks);
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "Built " << m_Landmarks.GetNrOfLandmarks() << " landmarks in "
+		<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+	m_Landmarks.Save(LANDMARKS_FILE_PATH);
+}
+
+void App_NavMeshGraph::BenchmarkHeuristics()
+{
+	// Same random queries between nodes of the graph with every heuristic, the landmarks are combined with Euclidean
+	const std::vector<std::pair<int, int>> queries = GetBenchmarkQueries(500);
+
+	const std::string names[] = { "Euclidean", "Octile", "Chebyshev", "Landmarks" };
+	const Heuristic heuristics[] = { HeuristicFunctions::Euclidean, HeuristicFunctions::Octile, HeuristicFunctions::Chebyshev, HeuristicFunctions::Euclidean };
+
+	AStarContext<NavGraphNode, GraphConnection2D> context{ m_pNavGraph->GetNrOfNodes() };
+	std::vector<int> path{};
+	for (int heuristic = 0; heuristic < 4; ++heuristic)
+	{
+		auto pathfinder = AStar<NavGraphNode, GraphConnection2D>(m_pNavGraph, heuristics[heuristic]);
+		if (heuristic == 3)
+			pathfinder.SetLandmarks(&m_Landmarks);
+
+		int nrOfExpandedNodes = 0;
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (const auto& query : queries)
+		{
+			pathfinder.FindPath(query.first, query.second, context, path);
+			nrOfExpandedNodes += pathfinder.GetNrOfExpandedNodes();
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		std::cout << names[heuristic] << ": " << nrOfExpandedNodes << " expanded nodes, "
+			<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+	}
+}
+
+void App_NavMeshGraph::BenchmarkBidirectional()
+{
+	const std::vector<std::pair<int, int>> queries = GetBenchmarkQueries(500);
+
+	auto aStar = AStar<NavGraphNode, GraphConnection2D>(m_pNavGraph, HeuristicFunctions::Euclidean);
+	auto bidirectionalAStar = BidirectionalAStar<NavGraphNode, GraphConnection2D>(m_pNavGraph, HeuristicFunctions::Euclidean);
+
+	int nrOfExpandedNodes = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (const auto& query : queries)
+	{
+		aStar.FindPath(m_pNavGraph->GetNode(query.first), m_pNavGraph->GetNode(query.second));
+		nrOfExpandedNodes += aStar.GetNrOfExpandedNodes();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "A*: " << nrOfExpandedNodes << " expanded nodes, "
+		<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+	nrOfExpandedNodes = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (const auto& query : queries)
+	{
+		bidirectionalAStar.FindPath(m_pNavGraph->GetNode(query.first), m_pNavGraph->GetNode(query.second));
+		nrOfExpandedNodes += bidirectionalAStar.GetNrOfExpandedNodes();
+	}
+	end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "Bidirectional A*: " << nrOfExpandedNodes << " expanded nodes, "
+		<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+}
+
+void App_NavMeshGraph::BenchmarkPointLocation() const
+{
+	const std::string levelFilePaths[] = { "../data/LevelOne.gppl", "../data/LevelTwo.gppl", "../data/LevelThree.gppl" };
+	const int nrOfPositions = 100000;
+
+	for (const std::string& filePath : levelFilePaths)
+	{
+		Polygon* pLevel = LoadLevelPolygon(filePath);
+		if (!pLevel)
+			continue;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		const std::vector<Triangle*>& triangles = pLevel->Triangulate();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		std::cout << filePath << ": " << triangles.size() << " triangles, triangulated in "
+			<< std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+
+		// Fixed seed, some of the positions are outside of the level
+		std::mt19937 randomEngine{ 2022 };
+		std::uniform_real_distribution<float> randomX{ pLevel->GetPosVertMinXPos() - 10.f, pLevel->GetPosVertMaxXPos() + 10.f };
+		std::uniform_real_distribution<float> randomY{ pLevel->GetPosVertMinYPos() - 10.f, pLevel->GetPosVertMaxYPos() + 10.f };
+
+		std::vector<Vector2> positions{};
+		for (int i = 0; i < nrOfPositions; ++i)
+			positions.push_back(Vector2{ randomX(randomEngine), randomY(randomEngine) });
+
+		// What GetTriangleFromPosition did before: test every triangle
+		std::vector<const Triangle*> linearResults{};
+		start = std::chrono::high_resolution_clock::now();
+		for (const Vector2& position : positions)
+		{
+			auto it = std::find_if(triangles.begin(), triangles.end(),
+				[&position](const Triangle* pTriangle) { return PointInTriangle(position, pTriangle->p1, pTriangle->p2, pTriangle->p3); });
+			linearResults.push_back(it != triangles.end() ? *it : nullptr);
+		}
+		end = std::chrono::high_resolution_clock::now();
+		const float linearMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+		int nrOfMismatches = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < nrOfPositions; ++i)
+		{
+			if (pLevel->GetTriangleFromPosition(positions[i]) != linearResults[i])
+				++nrOfMismatches;
+		}
+		end = std::chrono::high_resolution_clock::now();
+		const float gridMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+		Vector2 closestPosition{};
+		start = std::chrono::high_resolution_clock::now();
+		for (const Vector2& position : positions)
+			pLevel->GetClosestTriangleFromPosition(position, closestPosition);
+		end = std::chrono::high_resolution_clock::now();
+
+		std::cout << "Linear: " << linearMilliseconds << " ms, grid: " << gridMilliseconds << " ms (" << nrOfMismatches << " mismatches), closest: "
+			<< std::chrono::duration<float, std::milli>(end - start).count() << " ms for " << nrOfPositions << " positions" << std::endl;
+
+		SAFE_DELETE(pLevel);
+	}
+}
+
+void App_NavMeshGraph::AddDynamicCollider()
+{
+	// Random box, it may overlap the other colliders
+	std::uniform_real_distribution<float> randomX{ -55.f, 55.f };
+	std::uniform_real_distribution<float> randomY{ -25.f, 25.f };
+	std::uniform_real_distribution<float> randomSize{ 2.f, 12.f };
+
+	NavigationColliderElement* pCollider = new NavigationColliderElement(Elite::Vector2(randomX(m_RandomEngine), randomY(m_RandomEngine)),
+		randomSize(m_RandomEngine), randomSize(m_RandomEngine));
+	const int obstacleId = m_pTiledNavGraph->AddObstacle(pCollider->GetShape());
+	if (obstacleId == TiledNavGraph::invalid_obstacle_id)
+	{
+		std::cout << "Collider outside the tiled navmesh" << std::endl;
+		SAFE_DELETE(pCollider);
+		return;
+	}
+
+	m_vDynamicColliders.push_back({ pCollider, obstacleId });
+	RebuildTiles();
+}
+
+void App_NavMeshGraph::RemoveDynamicCollider()
+{
+	if (m_vDynamicColliders.empty())
+		return;
+
+	m_pTiledNavGraph->RemoveObstacle(m_vDynamicColliders.back().second);
+	SAFE_DELETE(m_vDynamicColliders.back().first);
+	m_vDynamicColliders.pop_back();
+	RebuildTiles();
+}
+
+void App_NavMeshGraph::RebuildTiles()
+{
+	const auto pRebuiltTiles = m_pTiledNavGraph->RebuildDirtyTiles();
+
+	float totalMilliseconds = 0.f;
+	for (const auto& pTile : pRebuiltTiles)
+	{
+		std::cout << "Tile (" << pTile->GetColumn() << ", " << pTile->GetRow() << "): " << pTile->GetRegions().size() << " regions, "
+			<< pTile->GetNrOfNodes() << " nodes, " << pTile->GetBuildTime() << " ms" << std::endl;
+		totalMilliseconds += pTile->GetBuildTime();
+	}
+
+	std::cout << "Rebuilt " << pRebuiltTiles.size() << " tiles in " << totalMilliseconds << " ms" << std::endl;
+}
+
+Polygon* App_NavMeshGraph::LoadLevelPolygon(const std::string& filePath)
+{
+	// Level file of the exam framework: world size, then per building its center and size,
+	// the rectangles of its walls and the outlines of those walls (which are cut out of the world)
+	std::ifstream file(filePath, std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Can't open " << filePath << std::endl;
+		return nullptr;
+	}
+
+	auto readInt = [&file]() { int value = 0; file.read((char*)&value, sizeof(value)); return value; };
+	auto readVector = [&file]() { Vector2 value{}; file.read((char*)&value.x, sizeof(float)); file.read((char*)&value.y, sizeof(float)); return value; };
+
+	const Vector2 worldSize = readVector();
+	const std::vector<Vector2> worldShape{ Vector2{ -worldSize.x, -worldSize.y } / 2.f, Vector2{ worldSize.x, -worldSize.y } / 2.f,
+		Vector2{ worldSize.x, worldSize.y } / 2.f, Vector2{ -worldSize.x, worldSize.y } / 2.f };
+	Polygon* pLevel = new Polygon(worldShape);
+
+	const int nrOfBuildings = readInt();
+	for (int building = 0; building < nrOfBuildings && file; ++building)
+	{
+		readVector(); // center
+		readVector(); // size
+
+		const int nrOfWalls = readInt();
+		for (int wall = 0; wall < nrOfWalls && file; ++wall)
+		{
+			const int nrOfPoints = readInt();
+			for (int point = 0; point < nrOfPoints && file; ++point)
+				readVector();
+		}
+
+		const int nrOfOutlines = readInt();
+		for (int outline = 0; outline < nrOfOutlines && file; ++outline)
+		{
+			std::list<Vector2> points{};
+			const int nrOfPoints = readInt();
+			for (int point = 0; point < nrOfPoints && file; ++point)
+				points.push_back(readVector());
+			pLevel->AddChild(points);
+		}
+	}
+
+	if (!file)
+	{
+		std::cout << filePath << " is not a valid level file" << std::endl;
+		SAFE_DELETE(pLevel);
+	}
+	return pLevel;
+}
+
+void App_NavMeshGraph::BenchmarkClearance() const
+{
+	// Agent sizes that would each need their own mesh without clearances, on top of m_AgentRadius.
+	// Those meshes are built without clearances, they only serve their own agent size
+	const std::vector<float> extraRadii{ 0.0f, 0.5f, 1.0f, 2.0f };
+
+	// Rough size of the triangulation and the graph, the connections of the undirected graph are stored both ways
+	const auto getGraphMemory = [](const NavGraph& navGraph)
+	{
+		const Polygon* pPolygon = navGraph.GetNavMeshPolygon();
+		return pPolygon->GetTriangles().size() * (sizeof(Triangle) + sizeof(Triangle*))
+			+ pPolygon->GetLines().size() * (sizeof(Line) + sizeof(Line*))
+			+ navGraph.GetNrOfNodes() * (sizeof(NavGraphNode) + sizeof(NavGraphNode*))
+			+ navGraph.GetNrOfConnections() * (sizeof(GraphConnection2D) + 3 * sizeof(void*));
+	};
+	// One hash map entry per connection
+	const auto getClearanceMemory = [](const NavGraph& navGraph)
+	{
+		return navGraph.GetNrOfConnections() / 2 * (sizeof(uint64_t) + sizeof(float) + 2 * sizeof(void*));
+	};
+
+	float separateMilliseconds = 0.f;
+	size_t separateMemory = 0;
+	for (float extraRadius : extraRadii)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		const NavGraph navGraph{ Polygon(LEVEL_CONTOUR), m_AgentRadius + extraRadius, false };
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		separateMilliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+		separateMemory += getGraphMemory(navGraph);
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	const NavGraph navGraph{ Polygon(LEVEL_CONTOUR), m_AgentRadius };
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "Clearance, " << extraRadii.size() << " agent sizes:" << std::endl
+		<< "  separate meshes: " << separateMilliseconds << " ms, ~" << separateMemory / 1024.f << " KB" << std::endl
+		<< "  one mesh: " << std::chrono::duration<float, std::milli>(end - start).count() << " ms, ~"
+		<< (getGraphMemory(navGraph) + getClearanceMemory(navGraph)) / 1024.f << " KB (clearances ~" << getClearanceMemory(navGraph) / 1024.f << " KB)" << std::endl;
+}
+
+void App_NavMeshGraph::CheckTileBorderCrossings() const
+{
+	// Straight paths over the borders of an empty tiled mesh, both ways. A path that bends although the straight line
+	// goes through every portal took a detour, e.g. because the two lines of a border made a portal face the wrong way
+	TiledNavGraph tiledNavGraph{ Vector2(-60.f, -30.f), Vector2(60.f, 30.f), m_TileSize, m_AgentRadius };
+	const int nrOfColumns = tiledNavGraph.GetNrOfColumns();
+	const int nrOfRows = tiledNavGraph.GetNrOfRows();
+	const float tileSize = tiledNavGraph.GetTileSize();
+	if (nrOfColumns < 2 && nrOfRows < 2)
+	{
+		std::cout << "Tile border crossings: the mesh is a single tile, make the tiles smaller" << std::endl;
+		return;
+	}
+
+	tiledNavGraph.RebuildDirtyTiles();
+	const auto pSnapshot = tiledNavGraph.GetSnapshot();
+
+	const auto isCrossing = [](const Vector2& from, const Vector2& to, const Line& line)
+	{
+		return Cross(to - from, line.p1 - from) * Cross(to - from, line.p2 - from) <= 0.f
+			&& Cross(line.p2 - line.p1, from - line.p1) * Cross(line.p2 - line.p1, to - line.p1) <= 0.f;
+	};
+
+	std::mt19937 randomEngine{ 2022 };
+	std::uniform_real_distribution<float> offset{ 0.1f * tileSize, 0.9f * tileSize };
+	AStarContext<NavGraphNode, GraphConnection2D> context{};
+	int nrOfQueries = 0;
+	int nrOfDetours[2] = { 0, 0 };
+	for (int i = 0; i < 200; ++i)
+	{
+		// Neighbouring tiles, next to or above each other (only the one that exists when there is a single column or row)
+		const bool isVertical = nrOfColumns < 2 || (nrOfRows >= 2 && i % 2 == 1);
+		const int column = randomEngine() % (nrOfColumns - (isVertical ? 0 : 1));
+		const int row = randomEngine() % (nrOfRows - (isVertical ? 1 : 0));
+		const Vector2 tileMin = tiledNavGraph.GetWorldMin() + Vector2(column * tileSize, row * tileSize);
+		const Vector2 first = tileMin + Vector2(offset(randomEngine), offset(randomEngine));
+		const Vector2 second = tileMin + (isVertical ? Vector2(0.f, tileSize) : Vector2(tileSize, 0.f)) + Vector2(offset(randomEngine), offset(randomEngine));
+
+		for (int direction = 0; direction < 2; ++direction)
+		{
+			const Vector2& startPos = direction == 0 ? first : second;
+			const Vector2& endPos = direction == 0 ? second : first;
+
+			std::vector<Vector2> debugNodePositions{};
+			std::vector<Portal> portals{};
+			const std::vector<Vector2> path = NavMeshPathfinding::FindPath(startPos, endPos, *pSnapshot, context, debugNodePositions, portals);
+			if (path.empty())
+				continue;
+			++nrOfQueries;
+
+			const bool isStraightPossible = std::all_of(portals.begin(), portals.end(), [&](const Portal& portal) { return isCrossing(startPos, endPos, portal.Line); });
+			if (isStraightPossible && path.size() > 1)
+				++nrOfDetours[direction];
+		}
+	}
+
+	std::cout << "Tile border crossings: " << nrOfQueries << " paths, " << nrOfDetours[0] << " detours forward, "
+		<< nrOfDetours[1] << " detours backward" << std::endl;
+}
+
+std::vector<std::pair<int, int>> App_NavMeshGraph::GetBenchmarkQueries(int nrOfQueries) const
+{
+	// Fixed seed, so every benchmark runs the same queries
+	std::mt19937 randomEngine{ 2022 };
+
+	std::vector<int> nodes{};
+	for (int idx = 0; idx < m_pNavGraph->GetNrOfNodes(); ++idx)
+	{
+		if (m_pNavGraph->IsNodeValid(idx))
+			nodes.push_back(idx);
+	}
+
+	std::vector<std::pair<int, int>> queries{};
+	for (int i = 0; i < nrOfQueries && !nodes.empty(); ++i)
+		queries.push_back({ nodes[randomEngine() % nodes.size()], nodes[randomEngine() % nodes.size()] });
+
+	return queries;
+}
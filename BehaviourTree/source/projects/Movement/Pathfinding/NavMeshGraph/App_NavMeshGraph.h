@@ -8,6 +8,7 @@
 
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 #include "framework\EliteAI\EliteNavigation\Algorithms\EPathSmoothing.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
 
 class NavigationColliderElement;
 class SteeringAgent;
@@ -17,6 +18,8 @@ class Arrive;
 namespace Elite
 {
 	class NavGraph;
+	class TiledNavGraph;
+	class PathCorridor;
 }
 //-----------------------------------------------------------------
 // Application
@@ -52,6 +55,25 @@ private:
 	// --Graph--
 	Elite::NavGraph* m_pNavGraph = nullptr;
 	Elite::GraphRenderer m_GraphRenderer{};
+	Elite::Landmarks m_Landmarks{}; // loaded from (or saved to) LANDMARKS_FILE_PATH
+	bool m_UseLandmarks = true;
+	int m_NrOfLandmarks = 8;
+	Elite::AStarContext<Elite::NavGraphNode, Elite::GraphConnection2D> m_SearchContext{}; // reused by every path query
+	const std::string LANDMARKS_FILE_PATH = "../data/NavMeshGraph.landmarks";
+	const std::string NAVMESH_FILE_PATH = "../data/NavMeshGraph.navmesh"; // baked m_pNavGraph
+	const std::list<Elite::Vector2> LEVEL_CONTOUR{ { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
+	// Kept between clicks, a target close to the previous one only patches its end instead of running A* again
+	Elite::PathCorridor* m_pPathCorridor = nullptr;
+	bool m_UsePathCorridor = true;
+	float m_ExtraAgentRadius = 0.0f; // on top of m_AgentRadius, which the mesh is built with. The clearances of the mesh keep it out of narrow passages
+
+	// --Tiled graph--
+	// Knows the colliders added at runtime, only the touched tiles are rebuilt when they are added or removed
+	Elite::TiledNavGraph* m_pTiledNavGraph = nullptr;
+	bool m_UseTiledNavGraph = false;
+	float m_TileSize = 15.0f;
+	std::vector<std::pair<NavigationColliderElement*, int>> m_vDynamicColliders = {}; // with their obstacle id
+	std::mt19937 m_RandomEngine{ 2022 };
 
 	// --Debug drawing information--
 	std::vector<Elite::Portal> m_Portals;
@@ -63,6 +85,18 @@ private:
 	static bool sDrawNonOptimisedPath;
 
 	void UpdateImGui();
+	void BuildLandmarks();
+	void BenchmarkHeuristics();
+	void BenchmarkBidirectional();
+	void BenchmarkPointLocation() const;
+	void BenchmarkClearance() const;
+	void AddDynamicCollider();
+	void RemoveDynamicCollider();
+	void RebuildTiles();
+	void CheckTileBorderCrossings() const;
+	void UpdatePathCorridor(const Elite::Vector2& target);
+	std::vector<std::pair<int, int>> GetBenchmarkQueries(int nrOfQueries) const;
+	static Elite::Polygon* LoadLevelPolygon(const std::string& filePath);
 private:
 	//C++ make the class non-copyable
 	App_NavMeshGraph(const App_NavMeshGraph&) = delete;
@@ -6,6 +6,7 @@
 #include "../SteeringAgent.h"
 #include "../Obstacle.h"
 #include "framework\EliteMath\EMatrix2x3.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EFlowField.h"
 
 using namespace Elite; 
 //SEEK
@@ -199,3 +200,27 @@ SteeringOutput Evade::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 
 	return steering;
 }
+
+SteeringOutput FollowFlowField::CalculateSteering(float deltaT, SteeringAgent* pAgent)
+{
+	SteeringOutput steering{};
+	if (!m_pFlowField)
+		return steering;
+
+	const int cellIdx = m_pFlowField->GetCellIdxAtWorldPos(pAgent->GetPosition());
+	if (cellIdx == invalid_node_index || !m_pFlowField->IsReachable(cellIdx))
+		return steering;
+
+	//In a goal cell
+	if (m_pFlowField->GetCost(cellIdx) == 0.f)
+		return Seek::CalculateSteering(deltaT, pAgent);
+
+	steering.LinearVelocity = m_pFlowField->GetDirection(cellIdx) * pAgent->GetMaxLinearSpeed();
+
+	if (pAgent->CanRenderBehavior())
+	{
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), steering.LinearVelocity, 5, { 0,1,0 });
+	}
+
+	return steering;
+}
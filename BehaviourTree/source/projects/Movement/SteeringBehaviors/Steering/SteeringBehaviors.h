@@ -13,6 +13,7 @@
 #include "../SteeringHelpers.h"
 class SteeringAgent;
 class Obstacle;
+namespace Elite { class FlowField; }
 
 #pragma region **ISTEERINGBEHAVIOR** (BASE)
 class ISteeringBehavior
@@ -137,6 +138,23 @@ public:
 private:
 	float m_EvadeRadius = 10.f;
 };
+
+///////////////////////////////////////
+//FOLLOW FLOW FIELD
+//****
+class FollowFlowField : public Seek
+{
+public:
+	FollowFlowField() = default;
+	virtual ~FollowFlowField() = default;
+
+	//Walks along the directions of the field, seeks the target once in a goal cell.
+	//One behavior can be shared by all agents heading to the same goals
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void SetFlowField(const std::shared_ptr<const Elite::FlowField>& pFlowField) { m_pFlowField = pFlowField; }
+private:
+	std::shared_ptr<const Elite::FlowField> m_pFlowField = nullptr;
+};
 #endif
 
 
@@ -27,4 +27,18 @@ NavigationColliderElement::~NavigationColliderElement()
 void NavigationColliderElement::RenderElement()
 {
 	//Do Nothing
+}
+
+Elite::Polygon NavigationColliderElement::GetShape() const
+{
+	const Elite::Vector2 halfSize = Elite::Vector2(m_Width, m_Height) / 2.f;
+	const std::vector<Elite::Vector2> points{
+		m_Position - halfSize,
+		Elite::Vector2(m_Position.x + halfSize.x, m_Position.y - halfSize.y),
+		m_Position + halfSize,
+		Elite::Vector2(m_Position.x - halfSize.x, m_Position.y + halfSize.y) };
+
+	Elite::Polygon shape{ points };
+	shape.OrientateWithChildren(Elite::Winding::CW);
+	return shape;
 }
\ No newline at end of file
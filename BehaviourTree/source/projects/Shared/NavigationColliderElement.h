@@ -18,6 +18,7 @@ public:
 
 	//--- Functions ---
 	void RenderElement();
+	Elite::Polygon GetShape() const; //Outline of the collider, wound CW like the static shapes of the physics world
 
 private:
 	//--- Datamembers ---